@@ -0,0 +1,162 @@
+#ifndef AFFINE_H
+#define AFFINE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#define AFFINE_SSE 1
+#endif
+
+// A transform whose bottom row is (0, 0, 0, 1) -- every model and view matrix
+// in the sandbox -- kept as the three other rows: 48 bytes instead of 64,
+// three row products instead of four columns for a product, and the inverse
+// is a 3x3 inverse (cross products over the determinant) plus a translation,
+// instead of glm::inverse's general 4x4 cofactor expansion. Products and
+// inverses use SSE; a single point is three dot products, which SSE rows
+// would only turn into shuffles. Convert with toMat4() where GL or glm wants
+// a mat4.
+struct Affine
+{
+    glm::vec4 rows[3];  // (linear part row, translation) each
+
+    Affine()
+    {
+        rows[0] = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+        rows[1] = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+        rows[2] = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+    }
+
+    // the top three rows of m; m's bottom row is assumed to be (0, 0, 0, 1)
+    explicit Affine(const glm::mat4& m)
+    {
+        for (int r = 0; r < 3; r++)
+            rows[r] = glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+    }
+
+    // translate(position) * mat4_cast(rotation) * scale(scale)
+    static Affine fromTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        glm::mat3 r = glm::mat3_cast(rotation);
+        Affine a;
+        for (int i = 0; i < 3; i++)
+            a.rows[i] = glm::vec4(r[0][i] * scale.x, r[1][i] * scale.y, r[2][i] * scale.z, position[i]);
+        return a;
+    }
+
+    glm::mat4 toMat4() const
+    {
+        glm::mat4 m(1.0f);
+        for (int r = 0; r < 3; r++)
+        {
+            m[0][r] = rows[r].x;
+            m[1][r] = rows[r].y;
+            m[2][r] = rows[r].z;
+            m[3][r] = rows[r].w;
+        }
+        return m;
+    }
+
+    // column 0-2: where the x/y/z axes go; column 3: the translation
+    glm::vec3 column(int j) const { return glm::vec3(rows[0][j], rows[1][j], rows[2][j]); }
+    glm::vec3 translation() const { return column(3); }
+
+    // this * other: row i is sum over k of this[i][k] * other.row k, plus this's translation
+    Affine operator*(const Affine& other) const
+    {
+        Affine result;
+#if defined(AFFINE_SSE)
+        __m128 b0 = load(other.rows[0]), b1 = load(other.rows[1]), b2 = load(other.rows[2]);
+        __m128 translation = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+        for (int i = 0; i < 3; i++)
+        {
+            __m128 a = load(rows[i]);
+            __m128 sum = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, 0x00), b0), _mm_mul_ps(_mm_shuffle_ps(a, a, 0x55), b1));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(a, a, 0xAA), b2));
+            store(result.rows[i], _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(a, a, 0xFF), translation)));
+        }
+#else
+        for (int i = 0; i < 3; i++)
+        {
+            const glm::vec4& a = rows[i];
+            result.rows[i] = a.x * other.rows[0] + a.y * other.rows[1] + a.z * other.rows[2] + glm::vec4(0.0f, 0.0f, 0.0f, a.w);
+        }
+#endif
+        return result;
+    }
+
+    glm::vec3 transformPoint(const glm::vec3& p) const
+    {
+        glm::vec4 point(p, 1.0f);
+        return glm::vec3(glm::dot(rows[0], point), glm::dot(rows[1], point), glm::dot(rows[2], point));
+    }
+
+    // a direction: the linear part only
+    glm::vec3 transformVector(const glm::vec3& v) const
+    {
+        return glm::vec3(glm::dot(glm::vec3(rows[0]), v), glm::dot(glm::vec3(rows[1]), v), glm::dot(glm::vec3(rows[2]), v));
+    }
+
+    // For the linear part with rows a, b, c the inverse has the columns
+    // b x c, c x a and a x b over det = a . (b x c); the translation becomes
+    // -(inverse linear part * translation). A singular transform gives
+    // infinities, as glm::inverse does.
+    Affine inverse() const
+    {
+        Affine result;
+#if defined(AFFINE_SSE)
+        __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+        __m128 a = _mm_and_ps(load(rows[0]), mask), b = _mm_and_ps(load(rows[1]), mask), c = _mm_and_ps(load(rows[2]), mask);
+        __m128 bc = cross(b, c), ca = cross(c, a), ab = cross(a, b);
+        __m128 det = dot3(a, bc);
+        __m128 inverseDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+        bc = _mm_mul_ps(bc, inverseDet);
+        ca = _mm_mul_ps(ca, inverseDet);
+        ab = _mm_mul_ps(ab, inverseDet);
+        // the columns are bc, ca, ab; the new translation is minus their combination by the old one
+        __m128 t = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(_mm_add_ps(_mm_mul_ps(bc, _mm_set1_ps(rows[0].w)),
+            _mm_mul_ps(ca, _mm_set1_ps(rows[1].w))), _mm_mul_ps(ab, _mm_set1_ps(rows[2].w))));
+        _MM_TRANSPOSE4_PS(bc, ca, ab, t);
+        store(result.rows[0], bc);
+        store(result.rows[1], ca);
+        store(result.rows[2], ab);
+#else
+        glm::vec3 a(rows[0]), b(rows[1]), c(rows[2]);
+        glm::vec3 bc = glm::cross(b, c), ca = glm::cross(c, a), ab = glm::cross(a, b);
+        float inverseDet = 1.0f / glm::dot(a, bc);
+        bc *= inverseDet;
+        ca *= inverseDet;
+        ab *= inverseDet;
+        glm::vec3 t = -(bc * rows[0].w + ca * rows[1].w + ab * rows[2].w);
+        for (int i = 0; i < 3; i++)
+            result.rows[i] = glm::vec4(bc[i], ca[i], ab[i], t[i]);
+#endif
+        return result;
+    }
+
+private:
+#if defined(AFFINE_SSE)
+    static __m128 load(const glm::vec4& v) { return _mm_loadu_ps(&v.x); }
+    static void store(glm::vec4& v, __m128 value) { _mm_storeu_ps(&v.x, value); }
+
+    static __m128 cross(__m128 a, __m128 b)
+    {
+        __m128 aYzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)), bYzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYzx), _mm_mul_ps(aYzx, b));
+        return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+
+    // a . b (xyz) in every lane
+    static __m128 dot3(__m128 a, __m128 b)
+    {
+        __m128 p = _mm_mul_ps(a, b);
+        __m128 sum = _mm_add_ps(_mm_add_ps(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 0, 2, 1))), _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 1, 0, 2)));
+        return _mm_shuffle_ps(sum, sum, 0x00);
+    }
+#endif
+};
+
+// AFFINE_H
+#endif
@@ -0,0 +1,370 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A read-only view into asset memory. For packed assets this points straight
+// into the mapped pack file, so nothing is copied.
+struct AssetSpan
+{
+    const char* data = nullptr;
+    size_t size = 0;
+
+    bool valid() const { return data != nullptr; }
+};
+
+// Counters for the I/O work done to get assets into memory
+struct AssetIOStats
+{
+    unsigned int opens = 0;
+    unsigned int reads = 0;
+    unsigned int maps = 0;
+    size_t bytesCopied = 0;  // bytes read into our own buffers
+    size_t bytesMapped = 0;  // bytes made available through a file mapping
+};
+
+// Pack layout (all integers little-endian):
+//   PackHeader
+//   PackSlot[slotCount]     open-addressing hash table, slotCount is a power of two
+//   names                   concatenated asset names (not null-terminated)
+//   data                    asset contents, each aligned to PACK_ALIGNMENT
+const uint32_t PACK_MAGIC = 0x504C474F; // "OGLP"
+const uint32_t PACK_VERSION = 1;
+const uint64_t PACK_ALIGNMENT = 16;
+
+struct PackHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t slotCount;
+    uint64_t slotsOffset;
+    uint64_t namesOffset;
+};
+
+struct PackSlot
+{
+    uint64_t hash;        // 0 marks an empty slot
+    uint64_t offset;
+    uint64_t size;
+    uint32_t nameOffset;  // relative to PackHeader::namesOffset
+    uint32_t nameLength;
+};
+
+// A single memory-mapped asset pack with O(1) lookup by name
+class AssetPack
+{
+public:
+    AssetPack() {}
+    ~AssetPack() { close(); }
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // FNV-1a; never returns 0 so it can't be confused with an empty slot
+    static uint64_t hashName(const char* name, size_t length)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < length; i++)
+        {
+            hash ^= (unsigned char)name[i];
+            hash *= 1099511628211ull;
+        }
+        return hash ? hash : 1;
+    }
+
+    // maps the pack into memory and validates the header, the table and
+    // every slot's name and data bounds, so find() never reads outside the file
+    bool open(const std::string& path, AssetIOStats& stats)
+    {
+        close();
+        if (!mapFile(path, stats))
+            return false;
+
+        // every bound is checked as "offset <= size - length", which cannot overflow
+        const PackHeader* header = reinterpret_cast<const PackHeader*>(m_Base);
+        uint64_t size = m_Size;
+        bool ok = size >= sizeof(PackHeader)
+            && header->magic == PACK_MAGIC
+            && header->version == PACK_VERSION
+            && header->slotCount != 0
+            && (header->slotCount & (header->slotCount - 1)) == 0
+            && header->slotsOffset % alignof(PackSlot) == 0
+            && header->slotsOffset <= size
+            && (uint64_t)header->slotCount * sizeof(PackSlot) <= size - header->slotsOffset
+            && header->namesOffset <= size;
+        if (ok)
+        {
+            const PackSlot* slots = reinterpret_cast<const PackSlot*>(m_Base + header->slotsOffset);
+            uint32_t used = 0;
+            for (uint32_t i = 0; ok && i < header->slotCount; i++)
+            {
+                if (slots[i].hash == 0)
+                    continue;
+                used++;
+                ok = slotInBounds(slots[i], header->namesOffset, size);
+            }
+            // a full table would make a missing name probe forever
+            ok = ok && used == header->entryCount && used < header->slotCount;
+        }
+        if (!ok)
+        {
+            std::cout << "ERROR::ASSETPACK::INVALID_PACK: " << path << std::endl;
+            close();
+            return false;
+        }
+
+        m_Header = header;
+        m_Slots = reinterpret_cast<const PackSlot*>(m_Base + header->slotsOffset);
+        return true;
+    }
+
+    void close()
+    {
+        unmapFile();
+        m_Header = nullptr;
+        m_Slots = nullptr;
+    }
+
+    bool isOpen() const { return m_Header != nullptr; }
+
+    // returns an invalid span if the pack doesn't contain the asset
+    AssetSpan find(const std::string& name) const
+    {
+        AssetSpan span;
+        if (!m_Header)
+            return span;
+
+        uint64_t hash = hashName(name.data(), name.size());
+        uint32_t mask = m_Header->slotCount - 1;
+        for (uint32_t probe = 0; probe < m_Header->slotCount; probe++)
+        {
+            const PackSlot& slot = m_Slots[(hash + probe) & mask];
+            if (slot.hash == 0)
+                break;
+            if (slot.hash == hash && slot.nameLength == name.size() && slotInBounds(slot, m_Header->namesOffset, m_Size)
+                && memcmp(m_Base + m_Header->namesOffset + slot.nameOffset, name.data(), name.size()) == 0)
+            {
+                span.data = m_Base + slot.offset;
+                span.size = (size_t)slot.size;
+                break;
+            }
+        }
+        return span;
+    }
+
+    // writes a pack containing `names`, read from `sourcePaths` (same order)
+    static bool build(const std::string& packPath, const std::vector<std::string>& names, const std::vector<std::string>& sourcePaths)
+    {
+        // keep the table at most half full so probe chains stay short
+        uint32_t slotCount = 1;
+        while (slotCount < names.size() * 2)
+            slotCount <<= 1;
+
+        std::vector<PackSlot> slots(slotCount);
+        memset(slots.data(), 0, slots.size() * sizeof(PackSlot));
+        std::string nameBlob;
+        std::vector<std::vector<char>> contents(names.size());
+
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            if (!readWholeFile(sourcePaths[i], contents[i]))
+            {
+                std::cout << "ERROR::ASSETPACK::FILE_NOT_SUCCESSFULLY_READ: " << sourcePaths[i] << std::endl;
+                return false;
+            }
+        }
+
+        PackHeader header;
+        header.magic = PACK_MAGIC;
+        header.version = PACK_VERSION;
+        header.entryCount = (uint32_t)names.size();
+        header.slotCount = slotCount;
+        header.slotsOffset = sizeof(PackHeader);
+        header.namesOffset = header.slotsOffset + (uint64_t)slotCount * sizeof(PackSlot);
+
+        uint64_t namesSize = 0;
+        for (const std::string& name : names)
+            namesSize += name.size();
+        uint64_t offset = align(header.namesOffset + namesSize);
+
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            uint64_t hash = hashName(names[i].data(), names[i].size());
+            uint32_t index = (uint32_t)(hash & (slotCount - 1));
+            while (slots[index].hash != 0)
+                index = (index + 1) & (slotCount - 1);
+
+            PackSlot& slot = slots[index];
+            slot.hash = hash;
+            slot.offset = offset;
+            slot.size = contents[i].size();
+            slot.nameOffset = (uint32_t)nameBlob.size();
+            slot.nameLength = (uint32_t)names[i].size();
+            nameBlob += names[i];
+            offset = align(offset + slot.size);
+        }
+
+        FILE* file = fopen(packPath.c_str(), "wb");
+        if (!file)
+        {
+            std::cout << "ERROR::ASSETPACK::CANNOT_WRITE: " << packPath << std::endl;
+            return false;
+        }
+        fwrite(&header, sizeof(header), 1, file);
+        fwrite(slots.data(), sizeof(PackSlot), slots.size(), file);
+        fwrite(nameBlob.data(), 1, nameBlob.size(), file);
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            pad(file);
+            fwrite(contents[i].data(), 1, contents[i].size(), file);
+        }
+        bool ok = ferror(file) == 0;
+        fclose(file);
+        return ok;
+    }
+
+    // reads a whole loose file with one open and as few reads as possible
+    static bool readWholeFile(const std::string& path, std::vector<char>& out, AssetIOStats* stats = nullptr)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+        if (stats) stats->opens++;
+
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        if (size < 0)
+        {
+            fclose(file);
+            return false;
+        }
+
+        out.resize((size_t)size);
+        size_t got = size ? fread(out.data(), 1, out.size(), file) : 0;
+        if (stats)
+        {
+            stats->reads++;
+            stats->bytesCopied += got;
+        }
+        fclose(file);
+        return got == out.size();
+    }
+
+private:
+    const char* m_Base = nullptr;
+    size_t m_Size = 0;
+    const PackHeader* m_Header = nullptr;
+    const PackSlot* m_Slots = nullptr;
+#ifdef _WIN32
+    HANDLE m_File = INVALID_HANDLE_VALUE;
+    HANDLE m_Mapping = NULL;
+#endif
+
+    static uint64_t align(uint64_t offset)
+    {
+        return (offset + PACK_ALIGNMENT - 1) & ~(PACK_ALIGNMENT - 1);
+    }
+
+    // the slot's name and data lie inside the file of `size` bytes
+    static bool slotInBounds(const PackSlot& slot, uint64_t namesOffset, uint64_t size)
+    {
+        return namesOffset <= size
+            && slot.nameLength <= size - namesOffset
+            && slot.nameOffset <= size - namesOffset - slot.nameLength
+            && slot.size <= size
+            && slot.offset <= size - slot.size;
+    }
+
+    static void pad(FILE* file)
+    {
+        static const char zeros[PACK_ALIGNMENT] = {};
+        long position = ftell(file);
+        fwrite(zeros, 1, (size_t)(align((uint64_t)position) - (uint64_t)position), file);
+    }
+
+    bool mapFile(const std::string& path, AssetIOStats& stats)
+    {
+#ifdef _WIN32
+        m_File = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (m_File == INVALID_HANDLE_VALUE)
+            return false;
+        stats.opens++;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0)
+        {
+            unmapFile();
+            return false;
+        }
+        m_Mapping = CreateFileMappingA(m_File, NULL, PAGE_READONLY, 0, 0, NULL);
+        const void* base = m_Mapping ? MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (!base)
+        {
+            unmapFile();
+            return false;
+        }
+        m_Base = static_cast<const char*>(base);
+        m_Size = (size_t)size.QuadPart;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        stats.opens++;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void* base = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping keeps its own reference
+        if (base == MAP_FAILED)
+            return false;
+        m_Base = static_cast<const char*>(base);
+        m_Size = (size_t)info.st_size;
+#endif
+        stats.maps++;
+        stats.bytesMapped += m_Size;
+        return true;
+    }
+
+    void unmapFile()
+    {
+#ifdef _WIN32
+        if (m_Base) UnmapViewOfFile(m_Base);
+        if (m_Mapping) CloseHandle(m_Mapping);
+        if (m_File != INVALID_HANDLE_VALUE) CloseHandle(m_File);
+        m_Mapping = NULL;
+        m_File = INVALID_HANDLE_VALUE;
+#else
+        if (m_Base) munmap(const_cast<char*>(m_Base), m_Size);
+#endif
+        m_Base = nullptr;
+        m_Size = 0;
+    }
+};
+
+#endif
@@ -2,7 +2,9 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <string>
+#include <vector>
 
 class BaseShape
 {
@@ -10,11 +12,10 @@ public:
     // Each shape will store its own transform
     glm::vec3 position;
     glm::vec3 scale;
-    glm::vec3 rotationAxis;
-    float rotationAngle;
+    glm::quat rotation;     // unit quaternion; glm::angleAxis(glm::radians(degrees), axis) from an angle
 
     BaseShape()
-        : position(0.0f), scale(1.0f), rotationAxis(0.0f, 1.0f, 0.0f), rotationAngle(0.0f)
+        : position(0.0f), scale(1.0f), rotation(1.0f, 0.0f, 0.0f, 0.0f)
     {
     }
 
@@ -25,4 +26,20 @@ public:
 
     // Called each frame to render
     virtual void draw(const glm::mat4& view, const glm::mat4& projection, unsigned int shaderID) = 0;
+
+    // Object-space triangles ((x,y,z) per vertex plus a triangle list) for
+    // merged-buffer rendering; shapes with the same meshKey() share a mesh
+    virtual void getMesh(std::vector<float>& vertices, std::vector<unsigned int>& indices) const = 0;
+    virtual std::string meshKey() const = 0;
+
+    // The transform built from position/rotation/scale
+    glm::mat4 modelMatrix() const
+    {
+        glm::mat4 model = glm::mat4_cast(rotation);
+        model[0] *= scale.x;
+        model[1] *= scale.y;
+        model[2] *= scale.z;
+        model[3] = glm::vec4(position, 1.0f);
+        return model;
+    }
 };
@@ -4,8 +4,10 @@ out vec4 FragColor;
 
 uniform vec3 baseplateColor;
 
+#include "lighting.glsl"
+
 void main()
 {
-    // Render a solid color
-    FragColor = vec4(baseplateColor, 1.0);
+    // Render a solid color, lit by the clustered lights
+    FragColor = vec4(clusteredLighting(FragPos, baseplateColor), 1.0);
 }
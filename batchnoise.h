@@ -0,0 +1,419 @@
+#ifndef BATCHNOISE_H
+#define BATCHNOISE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/noise.hpp>
+
+#include "cpufeatures.h"
+#include "jobsystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BATCHNOISE_SSE 1
+#endif
+// the SSE4.1 and AVX2 paths are built everywhere on x86 and picked at run time
+#if defined(CPUFEATURES_X86) && defined(BATCHNOISE_SSE)
+#define BATCHNOISE_SSE41 1
+#define BATCHNOISE_AVX2 1
+#endif
+
+enum class NoiseKind { Perlin, Simplex };
+
+struct FbmSettings
+{
+    NoiseKind kind = NoiseKind::Perlin;
+    int octaves = 5;
+    float lacunarity = 2.0f;    // frequency multiplier per octave
+    float gain = 0.5f;          // amplitude multiplier per octave
+    float amplitude = 0.5f;     // of the first octave
+    bool ridged = false;        // sum (1 - |n|)^2 instead of n
+};
+
+// glm::perlin(vec2) and glm::simplex(vec2), many points at a time.
+//
+// The kernels below are glm's (webgl-noise) code with the vec4/vec3 corner
+// math unrolled into separate lanes, written once over a lane type: 8 points
+// per call with AVX2, 4 with SSE, 1 otherwise (and for leftovers). The steps
+// and their order are glm's, so results match glm's scalar noise to float
+// rounding (FMA contraction, if the compiler does it, is the only difference).
+// SSE2 is compiled in where the compiler targets it; SSE4.1 (a one-instruction
+// floor) and AVX2 are picked at run time from CpuFeatures, as in
+// TransformBatch. Grids are split into rows and run on the JobSystem.
+class BatchNoise
+{
+public:
+    enum SimdPath { SCALAR, SSE2, SSE41, AVX2 };
+
+    // the widest path this build and CPU can run
+    static SimdPath supportedPath()
+    {
+#if defined(BATCHNOISE_AVX2)
+        if (CpuFeatures::get().avx2)
+            return AVX2;
+#endif
+#if defined(BATCHNOISE_SSE41)
+        if (CpuFeatures::get().sse41)
+            return SSE41;
+#endif
+#if defined(BATCHNOISE_SSE)
+        return SSE2;
+#else
+        return SCALAR;
+#endif
+    }
+
+    // the path in use: the supported one, unless limited to a narrower one
+    // (to compare the paths)
+    static SimdPath path() { return activePath(); }
+    static void setMaxPath(SimdPath path) { activePath() = std::min(path, supportedPath()); }
+
+    static const char* pathName(SimdPath path)
+    {
+        static const char* names[] = { "scalar", "SSE2 (4 wide)", "SSE4.1 (4 wide)", "AVX2 (8 wide)" };
+        return names[path];
+    }
+    static const char* simdPath() { return pathName(path()); }
+
+    // out[i] = noise(x[i], y[i])
+    static void noise(NoiseKind kind, const float* x, const float* y, float* out, int count)
+    {
+        FbmSettings single;
+        single.kind = kind;
+        single.octaves = 1;
+        single.amplitude = 1.0f;
+        fbm(single, x, y, out, count);
+    }
+
+    // out[i] = fBm at (x[i], y[i])
+    static void fbm(const FbmSettings& settings, const float* x, const float* y, float* out, int count)
+    {
+        int i = 0;
+        SimdPath simd = path();
+#if defined(BATCHNOISE_AVX2)
+        if (simd >= AVX2)
+            i = fbmAvx2(settings, x, y, out, i, count);
+#endif
+#if defined(BATCHNOISE_SSE41)
+        if (simd >= SSE41)
+            i = fbmSse41(settings, x, y, out, i, count);
+#endif
+#if defined(BATCHNOISE_SSE)
+        if (simd >= SSE2)
+        {
+            for (; i + 4 <= count; i += 4)
+                fbmLanes(settings, Sse::load(x + i), Sse::load(y + i)).store(out + i);
+        }
+#endif
+        for (; i < count; i++)
+            out[i] = fbmLanes(settings, Scalar(x[i]), Scalar(y[i])).v;
+    }
+
+    // out[row * width + column] = fBm at origin + (column, row) * step; rows run on the JobSystem
+    static void fbmGrid(const FbmSettings& settings, const glm::vec2& origin, const glm::vec2& step, int width, int height, float* out)
+    {
+        SimdPath simd = path();
+        JobSystem::parallelFor(height, 8, [&](int begin, int end)
+        {
+            for (int row = begin; row < end; row++)
+            {
+                float* line = out + (size_t)row * width;
+                float y = (float)row * step.y + origin.y;
+                int column = 0;
+#if defined(BATCHNOISE_AVX2)
+                if (simd >= AVX2)
+                    column = rowAvx2(settings, origin.x, step.x, y, line, column, width);
+#endif
+#if defined(BATCHNOISE_SSE41)
+                if (simd >= SSE41)
+                    column = rowSse41(settings, origin.x, step.x, y, line, column, width);
+#endif
+#if defined(BATCHNOISE_SSE)
+                if (simd >= SSE2)
+                {
+                    for (; column + 4 <= width; column += 4)
+                        fbmLanes(settings, Sse::ramp((float)column) * step.x + origin.x, Sse(y)).store(line + column);
+                }
+#endif
+                for (; column < width; column++)
+                    line[column] = fbmLanes(settings, Scalar((float)column) * step.x + origin.x, Scalar(y)).v;
+            }
+        });
+    }
+
+    // the same sum through glm::perlin / glm::simplex, one point at a time
+    static float fbmReference(const FbmSettings& settings, glm::vec2 p)
+    {
+        float value = 0.0f, amplitude = settings.amplitude;
+        for (int octave = 0; octave < settings.octaves; octave++)
+        {
+            float n = settings.kind == NoiseKind::Perlin ? glm::perlin(p) : glm::simplex(p);
+            if (settings.ridged)
+            {
+                n = 1.0f - std::fabs(n);
+                n = n * n;
+            }
+            value += n * amplitude;
+            p *= settings.lacunarity;
+            amplitude *= settings.gain;
+        }
+        return value;
+    }
+
+private:
+    static SimdPath& activePath()
+    {
+        static SimdPath path = supportedPath();
+        return path;
+    }
+
+    // ---- lane types: float-like values with floor/abs/max/select ----
+
+    struct Scalar
+    {
+        float v;
+        Scalar(float value = 0.0f) : v(value) {}
+        friend Scalar operator+(Scalar a, Scalar b) { return a.v + b.v; }
+        friend Scalar operator-(Scalar a, Scalar b) { return a.v - b.v; }
+        friend Scalar operator*(Scalar a, Scalar b) { return a.v * b.v; }
+        friend Scalar operator/(Scalar a, Scalar b) { return a.v / b.v; }
+        friend Scalar floor(Scalar a) { return std::floor(a.v); }
+        friend Scalar abs(Scalar a) { return std::fabs(a.v); }
+        friend Scalar max(Scalar a, Scalar b) { return a.v > b.v ? a.v : b.v; } // glm::max
+        // a > b ? ifGreater : otherwise
+        friend Scalar selectGreater(Scalar a, Scalar b, Scalar ifGreater, Scalar otherwise) { return a.v > b.v ? ifGreater : otherwise; }
+    };
+
+#if defined(BATCHNOISE_SSE)
+    struct Sse
+    {
+        __m128 v;
+        Sse(float value = 0.0f) : v(_mm_set1_ps(value)) {}
+        Sse(__m128 value) : v(value) {}
+        static Sse load(const float* p) { return _mm_loadu_ps(p); }
+        static Sse ramp(float start) { return _mm_add_ps(_mm_set1_ps(start), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)); }
+        void store(float* p) const { _mm_storeu_ps(p, v); }
+        friend Sse operator+(Sse a, Sse b) { return _mm_add_ps(a.v, b.v); }
+        friend Sse operator-(Sse a, Sse b) { return _mm_sub_ps(a.v, b.v); }
+        friend Sse operator*(Sse a, Sse b) { return _mm_mul_ps(a.v, b.v); }
+        friend Sse operator/(Sse a, Sse b) { return _mm_div_ps(a.v, b.v); }
+        friend Sse floor(Sse a)
+        {
+            // truncate, then step down where that rounded up (|a| < 2^31 here)
+            __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+            return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.0f)));
+        }
+        friend Sse abs(Sse a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+        friend Sse max(Sse a, Sse b) { return selectGreater(a, b, a, b); }
+        friend Sse selectGreater(Sse a, Sse b, Sse ifGreater, Sse otherwise)
+        {
+            __m128 mask = _mm_cmpgt_ps(a.v, b.v);
+            return _mm_or_ps(_mm_and_ps(mask, ifGreater.v), _mm_andnot_ps(mask, otherwise.v));
+        }
+    };
+#endif
+
+#if defined(BATCHNOISE_SSE41)
+    // Sse with SSE4.1's floor and blend; only runs when CpuFeatures has SSE4.1
+    struct Sse41
+    {
+        __m128 v;
+        CPU_TARGET_SSE41 Sse41(float value = 0.0f) : v(_mm_set1_ps(value)) {}
+        CPU_TARGET_SSE41 Sse41(__m128 value) : v(value) {}
+        static CPU_TARGET_SSE41 Sse41 load(const float* p) { return _mm_loadu_ps(p); }
+        static CPU_TARGET_SSE41 Sse41 ramp(float start) { return _mm_add_ps(_mm_set1_ps(start), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)); }
+        CPU_TARGET_SSE41 void store(float* p) const { _mm_storeu_ps(p, v); }
+        friend CPU_TARGET_SSE41 Sse41 operator+(Sse41 a, Sse41 b) { return _mm_add_ps(a.v, b.v); }
+        friend CPU_TARGET_SSE41 Sse41 operator-(Sse41 a, Sse41 b) { return _mm_sub_ps(a.v, b.v); }
+        friend CPU_TARGET_SSE41 Sse41 operator*(Sse41 a, Sse41 b) { return _mm_mul_ps(a.v, b.v); }
+        friend CPU_TARGET_SSE41 Sse41 operator/(Sse41 a, Sse41 b) { return _mm_div_ps(a.v, b.v); }
+        friend CPU_TARGET_SSE41 Sse41 floor(Sse41 a) { return _mm_floor_ps(a.v); }
+        friend CPU_TARGET_SSE41 Sse41 abs(Sse41 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+        friend CPU_TARGET_SSE41 Sse41 max(Sse41 a, Sse41 b) { return selectGreater(a, b, a, b); }
+        friend CPU_TARGET_SSE41 Sse41 selectGreater(Sse41 a, Sse41 b, Sse41 ifGreater, Sse41 otherwise)
+        {
+            return _mm_blendv_ps(otherwise.v, ifGreater.v, _mm_cmpgt_ps(a.v, b.v));
+        }
+    };
+#endif
+
+#if defined(BATCHNOISE_AVX2)
+    struct Avx
+    {
+        __m256 v;
+        CPU_TARGET_AVX2 Avx(float value = 0.0f) : v(_mm256_set1_ps(value)) {}
+        CPU_TARGET_AVX2 Avx(__m256 value) : v(value) {}
+        static CPU_TARGET_AVX2 Avx load(const float* p) { return _mm256_loadu_ps(p); }
+        static CPU_TARGET_AVX2 Avx ramp(float start) { return _mm256_add_ps(_mm256_set1_ps(start), _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f)); }
+        CPU_TARGET_AVX2 void store(float* p) const { _mm256_storeu_ps(p, v); }
+        friend CPU_TARGET_AVX2 Avx operator+(Avx a, Avx b) { return _mm256_add_ps(a.v, b.v); }
+        friend CPU_TARGET_AVX2 Avx operator-(Avx a, Avx b) { return _mm256_sub_ps(a.v, b.v); }
+        friend CPU_TARGET_AVX2 Avx operator*(Avx a, Avx b) { return _mm256_mul_ps(a.v, b.v); }
+        friend CPU_TARGET_AVX2 Avx operator/(Avx a, Avx b) { return _mm256_div_ps(a.v, b.v); }
+        friend CPU_TARGET_AVX2 Avx floor(Avx a) { return _mm256_floor_ps(a.v); }
+        friend CPU_TARGET_AVX2 Avx abs(Avx a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+        friend CPU_TARGET_AVX2 Avx max(Avx a, Avx b) { return selectGreater(a, b, a, b); }
+        friend CPU_TARGET_AVX2 Avx selectGreater(Avx a, Avx b, Avx ifGreater, Avx otherwise)
+        {
+            return _mm256_blendv_ps(otherwise.v, ifGreater.v, _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ));
+        }
+    };
+#endif
+
+    // ---- the wide loops, built for their instruction set; each returns the
+    // first point left over ----
+
+#if defined(BATCHNOISE_SSE41)
+    static CPU_TARGET_SSE41 int fbmSse41(const FbmSettings& settings, const float* x, const float* y, float* out, int i, int count)
+    {
+        for (; i + 4 <= count; i += 4)
+            fbmLanes(settings, Sse41::load(x + i), Sse41::load(y + i)).store(out + i);
+        return i;
+    }
+
+    static CPU_TARGET_SSE41 int rowSse41(const FbmSettings& settings, float originX, float stepX, float y, float* line, int column, int width)
+    {
+        for (; column + 4 <= width; column += 4)
+            fbmLanes(settings, Sse41::ramp((float)column) * Sse41(stepX) + Sse41(originX), Sse41(y)).store(line + column);
+        return column;
+    }
+#endif
+
+#if defined(BATCHNOISE_AVX2)
+    static CPU_TARGET_AVX2 int fbmAvx2(const FbmSettings& settings, const float* x, const float* y, float* out, int i, int count)
+    {
+        for (; i + 8 <= count; i += 8)
+            fbmLanes(settings, Avx::load(x + i), Avx::load(y + i)).store(out + i);
+        return i;
+    }
+
+    static CPU_TARGET_AVX2 int rowAvx2(const FbmSettings& settings, float originX, float stepX, float y, float* line, int column, int width)
+    {
+        for (; column + 8 <= width; column += 8)
+            fbmLanes(settings, Avx::ramp((float)column) * Avx(stepX) + Avx(originX), Avx(y)).store(line + column);
+        return column;
+    }
+#endif
+
+    // ---- glm's noise, lane by lane ----
+
+    template <typename L>
+    static CPU_FORCE_INLINE L fract(const L& x) { return x - floor(x); }
+
+    template <typename L>
+    static CPU_FORCE_INLINE L mod(const L& x, float y) { return x - L(y) * floor(x / L(y)); }   // glm::mod
+
+    template <typename L>
+    static CPU_FORCE_INLINE L mod289(const L& x) { return x - floor(x * L(1.0f / 289.0f)) * L(289.0f); }
+
+    template <typename L>
+    static CPU_FORCE_INLINE L permute(const L& x) { return mod289((x * L(34.0f) + L(1.0f)) * x); }
+
+    template <typename L>
+    static CPU_FORCE_INLINE L taylorInvSqrt(const L& r) { return L(1.79284291400159f) - L(0.85373472095314f) * r; }
+
+    template <typename L>
+    static CPU_FORCE_INLINE L fade(const L& t) { return (t * t * t) * (t * (t * L(6.0f) - L(15.0f)) + L(10.0f)); }
+
+    template <typename L>
+    static CPU_FORCE_INLINE L mix(const L& x, const L& y, const L& a) { return x * (L(1.0f) - a) + y * a; }
+
+    // one corner of perlin(): the hashed gradient dotted with the offset
+    template <typename L>
+    static CPU_FORCE_INLINE L perlinCorner(const L& hash, const L& fx, const L& fy)
+    {
+        L gx = L(2.0f) * fract(hash / L(41.0f)) - L(1.0f);
+        L gy = abs(gx) - L(0.5f);
+        L tx = floor(gx + L(0.5f));
+        gx = gx - tx;
+        L norm = taylorInvSqrt(gx * gx + gy * gy);
+        return (gx * norm) * fx + (gy * norm) * fy;
+    }
+
+    template <typename L>
+    static CPU_FORCE_INLINE L perlin(const L& x, const L& y)
+    {
+        L x0 = floor(x), y0 = floor(y);
+        L fx0 = fract(x), fy0 = fract(y);
+        L fx1 = fx0 - L(1.0f), fy1 = fy0 - L(1.0f);
+        L ix0 = mod(x0, 289.0f), ix1 = mod(x0 + L(1.0f), 289.0f);
+        L iy0 = mod(y0, 289.0f), iy1 = mod(y0 + L(1.0f), 289.0f);
+
+        L px0 = permute(ix0), px1 = permute(ix1);
+        L n00 = perlinCorner(permute(px0 + iy0), fx0, fy0);
+        L n10 = perlinCorner(permute(px1 + iy0), fx1, fy0);
+        L n01 = perlinCorner(permute(px0 + iy1), fx0, fy1);
+        L n11 = perlinCorner(permute(px1 + iy1), fx1, fy1);
+
+        L fadeX = fade(fx0), fadeY = fade(fy0);
+        return L(2.3f) * mix(mix(n00, n10, fadeX), mix(n01, n11, fadeX), fadeY);
+    }
+
+    // one corner of simplex(): falloff times the hashed gradient dotted with the offset
+    template <typename L>
+    static CPU_FORCE_INLINE L simplexCorner(const L& hash, const L& x, const L& y)
+    {
+        L m = max(L(0.5f) - (x * x + y * y), L(0.0f));
+        m = m * m;
+        m = m * m;
+        L gx = L(2.0f) * fract(hash * L(0.024390243902439f)) - L(1.0f);
+        L h = abs(gx) - L(0.5f);
+        L ox = floor(gx + L(0.5f));
+        L a0 = gx - ox;
+        m = m * (L(1.79284291400159f) - L(0.85373472095314f) * (a0 * a0 + h * h));
+        return m * (a0 * x + h * y);
+    }
+
+    template <typename L>
+    static CPU_FORCE_INLINE L simplex(const L& x, const L& y)
+    {
+        const float C0 = 0.211324865405187f;    // (3 - sqrt(3)) / 6
+        const float C1 = 0.366025403784439f;    // (sqrt(3) - 1) / 2
+        const float C2 = -0.577350269189626f;   // -1 + 2 * C0
+
+        L skew = x * L(C1) + y * L(C1);
+        L i = floor(x + skew), j = floor(y + skew);
+        L unskew = i * L(C0) + j * L(C0);
+        L x0 = x - i + unskew, y0 = y - j + unskew;
+
+        L i1x = selectGreater(x0, y0, L(1.0f), L(0.0f));
+        L i1y = selectGreater(x0, y0, L(0.0f), L(1.0f));
+        L x1 = x0 + L(C0) - i1x, y1 = y0 + L(C0) - i1y;
+        L x2 = x0 + L(C2), y2 = y0 + L(C2);
+
+        i = mod(i, 289.0f);
+        j = mod(j, 289.0f);
+        L p0 = permute(permute(j + L(0.0f)) + i + L(0.0f));
+        L p1 = permute(permute(j + i1y) + i + i1x);
+        L p2 = permute(permute(j + L(1.0f)) + i + L(1.0f));
+
+        return L(130.0f) * (simplexCorner(p0, x0, y0) + simplexCorner(p1, x1, y1) + simplexCorner(p2, x2, y2));
+    }
+
+    template <typename L>
+    static CPU_FORCE_INLINE L fbmLanes(const FbmSettings& settings, const L& startX, const L& startY)
+    {
+        L x = startX, y = startY;
+        L value(0.0f);
+        float amplitude = settings.amplitude;
+        for (int octave = 0; octave < settings.octaves; octave++)
+        {
+            L n = settings.kind == NoiseKind::Perlin ? perlin(x, y) : simplex(x, y);
+            if (settings.ridged)
+            {
+                n = L(1.0f) - abs(n);
+                n = n * n;
+            }
+            value = value + n * L(amplitude);
+            x = x * L(settings.lacunarity);
+            y = y * L(settings.lacunarity);
+            amplitude *= settings.gain;
+        }
+        return value;
+    }
+};
+
+// BATCHNOISE_H
+#endif
@@ -0,0 +1,141 @@
+// Standalone benchmark for the Affine transform type against glm::mat4.
+//
+// Usage: affine-bench [--json <file>] [--count <n>] [--quick]
+//
+// For n random translate * rotate * scale transforms: inverses with
+// glm::inverse versus Affine::inverse, products with mat4 * mat4 versus
+// Affine * Affine, and points through mat4 * vec4 versus
+// Affine::transformPoint. Reports nanoseconds per operation and the largest
+// difference from the glm results.
+
+#include "affine.h"
+#include "bench_common.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static void report(BenchJson& json, const char* operation, const char* path, int count, const BenchTiming& timing,
+    double baselineMs, double maxError)
+{
+    double nsPerOperation = timing.medianMs * 1e6 / count;
+    printf("%-16s %-26s %9.3f %8.2f %8.2fx %10.2e\n", operation, path, timing.medianMs, nsPerOperation,
+        baselineMs / timing.medianMs, maxError);
+
+    json.beginResult();
+    json.field("operation", operation);
+    json.field("path", path);
+    json.field("count", count);
+    json.field("iterations", timing.iterations);
+    json.field("median_ms", timing.medianMs);
+    json.field("min_ms", timing.minMs);
+    json.field("ns_per_operation", nsPerOperation);
+    json.field("speedup", baselineMs / timing.medianMs);
+    json.field("max_abs_error", maxError);
+}
+
+static double maxDifference(const std::vector<glm::mat4>& reference, const std::vector<Affine>& affine)
+{
+    double worst = 0.0;
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        glm::mat4 m = affine[i].toMat4();
+        for (int k = 0; k < 16; k++)
+            worst = std::max(worst, (double)std::fabs((&m[0][0])[k] - (&reference[i][0][0])[k]));
+    }
+    return worst;
+}
+
+int main(int argc, char** argv)
+{
+    std::string jsonPath = "bench_affine.json";
+    int count = 10000;
+    bool quick = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) count = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--quick") == 0) quick = true;
+        else
+        {
+            printf("usage: %s [--json <file>] [--count <n>] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+    int minIterations = quick ? 2 : 5;
+    double minSeconds = quick ? 0.05 : 0.25;
+
+    std::mt19937 random(4321);
+    std::uniform_real_distribution<float> coordinate(-50.0f, 50.0f), unit(-1.0f, 1.0f), size(0.2f, 3.0f), angle(0.0f, 6.2831853f);
+    std::vector<glm::mat4> matrices(count);
+    std::vector<Affine> affines(count);
+    std::vector<glm::vec3> points(count);
+    for (int i = 0; i < count; i++)
+    {
+        glm::vec3 axis = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.01f, 0.0f));
+        glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3(coordinate(random), coordinate(random), coordinate(random)));
+        m = glm::rotate(m, angle(random), axis);
+        matrices[i] = glm::scale(m, glm::vec3(size(random), size(random), size(random)));
+        affines[i] = Affine(matrices[i]);
+        points[i] = glm::vec3(coordinate(random), coordinate(random), coordinate(random));
+    }
+
+    printf("%d transforms; mat4 %d bytes, Affine %d bytes\n", count, (int)sizeof(glm::mat4), (int)sizeof(Affine));
+    printf("%-16s %-26s %9s %8s %9s %10s\n", "operation", "path", "median ms", "ns/op", "speedup", "max error");
+    BenchJson json("affine");
+
+    std::vector<glm::mat4> glmResults(count);
+    std::vector<Affine> affineResults(count);
+
+    BenchTiming glmInverse = benchRun([&]() {
+        for (int i = 0; i < count; i++)
+            glmResults[i] = glm::inverse(matrices[i]);
+    }, minIterations, minSeconds);
+    report(json, "inverse", "glm::inverse", count, glmInverse, glmInverse.medianMs, 0.0);
+    BenchTiming affineInverse = benchRun([&]() {
+        for (int i = 0; i < count; i++)
+            affineResults[i] = affines[i].inverse();
+    }, minIterations, minSeconds);
+    report(json, "inverse", "Affine::inverse", count, affineInverse, glmInverse.medianMs, maxDifference(glmResults, affineResults));
+
+    // each transform times its neighbour, like a parent * child chain
+    BenchTiming glmMultiply = benchRun([&]() {
+        for (int i = 0; i < count; i++)
+            glmResults[i] = matrices[i] * matrices[(i + 1) % count];
+    }, minIterations, minSeconds);
+    report(json, "multiply", "mat4 * mat4", count, glmMultiply, glmMultiply.medianMs, 0.0);
+    BenchTiming affineMultiply = benchRun([&]() {
+        for (int i = 0; i < count; i++)
+            affineResults[i] = affines[i] * affines[(i + 1) % count];
+    }, minIterations, minSeconds);
+    report(json, "multiply", "Affine * Affine", count, affineMultiply, glmMultiply.medianMs, maxDifference(glmResults, affineResults));
+
+    std::vector<glm::vec3> glmPoints(count), affinePoints(count);
+    BenchTiming glmTransform = benchRun([&]() {
+        for (int i = 0; i < count; i++)
+            glmPoints[i] = glm::vec3(matrices[i] * glm::vec4(points[i], 1.0f));
+    }, minIterations, minSeconds);
+    report(json, "transform point", "mat4 * vec4", count, glmTransform, glmTransform.medianMs, 0.0);
+    BenchTiming affineTransform = benchRun([&]() {
+        for (int i = 0; i < count; i++)
+            affinePoints[i] = affines[i].transformPoint(points[i]);
+    }, minIterations, minSeconds);
+    double pointError = 0.0;
+    for (int i = 0; i < count; i++)
+        pointError = std::max(pointError, (double)glm::length(glmPoints[i] - affinePoints[i]));
+    report(json, "transform point", "Affine::transformPoint", count, affineTransform, glmTransform.medianMs, pointError);
+
+    if (!json.write(jsonPath))
+    {
+        printf("cannot write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    printf("results written to %s\n", jsonPath.c_str());
+    return 0;
+}
@@ -0,0 +1,105 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Shared helpers for the standalone benchmark programs in this folder
+
+// Runs `op` repeatedly (after one warm-up call) until both minIterations and
+// minSeconds are reached, and records per-iteration timings in milliseconds.
+struct BenchTiming
+{
+    int iterations = 0;
+    double meanMs = 0.0;
+    double minMs = 0.0;
+    double medianMs = 0.0;
+};
+
+template <typename Op>
+BenchTiming benchRun(Op op, int minIterations = 5, double minSeconds = 0.25)
+{
+    typedef std::chrono::steady_clock Clock;
+    std::vector<double> samples;
+    op();
+
+    Clock::time_point start = Clock::now();
+    while ((int)samples.size() < minIterations
+        || std::chrono::duration<double>(Clock::now() - start).count() < minSeconds)
+    {
+        Clock::time_point t0 = Clock::now();
+        op();
+        samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+    }
+
+    BenchTiming timing;
+    timing.iterations = (int)samples.size();
+    for (double sample : samples)
+        timing.meanMs += sample;
+    timing.meanMs /= samples.size();
+    std::sort(samples.begin(), samples.end());
+    timing.minMs = samples.front();
+    timing.medianMs = samples[samples.size() / 2];
+    return timing;
+}
+
+// Minimal writer for flat JSON result files: {"benchmark": ..., "results": [{...}, ...]}
+class BenchJson
+{
+public:
+    explicit BenchJson(const std::string& benchmark) : m_Benchmark(benchmark) {}
+
+    void beginResult() { m_Rows.push_back(std::string()); }
+
+    void field(const char* key, const std::string& value)
+    {
+        std::string escaped;
+        for (char c : value)
+        {
+            if (c == '"' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        append(key, "\"" + escaped + "\"");
+    }
+    void field(const char* key, const char* value) { field(key, std::string(value)); }
+    void field(const char* key, double value)
+    {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.6g", value);
+        append(key, buffer);
+    }
+    void field(const char* key, long long value) { append(key, std::to_string(value)); }
+    void field(const char* key, int value) { append(key, std::to_string(value)); }
+    void field(const char* key, size_t value) { append(key, std::to_string(value)); }
+    void field(const char* key, bool value) { append(key, value ? "true" : "false"); }
+
+    bool write(const std::string& path) const
+    {
+        FILE* file = fopen(path.c_str(), "w");
+        if (!file)
+            return false;
+        fprintf(file, "{\n  \"benchmark\": \"%s\",\n  \"results\": [\n", m_Benchmark.c_str());
+        for (size_t i = 0; i < m_Rows.size(); i++)
+            fprintf(file, "    {%s}%s\n", m_Rows[i].c_str(), i + 1 < m_Rows.size() ? "," : "");
+        fprintf(file, "  ]\n}\n");
+        fclose(file);
+        return true;
+    }
+
+private:
+    std::string m_Benchmark;
+    std::vector<std::string> m_Rows;
+
+    void append(const char* key, const std::string& value)
+    {
+        std::string& row = m_Rows.back();
+        if (!row.empty())
+            row += ", ";
+        row += "\"" + std::string(key) + "\": " + value;
+    }
+};
+
+#endif
@@ -0,0 +1,565 @@
+#ifndef BENCH_IMAGE_WRITERS_H
+#define BENCH_IMAGE_WRITERS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Small encoders used only to generate large benchmark corpora. They favour
+// brevity over compression ratio, but emit ordinary baseline files that any
+// decoder (including stb_image) accepts.
+
+typedef std::vector<unsigned char> ByteBuffer;
+
+// ---------------------------------------------------------------------------
+// synthetic content: smooth gradients with some texture-like noise so that
+// neither the entropy coders nor the predictors see trivially flat input
+// ---------------------------------------------------------------------------
+inline ByteBuffer makeTestImage(int width, int height, int channels, unsigned int seed = 1)
+{
+    ByteBuffer pixels((size_t)width * height * channels);
+    unsigned int state = seed;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            state = state * 1664525u + 1013904223u;
+            int noise = (int)(state >> 28) - 8;
+            float fx = (float)x / width, fy = (float)y / height;
+            int base[4] = {
+                (int)(128 + 100 * std::sin(fx * 23.0f) * std::cos(fy * 17.0f)),
+                (int)(255 * fx),
+                (int)(128 + 90 * std::sin((fx + fy) * 31.0f)),
+                (int)(255 * fy)
+            };
+            for (int c = 0; c < channels; c++)
+            {
+                int value = base[c] + noise;
+                pixels[((size_t)y * width + x) * channels + c] = (unsigned char)(value < 0 ? 0 : value > 255 ? 255 : value);
+            }
+        }
+    }
+    return pixels;
+}
+
+// ---------------------------------------------------------------------------
+// TGA: uncompressed (type 2/3) or run-length encoded (type 10/11)
+// ---------------------------------------------------------------------------
+inline ByteBuffer encodeTGA(const unsigned char* pixels, int width, int height, int channels, bool rle)
+{
+    ByteBuffer out(18, 0);
+    out[2] = (unsigned char)((channels < 3 ? 3 : 2) + (rle ? 8 : 0));
+    out[12] = width & 255; out[13] = (width >> 8) & 255;
+    out[14] = height & 255; out[15] = (height >> 8) & 255;
+    out[16] = (unsigned char)(channels * 8);
+    out[17] = 0x20; // top-left origin
+
+    // TGA stores BGR(A)
+    auto pixelAt = [&](size_t index, unsigned char* bgr) {
+        const unsigned char* p = pixels + index * channels;
+        for (int c = 0; c < channels; c++)
+            bgr[c] = p[c];
+        if (channels >= 3) { bgr[0] = p[2]; bgr[2] = p[0]; }
+    };
+
+    size_t count = (size_t)width * height;
+    unsigned char current[4], next[4];
+    if (!rle)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            pixelAt(i, current);
+            out.insert(out.end(), current, current + channels);
+        }
+        return out;
+    }
+
+    for (size_t i = 0; i < count;)
+    {
+        // runs and raw packets are limited to 128 pixels and must not cross a scanline
+        size_t rowEnd = (i / width + 1) * (size_t)width;
+        size_t run = 1;
+        pixelAt(i, current);
+        while (i + run < rowEnd && run < 128)
+        {
+            pixelAt(i + run, next);
+            if (memcmp(current, next, channels) != 0)
+                break;
+            run++;
+        }
+        if (run > 1)
+        {
+            out.push_back((unsigned char)(0x80 | (run - 1)));
+            out.insert(out.end(), current, current + channels);
+            i += run;
+            continue;
+        }
+        size_t raw = 1;
+        while (i + raw < rowEnd && raw < 128)
+        {
+            pixelAt(i + raw - 1, current);
+            pixelAt(i + raw, next);
+            if (memcmp(current, next, channels) == 0)
+                break;
+            raw++;
+        }
+        out.push_back((unsigned char)(raw - 1));
+        for (size_t k = 0; k < raw; k++)
+        {
+            pixelAt(i + k, current);
+            out.insert(out.end(), current, current + channels);
+        }
+        i += raw;
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// zlib stream using fixed-Huffman deflate with greedy hash-chain-free LZ77
+// ---------------------------------------------------------------------------
+class BitWriter
+{
+public:
+    ByteBuffer bytes;
+
+    // deflate packs values LSB-first
+    void put(uint32_t value, int count)
+    {
+        m_Bits |= value << m_Count;
+        m_Count += count;
+        while (m_Count >= 8)
+        {
+            bytes.push_back((unsigned char)m_Bits);
+            m_Bits >>= 8;
+            m_Count -= 8;
+        }
+    }
+    // Huffman codes are defined MSB-first
+    void putCode(uint32_t code, int length)
+    {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; i++)
+            reversed |= ((code >> i) & 1) << (length - 1 - i);
+        put(reversed, length);
+    }
+    void flush()
+    {
+        if (m_Count > 0)
+            bytes.push_back((unsigned char)m_Bits);
+        m_Bits = 0;
+        m_Count = 0;
+    }
+
+private:
+    uint32_t m_Bits = 0;
+    int m_Count = 0;
+};
+
+inline void deflateFixedSymbol(BitWriter& bits, int symbol)
+{
+    if (symbol < 144)      bits.putCode(0x30 + symbol, 8);
+    else if (symbol < 256) bits.putCode(0x190 + symbol - 144, 9);
+    else if (symbol < 280) bits.putCode(symbol - 256, 7);
+    else                   bits.putCode(0xC0 + symbol - 280, 8);
+}
+
+inline ByteBuffer zlibCompress(const unsigned char* data, size_t size)
+{
+    static const int lengthBase[29] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+    static const int lengthExtra[29] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+    static const int distBase[30] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+    static const int distExtra[30] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+    const int HASH_BITS = 15;
+    const size_t WINDOW = 32768;
+
+    BitWriter bits;
+    bits.put(0x78, 8);
+    bits.put(0x01, 8);
+    bits.put(1, 1); // final block
+    bits.put(1, 2); // fixed Huffman
+
+    std::vector<long long> head((size_t)1 << HASH_BITS, -1);
+    size_t i = 0;
+    while (i < size)
+    {
+        int bestLength = 0;
+        size_t bestDistance = 0;
+        if (i + 3 <= size)
+        {
+            uint32_t hash = ((data[i] << 16) | (data[i + 1] << 8) | data[i + 2]) * 2654435761u >> (32 - HASH_BITS);
+            long long candidate = head[hash];
+            head[hash] = (long long)i;
+            if (candidate >= 0 && i - (size_t)candidate <= WINDOW)
+            {
+                size_t limit = std::min<size_t>(258, size - i);
+                int length = 0;
+                while ((size_t)length < limit && data[candidate + length] == data[i + length])
+                    length++;
+                if (length >= 3)
+                {
+                    bestLength = length;
+                    bestDistance = i - (size_t)candidate;
+                }
+            }
+        }
+
+        if (bestLength == 0)
+        {
+            deflateFixedSymbol(bits, data[i]);
+            i++;
+            continue;
+        }
+
+        int code = 28;
+        while (lengthBase[code] > bestLength) code--;
+        deflateFixedSymbol(bits, 257 + code);
+        bits.put(bestLength - lengthBase[code], lengthExtra[code]);
+        int dcode = 29;
+        while (distBase[dcode] > (int)bestDistance) dcode--;
+        bits.putCode(dcode, 5);
+        bits.put((uint32_t)bestDistance - distBase[dcode], distExtra[dcode]);
+        i += bestLength;
+    }
+    deflateFixedSymbol(bits, 256);
+    bits.flush();
+
+    uint32_t a = 1, b = 0;
+    for (size_t k = 0; k < size; k++)
+    {
+        a = (a + data[k]) % 65521;
+        b = (b + a) % 65521;
+    }
+    uint32_t adler = (b << 16) | a;
+    for (int shift = 24; shift >= 0; shift -= 8)
+        bits.bytes.push_back((unsigned char)(adler >> shift));
+    return bits.bytes;
+}
+
+// ---------------------------------------------------------------------------
+// PNG: 8-bit, Sub filter on every row, single IDAT
+// ---------------------------------------------------------------------------
+inline uint32_t pngCrc(const unsigned char* data, size_t size, uint32_t crc = 0xFFFFFFFFu)
+{
+    static uint32_t table[256];
+    static bool built = false;
+    if (!built)
+    {
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        built = true;
+    }
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 255] ^ (crc >> 8);
+    return crc;
+}
+
+inline void pngChunk(ByteBuffer& out, const char* type, const ByteBuffer& payload)
+{
+    uint32_t length = (uint32_t)payload.size();
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back((unsigned char)(length >> shift));
+    size_t typeStart = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), payload.begin(), payload.end());
+    uint32_t crc = pngCrc(&out[typeStart], 4 + payload.size()) ^ 0xFFFFFFFFu;
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back((unsigned char)(crc >> shift));
+}
+
+inline ByteBuffer encodePNG(const unsigned char* pixels, int width, int height, int channels)
+{
+    static const unsigned char colorTypes[5] = { 0, 0, 4, 2, 6 };
+    size_t stride = (size_t)width * channels;
+    ByteBuffer filtered;
+    filtered.reserve((stride + 1) * height);
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* row = pixels + y * stride;
+        filtered.push_back(1); // Sub
+        for (size_t x = 0; x < stride; x++)
+            filtered.push_back((unsigned char)(row[x] - (x >= (size_t)channels ? row[x - channels] : 0)));
+    }
+
+    ByteBuffer out = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    ByteBuffer header(13, 0);
+    for (int shift = 24, i = 0; shift >= 0; shift -= 8, i++)
+    {
+        header[i] = (unsigned char)(width >> shift);
+        header[4 + i] = (unsigned char)(height >> shift);
+    }
+    header[8] = 8;
+    header[9] = colorTypes[channels];
+    pngChunk(out, "IHDR", header);
+    pngChunk(out, "IDAT", zlibCompress(filtered.data(), filtered.size()));
+    pngChunk(out, "IEND", ByteBuffer());
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// JPEG: baseline, 4:4:4 (or greyscale), standard Annex K Huffman tables
+// ---------------------------------------------------------------------------
+class JpegWriter
+{
+public:
+    static ByteBuffer encode(const unsigned char* pixels, int width, int height, int channels, int quality)
+    {
+        JpegWriter writer;
+        return writer.run(pixels, width, height, channels, quality);
+    }
+
+private:
+    ByteBuffer m_Out;
+    uint32_t m_Bits = 0;
+    int m_Count = 0;
+    uint16_t m_Codes[4][256];
+    unsigned char m_Lengths[4][256];
+
+    static const unsigned char* zigzag()
+    {
+        static const unsigned char order[64] = {
+            0,1,8,16,9,2,3,10,17,24,32,25,18,11,4,5,12,19,26,33,40,48,41,34,27,20,13,6,7,14,21,28,
+            35,42,49,56,57,50,43,36,29,22,15,23,30,37,44,51,58,59,52,45,38,31,39,46,53,60,61,54,47,55,62,63 };
+        return order;
+    }
+
+    struct HuffmanSpec { unsigned char bits[16]; const unsigned char* values; int count; };
+
+    static const HuffmanSpec& spec(int table)
+    {
+        static const unsigned char dcValues[12] = { 0,1,2,3,4,5,6,7,8,9,10,11 };
+        static const unsigned char acLumaValues[162] = {
+            0x01,0x02,0x03,0x00,0x04,0x11,0x05,0x12,0x21,0x31,0x41,0x06,0x13,0x51,0x61,0x07,0x22,0x71,0x14,0x32,0x81,0x91,0xa1,0x08,
+            0x23,0x42,0xb1,0xc1,0x15,0x52,0xd1,0xf0,0x24,0x33,0x62,0x72,0x82,0x09,0x0a,0x16,0x17,0x18,0x19,0x1a,0x25,0x26,0x27,0x28,
+            0x29,0x2a,0x34,0x35,0x36,0x37,0x38,0x39,0x3a,0x43,0x44,0x45,0x46,0x47,0x48,0x49,0x4a,0x53,0x54,0x55,0x56,0x57,0x58,0x59,
+            0x5a,0x63,0x64,0x65,0x66,0x67,0x68,0x69,0x6a,0x73,0x74,0x75,0x76,0x77,0x78,0x79,0x7a,0x83,0x84,0x85,0x86,0x87,0x88,0x89,
+            0x8a,0x92,0x93,0x94,0x95,0x96,0x97,0x98,0x99,0x9a,0xa2,0xa3,0xa4,0xa5,0xa6,0xa7,0xa8,0xa9,0xaa,0xb2,0xb3,0xb4,0xb5,0xb6,
+            0xb7,0xb8,0xb9,0xba,0xc2,0xc3,0xc4,0xc5,0xc6,0xc7,0xc8,0xc9,0xca,0xd2,0xd3,0xd4,0xd5,0xd6,0xd7,0xd8,0xd9,0xda,0xe1,0xe2,
+            0xe3,0xe4,0xe5,0xe6,0xe7,0xe8,0xe9,0xea,0xf1,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,0xf8,0xf9,0xfa };
+        static const unsigned char acChromaValues[162] = {
+            0x00,0x01,0x02,0x03,0x11,0x04,0x05,0x21,0x31,0x06,0x12,0x41,0x51,0x07,0x61,0x71,0x13,0x22,0x32,0x81,0x08,0x14,0x42,0x91,
+            0xa1,0xb1,0xc1,0x09,0x23,0x33,0x52,0xf0,0x15,0x62,0x72,0xd1,0x0a,0x16,0x24,0x34,0xe1,0x25,0xf1,0x17,0x18,0x19,0x1a,0x26,
+            0x27,0x28,0x29,0x2a,0x35,0x36,0x37,0x38,0x39,0x3a,0x43,0x44,0x45,0x46,0x47,0x48,0x49,0x4a,0x53,0x54,0x55,0x56,0x57,0x58,
+            0x59,0x5a,0x63,0x64,0x65,0x66,0x67,0x68,0x69,0x6a,0x73,0x74,0x75,0x76,0x77,0x78,0x79,0x7a,0x82,0x83,0x84,0x85,0x86,0x87,
+            0x88,0x89,0x8a,0x92,0x93,0x94,0x95,0x96,0x97,0x98,0x99,0x9a,0xa2,0xa3,0xa4,0xa5,0xa6,0xa7,0xa8,0xa9,0xaa,0xb2,0xb3,0xb4,
+            0xb5,0xb6,0xb7,0xb8,0xb9,0xba,0xc2,0xc3,0xc4,0xc5,0xc6,0xc7,0xc8,0xc9,0xca,0xd2,0xd3,0xd4,0xd5,0xd6,0xd7,0xd8,0xd9,0xda,
+            0xe2,0xe3,0xe4,0xe5,0xe6,0xe7,0xe8,0xe9,0xea,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,0xf8,0xf9,0xfa };
+        // 0: DC luma, 1: AC luma, 2: DC chroma, 3: AC chroma
+        static const HuffmanSpec specs[4] = {
+            { { 0,1,5,1,1,1,1,1,1,0,0,0,0,0,0,0 }, dcValues, 12 },
+            { { 0,2,1,3,3,2,4,3,5,5,4,4,0,0,1,0x7d }, acLumaValues, 162 },
+            { { 0,3,1,1,1,1,1,1,1,1,1,0,0,0,0,0 }, dcValues, 12 },
+            { { 0,2,1,2,4,4,3,4,7,5,4,4,0,1,2,0x77 }, acChromaValues, 162 },
+        };
+        return specs[table];
+    }
+
+    void byte(int value) { m_Out.push_back((unsigned char)value); }
+    void word(int value) { byte(value >> 8); byte(value & 255); }
+
+    // entropy-coded bits are MSB-first with 0xFF byte stuffing
+    void bits(uint32_t value, int count)
+    {
+        m_Bits = (m_Bits << count) | (value & ((1u << count) - 1));
+        m_Count += count;
+        while (m_Count >= 8)
+        {
+            unsigned char out = (unsigned char)(m_Bits >> (m_Count - 8));
+            byte(out);
+            if (out == 0xFF)
+                byte(0);
+            m_Count -= 8;
+        }
+    }
+
+    void buildCodes(int table)
+    {
+        const HuffmanSpec& s = spec(table);
+        int code = 0, k = 0;
+        for (int length = 1; length <= 16; length++)
+        {
+            for (int i = 0; i < s.bits[length - 1]; i++, k++)
+            {
+                m_Codes[table][s.values[k]] = (uint16_t)code++;
+                m_Lengths[table][s.values[k]] = (unsigned char)length;
+            }
+            code <<= 1;
+        }
+    }
+
+    void encodeValue(int table, int symbolHigh, int value)
+    {
+        int magnitude = value < 0 ? -value : value;
+        int size = 0;
+        while (magnitude >> size) size++;
+        int symbol = (symbolHigh << 4) | size;
+        bits(m_Codes[table][symbol], m_Lengths[table][symbol]);
+        if (size)
+            bits(value < 0 ? value + (1 << size) - 1 : value, size);
+    }
+
+    int encodeBlock(const float block[64], const float divisors[64], int dcTable, int acTable, int previousDC)
+    {
+        static float cosines[8][8];
+        static bool ready = false;
+        if (!ready)
+        {
+            for (int x = 0; x < 8; x++)
+                for (int u = 0; u < 8; u++)
+                    cosines[x][u] = std::cos((2 * x + 1) * u * 3.14159265358979f / 16) * (u == 0 ? 0.70710678f : 1.0f) * 0.5f;
+            ready = true;
+        }
+
+        float rows[64];
+        for (int y = 0; y < 8; y++)
+            for (int u = 0; u < 8; u++)
+            {
+                float sum = 0;
+                for (int x = 0; x < 8; x++)
+                    sum += block[y * 8 + x] * cosines[x][u];
+                rows[y * 8 + u] = sum;
+            }
+
+        int quantized[64];
+        for (int v = 0; v < 8; v++)
+            for (int u = 0; u < 8; u++)
+            {
+                float sum = 0;
+                for (int y = 0; y < 8; y++)
+                    sum += rows[y * 8 + u] * cosines[y][v];
+                float q = sum / divisors[v * 8 + u];
+                quantized[v * 8 + u] = (int)(q < 0 ? q - 0.5f : q + 0.5f);
+            }
+
+        const unsigned char* order = zigzag();
+        encodeValue(dcTable, 0, quantized[0] - previousDC);
+        int run = 0;
+        for (int k = 1; k < 64; k++)
+        {
+            int value = quantized[order[k]];
+            if (value == 0)
+            {
+                run++;
+                continue;
+            }
+            while (run > 15)
+            {
+                bits(m_Codes[acTable][0xF0], m_Lengths[acTable][0xF0]);
+                run -= 16;
+            }
+            encodeValue(acTable, run, value);
+            run = 0;
+        }
+        if (run > 0)
+            bits(m_Codes[acTable][0x00], m_Lengths[acTable][0x00]);
+        return quantized[0];
+    }
+
+    ByteBuffer run(const unsigned char* pixels, int width, int height, int channels, int quality)
+    {
+        static const unsigned char lumaQuant[64] = {
+            16,11,10,16,24,40,51,61, 12,12,14,19,26,58,60,55, 14,13,16,24,40,57,69,56, 14,17,22,29,51,87,80,62,
+            18,22,37,56,68,109,103,77, 24,35,55,64,81,104,113,92, 49,64,78,87,103,121,120,101, 72,92,95,98,112,100,103,99 };
+        static const unsigned char chromaQuant[64] = {
+            17,18,24,47,99,99,99,99, 18,21,26,66,99,99,99,99, 24,26,56,99,99,99,99,99, 47,66,99,99,99,99,99,99,
+            99,99,99,99,99,99,99,99, 99,99,99,99,99,99,99,99, 99,99,99,99,99,99,99,99, 99,99,99,99,99,99,99,99 };
+
+        int components = channels >= 3 ? 3 : 1;
+        int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+        unsigned char quant[2][64];
+        float divisors[2][64];
+        for (int i = 0; i < 64; i++)
+        {
+            int l = (lumaQuant[i] * scale + 50) / 100, c = (chromaQuant[i] * scale + 50) / 100;
+            quant[0][i] = (unsigned char)(l < 1 ? 1 : l > 255 ? 255 : l);
+            quant[1][i] = (unsigned char)(c < 1 ? 1 : c > 255 ? 255 : c);
+            divisors[0][i] = quant[0][i];
+            divisors[1][i] = quant[1][i];
+        }
+        for (int t = 0; t < 4; t++)
+            buildCodes(t);
+
+        const unsigned char* order = zigzag();
+        word(0xFFD8);
+        // JFIF APP0 so decoders treat three components as YCbCr
+        word(0xFFE0); word(16);
+        byte('J'); byte('F'); byte('I'); byte('F'); byte(0);
+        word(0x0101); byte(0); word(1); word(1); byte(0); byte(0);
+
+        for (int t = 0; t < components && t < 2; t++)
+        {
+            word(0xFFDB); word(67); byte(t);
+            for (int i = 0; i < 64; i++)
+                byte(quant[t][order[i]]);
+        }
+
+        word(0xFFC0); word(8 + 3 * components); byte(8);
+        word(height); word(width); byte(components);
+        for (int c = 0; c < components; c++)
+        {
+            byte(c + 1); byte(0x11); byte(c == 0 ? 0 : 1);
+        }
+
+        for (int t = 0; t < (components == 3 ? 4 : 2); t++)
+        {
+            const HuffmanSpec& s = spec(t);
+            word(0xFFC4); word(3 + 16 + s.count);
+            byte((t & 1) << 4 | (t >> 1));
+            for (int i = 0; i < 16; i++)
+                byte(s.bits[i]);
+            for (int i = 0; i < s.count; i++)
+                byte(s.values[i]);
+        }
+
+        word(0xFFDA); word(6 + 2 * components); byte(components);
+        for (int c = 0; c < components; c++)
+        {
+            byte(c + 1); byte(c == 0 ? 0x00 : 0x11);
+        }
+        byte(0); byte(63); byte(0);
+
+        int previousDC[3] = { 0, 0, 0 };
+        float block[3][64];
+        for (int by = 0; by < height; by += 8)
+        {
+            for (int bx = 0; bx < width; bx += 8)
+            {
+                for (int y = 0; y < 8; y++)
+                {
+                    for (int x = 0; x < 8; x++)
+                    {
+                        // replicate edge pixels into partial blocks
+                        int sx = bx + x < width ? bx + x : width - 1;
+                        int sy = by + y < height ? by + y : height - 1;
+                        const unsigned char* p = pixels + ((size_t)sy * width + sx) * channels;
+                        if (components == 3)
+                        {
+                            float r = p[0], g = p[1], b = p[2];
+                            block[0][y * 8 + x] = 0.299f * r + 0.587f * g + 0.114f * b - 128;
+                            block[1][y * 8 + x] = -0.168736f * r - 0.331264f * g + 0.5f * b;
+                            block[2][y * 8 + x] = 0.5f * r - 0.418688f * g - 0.081312f * b;
+                        }
+                        else
+                        {
+                            block[0][y * 8 + x] = (float)p[0] - 128;
+                        }
+                    }
+                }
+                for (int c = 0; c < components; c++)
+                    previousDC[c] = encodeBlock(block[c], divisors[c ? 1 : 0], c ? 2 : 0, c ? 3 : 1, previousDC[c]);
+            }
+        }
+
+        bits(0x7F, 7); // pad the final byte with 1s
+        word(0xFFD9);
+        return m_Out;
+    }
+};
+
+#endif
@@ -0,0 +1,158 @@
+// Standalone benchmark for the baked font-atlas cache (fontatlascache.h).
+//
+// Usage: font-atlas-bench [--json <file>] [--font <ttf> [--size <px>]] [--quick]
+//
+// Bakes the ImGui default font, and with --font a TTF/OTF merged into it with
+// the full Chinese glyph ranges (the case the cache is for), once with
+// ImFontAtlas::Build() and once restored with FontAtlasCache::load(). Both
+// include adding the fonts to a fresh atlas. Reports milliseconds per
+// startup, checks the restored atlas is identical to the built one, and
+// prints the texture memory of the RGBA32 and Alpha8 uploads.
+
+#include "fontatlascache.h"
+#include "bench_common.h"
+
+#include "imgui.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static std::vector<char> g_FontFile;
+static float g_FontSize = 18.0f;
+
+static void addFonts(ImFontAtlas& atlas)
+{
+    atlas.AddFontDefault();
+    if (g_FontFile.empty())
+        return;
+    ImFontConfig config;
+    config.MergeMode = true;
+    config.FontDataOwnedByAtlas = false;
+    config.OversampleH = 1;
+    config.PixelSnapH = true;
+    atlas.AddFontFromMemoryTTF(g_FontFile.data(), (int)g_FontFile.size(), g_FontSize, &config,
+        atlas.GetGlyphRangesChineseFull());
+}
+
+static bool sameAtlas(const ImFontAtlas& a, const ImFontAtlas& b)
+{
+    if (a.TexWidth != b.TexWidth || a.TexHeight != b.TexHeight || a.Fonts.Size != b.Fonts.Size
+        || memcmp(a.TexPixelsAlpha8, b.TexPixelsAlpha8, (size_t)a.TexWidth * a.TexHeight) != 0
+        || memcmp(&a.TexUvWhitePixel, &b.TexUvWhitePixel, sizeof(ImVec2)) != 0
+        || memcmp(a.TexUvLines, b.TexUvLines, sizeof(a.TexUvLines)) != 0)
+        return false;
+    for (int i = 0; i < a.Fonts.Size; i++)
+    {
+        const ImFont* fa = a.Fonts[i];
+        const ImFont* fb = b.Fonts[i];
+        if (fa->Glyphs.Size != fb->Glyphs.Size || fa->FontSize != fb->FontSize || fa->Ascent != fb->Ascent
+            || memcmp(fa->Glyphs.Data, fb->Glyphs.Data, (size_t)fa->Glyphs.Size * sizeof(ImFontGlyph)) != 0
+            || fa->IndexAdvanceX.Size != fb->IndexAdvanceX.Size || fa->FallbackChar != fb->FallbackChar
+            || fa->EllipsisChar != fb->EllipsisChar)
+            return false;
+    }
+    return true;
+}
+
+static void report(BenchJson& json, const char* path, const BenchTiming& timing, double baselineMs)
+{
+    printf("%-28s %10.3f %9.2fx\n", path, timing.medianMs, baselineMs / timing.medianMs);
+
+    json.beginResult();
+    json.field("path", path);
+    json.field("iterations", timing.iterations);
+    json.field("median_ms", timing.medianMs);
+    json.field("min_ms", timing.minMs);
+    json.field("speedup", baselineMs / timing.medianMs);
+}
+
+int main(int argc, char** argv)
+{
+    std::string jsonPath = "bench_font_atlas.json";
+    std::string fontPath;
+    bool quick = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--font") == 0 && i + 1 < argc) fontPath = argv[++i];
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) g_FontSize = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--quick") == 0) quick = true;
+        else
+        {
+            printf("usage: %s [--json <file>] [--font <ttf> [--size <px>]] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+    int minIterations = quick ? 2 : 5;
+    double minSeconds = quick ? 0.05 : 0.25;
+    if (!fontPath.empty() && !AssetPack::readWholeFile(fontPath, g_FontFile))
+    {
+        printf("cannot read %s\n", fontPath.c_str());
+        return 1;
+    }
+    const std::string cachePath = "bench_font_atlas.atlas";
+
+    ImFontAtlas built;
+    addFonts(built);
+    uint64_t cacheKey = FontAtlasCache::key(&built);
+    built.Build();
+    if (!FontAtlasCache::store(&built, cacheKey, cachePath))
+    {
+        printf("cannot write %s\n", cachePath.c_str());
+        return 1;
+    }
+    int glyphs = 0;
+    for (const ImFont* font : built.Fonts)
+        glyphs += font->Glyphs.Size;
+    size_t texels = (size_t)built.TexWidth * built.TexHeight;
+    printf("%s%s: %d glyphs, atlas %dx%d, cache file %zu KB\n", "default font", fontPath.empty() ? "" : (" + " + fontPath).c_str(),
+        glyphs, built.TexWidth, built.TexHeight, FontAtlasCache::stats().fileBytes / 1024);
+    printf("texture: RGBA32 %.1f KB, Alpha8 %.1f KB\n", texels * 4 / 1024.0, texels / 1024.0);
+
+    ImFontAtlas loaded;
+    addFonts(loaded);
+    bool matches = FontAtlasCache::load(&loaded, FontAtlasCache::key(&loaded), cachePath) && sameAtlas(built, loaded);
+
+    printf("%-28s %10s %10s\n", "path", "median ms", "speedup");
+    BenchJson json("font_atlas");
+    BenchTiming hashing = benchRun([&]() {
+        ImFontAtlas atlas;
+        addFonts(atlas);
+        FontAtlasCache::key(&atlas);
+    }, minIterations, minSeconds);
+    BenchTiming building = benchRun([&]() {
+        ImFontAtlas atlas;
+        addFonts(atlas);
+        atlas.Build();
+    }, minIterations, minSeconds);
+    report(json, "ImFontAtlas::Build", building, building.medianMs);
+    BenchTiming loading = benchRun([&]() {
+        ImFontAtlas atlas;
+        addFonts(atlas);
+        FontAtlasCache::load(&atlas, FontAtlasCache::key(&atlas), cachePath);
+    }, minIterations, minSeconds);
+    report(json, "FontAtlasCache::load", loading, building.medianMs);
+    report(json, "(of which adding + hashing)", hashing, building.medianMs);
+
+    json.beginResult();
+    json.field("glyphs", glyphs);
+    json.field("width", built.TexWidth);
+    json.field("height", built.TexHeight);
+    json.field("rgba32_bytes", texels * 4);
+    json.field("alpha8_bytes", texels);
+    json.field("cache_file_bytes", FontAtlasCache::stats().fileBytes);
+    json.field("identical", matches);
+    printf("restored atlas identical: %s\n", matches ? "yes" : "NO");
+    remove(cachePath.c_str());
+
+    if (!json.write(jsonPath))
+    {
+        printf("cannot write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    printf("results written to %s\n", jsonPath.c_str());
+    return matches ? 0 : 1;
+}
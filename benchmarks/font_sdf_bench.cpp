@@ -0,0 +1,178 @@
+// Standalone benchmark for the distance-field UI font (sdffont.h).
+//
+// Usage: font-sdf-bench [--json <file>] [--font <ttf>] [--quick]
+//
+// Changes the UI scale through 1x .. 3x of a 13 px font (the ImGui default
+// font, or --font), once the bitmap way, baking a new ImFontAtlas at every
+// scale, and once with one distance-field atlas that only changes its
+// font->Scale. Reports milliseconds per scale change and the Alpha8 texture
+// memory of each atlas, what baking and cache-loading the distance-field
+// atlas costs once, and how far text widths drift from the bitmap font's.
+
+#include "sdffont.h"
+#include "bench_common.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const float BASE_SIZE = 13.0f;
+static const char* SAMPLE_TEXT = "The quick brown fox jumps over the lazy dog 0123456789";
+
+static std::vector<char> g_FontFile;
+static const void* g_FontData = nullptr;
+static int g_FontDataSize = 0;
+
+static ImFont* addBitmapFont(ImFontAtlas& atlas, float size)
+{
+    ImFontConfig config;
+    config.SizePixels = size;
+    if (g_FontFile.empty())
+    {
+        config.OversampleH = config.OversampleV = 1;    // as AddFontDefault() bakes it
+        config.PixelSnapH = true;
+        return atlas.AddFontDefault(&config);
+    }
+    config.FontDataOwnedByAtlas = false;
+    return atlas.AddFontFromMemoryTTF(g_FontFile.data(), (int)g_FontFile.size(), size, &config);
+}
+
+static void report(BenchJson& json, const char* path, const char* scale, const BenchTiming& timing, size_t textureBytes,
+    double widthError)
+{
+    printf("%-20s %6s %10.3f %11.1f %10.2f%%\n", path, scale, timing.medianMs, textureBytes / 1024.0, widthError * 100.0);
+
+    json.beginResult();
+    json.field("path", path);
+    json.field("scale", scale);
+    json.field("iterations", timing.iterations);
+    json.field("median_ms", timing.medianMs);
+    json.field("min_ms", timing.minMs);
+    json.field("texture_bytes", textureBytes);
+    json.field("width_error", widthError);
+}
+
+int main(int argc, char** argv)
+{
+    std::string jsonPath = "bench_font_sdf.json";
+    std::string fontPath;
+    bool quick = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--font") == 0 && i + 1 < argc) fontPath = argv[++i];
+        else if (strcmp(argv[i], "--quick") == 0) quick = true;
+        else
+        {
+            printf("usage: %s [--json <file>] [--font <ttf>] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+    int minIterations = quick ? 2 : 5;
+    double minSeconds = quick ? 0.05 : 0.25;
+    if (!fontPath.empty() && !AssetPack::readWholeFile(fontPath, g_FontFile))
+    {
+        printf("cannot read %s\n", fontPath.c_str());
+        return 1;
+    }
+
+    // the distance-field font is baked from the same outlines
+    ImFontAtlas defaultAtlas;
+    defaultAtlas.AddFontDefault();
+    g_FontData = g_FontFile.empty() ? defaultAtlas.ConfigData[0].FontData : g_FontFile.data();
+    g_FontDataSize = g_FontFile.empty() ? defaultAtlas.ConfigData[0].FontDataSize : (int)g_FontFile.size();
+
+    ImFontAtlas sdfAtlas;
+    ImFont* sdfFont = SdfFont::build(&sdfAtlas, g_FontData, g_FontDataSize, BASE_SIZE, nullptr, SdfFont::BAKE_SIZE,
+        SdfFont::SPREAD, false);
+    if (!sdfFont)
+        return 1;
+    size_t sdfBytes = (size_t)sdfAtlas.TexWidth * sdfAtlas.TexHeight;
+    printf("%s: distance-field atlas %dx%d, %d glyphs at %.0f px\n", fontPath.empty() ? "default font" : fontPath.c_str(),
+        sdfAtlas.TexWidth, sdfAtlas.TexHeight, sdfFont->Glyphs.Size, SdfFont::BAKE_SIZE);
+
+    printf("%-20s %6s %10s %11s %11s\n", "path", "scale", "median ms", "texture KB", "width err");
+    BenchJson json("font_sdf");
+    const float scales[] = { 1.0f, 1.25f, 1.5f, 1.75f, 2.0f, 2.5f, 3.0f };
+    double bitmapMs = 0.0, sdfMs = 0.0;
+    size_t bitmapBytes = 0;
+    double worstWidthError = 0.0;
+    for (float scale : scales)
+    {
+        char label[16];
+        snprintf(label, sizeof(label), "%.2fx", scale);
+        float size = BASE_SIZE * scale;
+
+        // bitmap: a new atlas baked at the new size
+        BenchTiming rebuild = benchRun([&]() {
+            ImFontAtlas atlas;
+            addBitmapFont(atlas, size);
+            atlas.Build();
+        }, minIterations, minSeconds);
+        ImFontAtlas bitmapAtlas;
+        ImFont* bitmapFont = addBitmapFont(bitmapAtlas, size);
+        bitmapAtlas.Build();
+        size_t bytes = (size_t)bitmapAtlas.TexWidth * bitmapAtlas.TexHeight;
+        report(json, "bitmap rebuild", label, rebuild, bytes, 0.0);
+        bitmapMs += rebuild.medianMs;
+        bitmapBytes += bytes;
+
+        // distance field: the same atlas at another scale
+        BenchTiming rescale = benchRun([&]() {
+            sdfFont->Scale = size / SdfFont::BAKE_SIZE;
+        }, minIterations, minSeconds);
+        float bitmapWidth = bitmapFont->CalcTextSizeA(size, FLT_MAX, 0.0f, SAMPLE_TEXT).x;
+        float sdfWidth = sdfFont->CalcTextSizeA(size, FLT_MAX, 0.0f, SAMPLE_TEXT).x;
+        double widthError = fabs(sdfWidth - bitmapWidth) / bitmapWidth;
+        report(json, "distance field", label, rescale, sdfBytes, widthError);
+        sdfMs += rescale.medianMs;
+        worstWidthError = std::max(worstWidthError, widthError);
+    }
+
+    // once per font: baking the distance fields, or loading them from the font cache
+    BenchTiming baking = benchRun([&]() {
+        ImFontAtlas atlas;
+        SdfFont::build(&atlas, g_FontData, g_FontDataSize, BASE_SIZE, nullptr, SdfFont::BAKE_SIZE, SdfFont::SPREAD, false);
+    }, 1, minSeconds);
+    report(json, "distance field bake", "any", baking, sdfBytes, 0.0);
+    {
+        ImFontAtlas atlas;
+        SdfFont::build(&atlas, g_FontData, g_FontDataSize, BASE_SIZE);     // stores it
+    }
+    BenchTiming loading = benchRun([&]() {
+        ImFontAtlas atlas;
+        SdfFont::build(&atlas, g_FontData, g_FontDataSize, BASE_SIZE);
+    }, minIterations, minSeconds);
+    bool cached = SdfFont::stats().hit;
+    report(json, "distance field load", "any", loading, sdfBytes, 0.0);
+    remove(FontAtlasCache::pathFor(SdfFont::key(g_FontData, g_FontDataSize, defaultAtlas.GetGlyphRangesDefault(),
+        SdfFont::BAKE_SIZE, SdfFont::SPREAD)).c_str());
+
+    int scaleCount = (int)(sizeof(scales) / sizeof(scales[0]));
+    printf("%d scale changes: bitmap %.2f ms, distance field %.4f ms (after a %.1f ms bake, or a %.2f ms cache load%s)\n",
+        scaleCount, bitmapMs, sdfMs, baking.medianMs, loading.medianMs, cached ? "" : ", NOT cached");
+    printf("texture memory for every scale: bitmap %.1f KB, distance field %.1f KB; widths within %.2f%%\n",
+        bitmapBytes / 1024.0, sdfBytes / 1024.0, worstWidthError * 100.0);
+    json.beginResult();
+    json.field("scale_changes", scaleCount);
+    json.field("bitmap_total_ms", bitmapMs);
+    json.field("sdf_total_ms", sdfMs);
+    json.field("bitmap_total_bytes", bitmapBytes);
+    json.field("sdf_bytes", sdfBytes);
+    json.field("sdf_cached", cached);
+
+    if (!json.write(jsonPath))
+    {
+        printf("cannot write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    printf("results written to %s\n", jsonPath.c_str());
+    return cached ? 0 : 1;
+}
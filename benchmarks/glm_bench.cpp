@@ -0,0 +1,396 @@
+// Standalone benchmark for the glm operations the sandbox uses, built once per
+// glm configuration.
+//
+// Usage: glm-bench-<config> [--json <file>] [--baseline <file>] [--threshold <percent>]
+//                           [--save-baseline] [--count <n>] [--quick]
+//
+// glm-bench.vcxproj compiles this file into one executable per configuration,
+// picked with the GlmConfig property (a solution build makes all of them):
+//   default     glm as main.cpp uses it: no intrinsics, packed types
+//   intrinsics  GLM_FORCE_INTRINSICS
+//   aligned     GLM_FORCE_DEFAULT_ALIGNED_GENTYPES
+//   sse2        GLM_FORCE_DEFAULT_ALIGNED_GENTYPES + GLM_FORCE_SSE2 (which implies intrinsics)
+//   avx2        GLM_FORCE_DEFAULT_ALIGNED_GENTYPES + GLM_FORCE_AVX2, /arch:AVX2
+// The first line of the output says what glm made of the defines (GCC, for
+// one, only aligns the default types together with intrinsics).
+// The configurations cannot share one executable: the same glm function
+// instantiated under two of them would break the one-definition rule.
+//
+// Every kernel runs over n inputs; the table shows nanoseconds per operation
+// and the kernel's code size. The kernels live in a section of their own and
+// a kernel's size is the distance to the next one, so it counts everything
+// the compiler inlined into it (padding included) but not a glm function left
+// out of line. Sizes need a Release build (Debug's incremental linking turns
+// function addresses into jump thunks).
+//
+// Results go to bench_glm_<config>.json. --save-baseline also copies them to
+// the baseline file (bench_glm_<config>_baseline.json unless --baseline names
+// one); otherwise, if the baseline exists, every kernel whose ns/op or code
+// size grew by more than the threshold (default 10%) is flagged and the exit
+// code is 2.
+
+#include "bench_common.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#define GLM_BENCH_STRING2(x) #x
+#define GLM_BENCH_STRING(x) GLM_BENCH_STRING2(x)
+#if defined(GLM_BENCH_CONFIG)
+static const char* const configName = GLM_BENCH_STRING(GLM_BENCH_CONFIG);
+#else
+static const char* const configName = "default";
+#endif
+
+// The kernels' section, bracketed by two marker functions ($glma/$glmz sort around
+// $glmk in MSVC's .text; GNU linkers define __start_/__stop_ for the section)
+#if defined(_MSC_VER)
+#define GLM_KERNEL __declspec(noinline) __declspec(code_seg(".text$glmk"))
+__declspec(noinline) __declspec(code_seg(".text$glma")) static int kernelsBegin() { return 1; }
+__declspec(noinline) __declspec(code_seg(".text$glmz")) static int kernelsEnd() { return 2; }
+static uintptr_t kernelSectionBegin() { return (uintptr_t)&kernelsBegin; }
+static uintptr_t kernelSectionEnd() { return (uintptr_t)&kernelsEnd; }
+#elif defined(__GNUC__) && defined(__ELF__)
+#define GLM_KERNEL __attribute__((noinline, section("glm_kernels")))
+extern "C" char __start_glm_kernels[];
+extern "C" char __stop_glm_kernels[];
+static uintptr_t kernelSectionBegin() { return (uintptr_t)__start_glm_kernels; }
+static uintptr_t kernelSectionEnd() { return (uintptr_t)__stop_glm_kernels; }
+#else
+#define GLM_KERNEL
+static uintptr_t kernelSectionBegin() { return 0; }
+static uintptr_t kernelSectionEnd() { return 0; }
+#endif
+
+struct KernelInputs
+{
+    std::vector<glm::vec3> eyes, targets, positions, axes, scales, points;
+    std::vector<float> angles, yaws, pitches, fovs;
+    std::vector<glm::mat4> matrices;
+    std::vector<glm::quat> rotations;
+};
+
+struct KernelOutputs
+{
+    std::vector<glm::mat4> matrices;
+    std::vector<glm::vec3> vectors;
+    std::vector<glm::quat> rotations;
+};
+
+// Camera::GetViewMatrix
+GLM_KERNEL void kernelLookAt(const KernelInputs& in, KernelOutputs& out, int count)
+{
+    for (int i = 0; i < count; i++)
+        out.matrices[i] = glm::lookAt(in.eyes[i], in.targets[i], glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+GLM_KERNEL void kernelPerspective(const KernelInputs& in, KernelOutputs& out, int count)
+{
+    for (int i = 0; i < count; i++)
+        out.matrices[i] = glm::perspective(in.fovs[i], 16.0f / 9.0f, 0.1f, 500.0f);
+}
+
+GLM_KERNEL void kernelTranslateRotateScale(const KernelInputs& in, KernelOutputs& out, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), in.positions[i]);
+        model = glm::rotate(model, in.angles[i], in.axes[i]);
+        out.matrices[i] = glm::scale(model, in.scales[i]);
+    }
+}
+
+// Camera::updateCameraVectors
+GLM_KERNEL void kernelCameraVectors(const KernelInputs& in, KernelOutputs& out, int count)
+{
+    const glm::vec3 worldUp(0.0f, 1.0f, 0.0f);
+    for (int i = 0; i < count; i++)
+    {
+        glm::vec3 front;
+        front.x = cos(glm::radians(in.yaws[i])) * cos(glm::radians(in.pitches[i]));
+        front.y = sin(glm::radians(in.pitches[i]));
+        front.z = sin(glm::radians(in.yaws[i])) * cos(glm::radians(in.pitches[i]));
+        glm::vec3 frontUnit = glm::normalize(front);
+        glm::vec3 right = glm::normalize(glm::cross(frontUnit, worldUp));
+        out.vectors[3 * i] = frontUnit;
+        out.vectors[3 * i + 1] = right;
+        out.vectors[3 * i + 2] = glm::normalize(glm::cross(right, frontUnit));
+    }
+}
+
+GLM_KERNEL void kernelMultiply(const KernelInputs& in, KernelOutputs& out, int count)
+{
+    for (int i = 0; i < count; i++)
+        out.matrices[i] = in.matrices[i] * in.matrices[(i + 1) % count];
+}
+
+GLM_KERNEL void kernelInverse(const KernelInputs& in, KernelOutputs& out, int count)
+{
+    for (int i = 0; i < count; i++)
+        out.matrices[i] = glm::inverse(in.matrices[i]);
+}
+
+GLM_KERNEL void kernelQuatMultiply(const KernelInputs& in, KernelOutputs& out, int count)
+{
+    for (int i = 0; i < count; i++)
+        out.rotations[i] = glm::normalize(in.rotations[i] * in.rotations[(i + 1) % count]);
+}
+
+GLM_KERNEL void kernelQuatSlerp(const KernelInputs& in, KernelOutputs& out, int count)
+{
+    for (int i = 0; i < count; i++)
+        out.rotations[i] = glm::slerp(in.rotations[i], in.rotations[(i + 1) % count], 0.3f);
+}
+
+// BaseShape::modelMatrix
+GLM_KERNEL void kernelQuatToMat4(const KernelInputs& in, KernelOutputs& out, int count)
+{
+    for (int i = 0; i < count; i++)
+        out.matrices[i] = glm::mat4_cast(in.rotations[i]);
+}
+
+GLM_KERNEL void kernelQuatRotate(const KernelInputs& in, KernelOutputs& out, int count)
+{
+    for (int i = 0; i < count; i++)
+        out.vectors[i] = in.rotations[i] * in.points[i];
+}
+
+typedef void (*KernelFunction)(const KernelInputs&, KernelOutputs&, int);
+
+struct Kernel
+{
+    const char* name;
+    KernelFunction function;
+    size_t codeBytes;
+};
+
+// Each kernel's size is the gap to the next kernel (or the end of the section)
+static void measureCodeSizes(std::vector<Kernel>& kernels)
+{
+    uintptr_t sectionBegin = kernelSectionBegin(), sectionEnd = kernelSectionEnd();
+    std::vector<uintptr_t> starts;
+    for (const Kernel& kernel : kernels)
+        starts.push_back((uintptr_t)kernel.function);
+    std::sort(starts.begin(), starts.end());
+    for (Kernel& kernel : kernels)
+    {
+        uintptr_t start = (uintptr_t)kernel.function;
+        std::vector<uintptr_t>::iterator next = std::upper_bound(starts.begin(), starts.end(), start);
+        uintptr_t end = next != starts.end() ? *next : sectionEnd;
+        bool inSection = sectionBegin < sectionEnd && start >= sectionBegin && end <= sectionEnd;
+        kernel.codeBytes = inSection ? (size_t)(end - start) : 0;
+    }
+}
+
+struct BaselineEntry
+{
+    double nsPerOperation = 0.0;
+    double codeBytes = 0.0;
+};
+
+// A previous results file of this benchmark: BenchJson writes one result per line
+static bool findValue(const std::string& line, const std::string& key, std::string& value)
+{
+    std::string pattern = "\"" + key + "\": ";
+    size_t start = line.find(pattern);
+    if (start == std::string::npos)
+        return false;
+    start += pattern.size();
+    if (line[start] == '"')
+    {
+        size_t end = line.find('"', start + 1);
+        value = line.substr(start + 1, end - start - 1);
+    }
+    else
+    {
+        size_t end = line.find_first_of(",}", start);
+        value = line.substr(start, end - start);
+    }
+    return true;
+}
+
+static bool loadBaseline(const std::string& path, std::map<std::string, BaselineEntry>& baseline)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    std::string line, kernel, nsPerOperation, codeBytes;
+    while (std::getline(file, line))
+    {
+        if (!findValue(line, "kernel", kernel) || !findValue(line, "ns_per_op", nsPerOperation))
+            continue;
+        BaselineEntry& entry = baseline[kernel];
+        entry.nsPerOperation = atof(nsPerOperation.c_str());
+        entry.codeBytes = findValue(line, "code_bytes", codeBytes) ? atof(codeBytes.c_str()) : 0.0;
+    }
+    return !baseline.empty();
+}
+
+static const char* simdDescription()
+{
+#if GLM_CONFIG_SIMD == GLM_ENABLE
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+    return "AVX2";
+#elif GLM_ARCH & GLM_ARCH_AVX_BIT
+    return "AVX";
+#elif GLM_ARCH & GLM_ARCH_SSE41_BIT
+    return "SSE4.1";
+#elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+    return "SSE2";
+#elif GLM_ARCH & GLM_ARCH_NEON_BIT
+    return "NEON";
+#else
+    return "on";
+#endif
+#else
+    return "off";
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    std::string jsonPath = std::string("bench_glm_") + configName + ".json";
+    std::string baselinePath = std::string("bench_glm_") + configName + "_baseline.json";
+    double thresholdPercent = 10.0;
+    bool saveBaseline = false;
+    int count = 10000;
+    bool quick = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) thresholdPercent = atof(argv[++i]);
+        else if (strcmp(argv[i], "--save-baseline") == 0) saveBaseline = true;
+        else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) count = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--quick") == 0) quick = true;
+        else
+        {
+            printf("usage: %s [--json <file>] [--baseline <file>] [--threshold <percent>] [--save-baseline] [--count <n>] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+    int minIterations = quick ? 2 : 5;
+    double minSeconds = quick ? 0.05 : 0.25;
+
+    std::mt19937 random(2024);
+    std::uniform_real_distribution<float> coordinate(-50.0f, 50.0f), unit(-1.0f, 1.0f), size(0.2f, 3.0f), angle(0.0f, 6.2831853f),
+        yaw(-180.0f, 180.0f), pitch(-89.0f, 89.0f), fov(glm::radians(1.0f), glm::radians(45.0f));
+    KernelInputs in;
+    for (int i = 0; i < count; i++)
+    {
+        in.eyes.push_back(glm::vec3(coordinate(random), coordinate(random), coordinate(random)));
+        in.targets.push_back(in.eyes.back() + glm::vec3(unit(random), unit(random) * 0.5f, unit(random)) + glm::vec3(0.01f, 0.0f, 0.0f));
+        in.positions.push_back(glm::vec3(coordinate(random), coordinate(random), coordinate(random)));
+        in.axes.push_back(glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.01f, 0.0f)));
+        in.scales.push_back(glm::vec3(size(random), size(random), size(random)));
+        in.points.push_back(glm::vec3(coordinate(random), coordinate(random), coordinate(random)));
+        in.angles.push_back(angle(random));
+        in.yaws.push_back(yaw(random));
+        in.pitches.push_back(pitch(random));
+        in.fovs.push_back(fov(random));
+        in.rotations.push_back(glm::angleAxis(in.angles.back(), in.axes.back()));
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), in.positions.back());
+        in.matrices.push_back(glm::scale(model * glm::mat4_cast(in.rotations.back()), in.scales.back()));
+    }
+    KernelOutputs out;
+    out.matrices.resize(count);
+    out.vectors.resize((size_t)count * 3);
+    out.rotations.resize(count);
+
+    std::vector<Kernel> kernels = {
+        { "lookAt", kernelLookAt, 0 },
+        { "perspective", kernelPerspective, 0 },
+        { "translate/rotate/scale", kernelTranslateRotateScale, 0 },
+        { "camera vectors", kernelCameraVectors, 0 },
+        { "mat4 * mat4", kernelMultiply, 0 },
+        { "inverse", kernelInverse, 0 },
+        { "quat * quat", kernelQuatMultiply, 0 },
+        { "quat slerp", kernelQuatSlerp, 0 },
+        { "quat to mat4", kernelQuatToMat4, 0 },
+        { "quat * vec3", kernelQuatRotate, 0 },
+    };
+    measureCodeSizes(kernels);
+
+    std::map<std::string, BaselineEntry> baseline;
+    bool compare = !saveBaseline && loadBaseline(baselinePath, baseline);
+
+#if defined(GLM_FORCE_DEFAULT_ALIGNED_GENTYPES)
+    const char* defaultTypes = "aligned";
+#else
+    const char* defaultTypes = "packed";
+#endif
+    printf("glm configuration %s: SIMD %s, %s default types, sizeof(vec3) %d, %d operations per kernel\n", configName,
+        simdDescription(), defaultTypes, (int)sizeof(glm::vec3), count);
+    if (compare)
+        printf("baseline %s, threshold %.1f%%\n", baselinePath.c_str(), thresholdPercent);
+    printf("%-24s %9s %8s %10s %10s\n", "kernel", "ns/op", "bytes", "ns/op vs", "bytes vs");
+    BenchJson json("glm");
+
+    int regressions = 0;
+    for (const Kernel& kernel : kernels)
+    {
+        BenchTiming timing = benchRun([&]() { kernel.function(in, out, count); }, minIterations, minSeconds);
+        double nsPerOperation = timing.medianMs * 1e6 / count;
+        printf("%-24s %9.2f %8d", kernel.name, nsPerOperation, (int)kernel.codeBytes);
+
+        json.beginResult();
+        json.field("config", configName);
+        json.field("kernel", kernel.name);
+        json.field("count", count);
+        json.field("iterations", timing.iterations);
+        json.field("median_ms", timing.medianMs);
+        json.field("min_ms", timing.minMs);
+        json.field("ns_per_op", nsPerOperation);
+        json.field("code_bytes", kernel.codeBytes);
+
+        std::map<std::string, BaselineEntry>::const_iterator entry = baseline.find(kernel.name);
+        if (compare && entry != baseline.end())
+        {
+            double timeChange = 100.0 * (nsPerOperation / entry->second.nsPerOperation - 1.0);
+            double sizeChange = entry->second.codeBytes > 0.0 ? 100.0 * (kernel.codeBytes / entry->second.codeBytes - 1.0) : 0.0;
+            bool regressed = timeChange > thresholdPercent || sizeChange > thresholdPercent;
+            regressions += regressed ? 1 : 0;
+            printf(" %+9.1f%% %+9.1f%%%s", timeChange, sizeChange, regressed ? "  REGRESSION" : "");
+            json.field("ns_per_op_change_percent", timeChange);
+            json.field("code_bytes_change_percent", sizeChange);
+            json.field("regression", regressed);
+        }
+        printf("\n");
+    }
+
+    if (!json.write(jsonPath))
+    {
+        printf("cannot write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    printf("results written to %s\n", jsonPath.c_str());
+    if (saveBaseline)
+    {
+        if (!json.write(baselinePath))
+        {
+            printf("cannot write %s\n", baselinePath.c_str());
+            return 1;
+        }
+        printf("baseline written to %s\n", baselinePath.c_str());
+    }
+    else if (compare)
+    {
+        printf("%d of %d kernels regressed by more than %.1f%%\n", regressions, (int)kernels.size(), thresholdPercent);
+        if (regressions > 0)
+            return 2;
+    }
+    return 0;
+}
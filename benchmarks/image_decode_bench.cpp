@@ -0,0 +1,326 @@
+// Standalone decode benchmark for the vendored stb_image.
+//
+// Usage: image-decode-bench [--json <file>] [--corpus <dir>] [--quick]
+//
+// Decodes every texture in resources/textures plus a generated corpus of large
+// PNG/JPEG/TGA files, and reports throughput together with the allocation
+// behaviour seen through the STBI_MALLOC/STBI_REALLOC/STBI_FREE hooks. Set
+// LOGL_ROOT_PATH (as for the sandbox itself) if not running from the repo root.
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+// allocation accounting; every block carries its size in a 16-byte prefix so
+// frees and reallocs can be attributed without a side table
+// ---------------------------------------------------------------------------
+struct AllocStats
+{
+    long long allocations = 0;
+    long long reallocations = 0;
+    long long frees = 0;
+    size_t currentBytes = 0;
+    size_t peakBytes = 0;
+};
+
+static AllocStats g_Alloc;
+static const size_t ALLOC_HEADER = 16;
+
+static void* benchMalloc(size_t size)
+{
+    unsigned char* block = (unsigned char*)malloc(size + ALLOC_HEADER);
+    if (!block)
+        return nullptr;
+    memcpy(block, &size, sizeof(size));
+    g_Alloc.allocations++;
+    g_Alloc.currentBytes += size;
+    if (g_Alloc.currentBytes > g_Alloc.peakBytes)
+        g_Alloc.peakBytes = g_Alloc.currentBytes;
+    return block + ALLOC_HEADER;
+}
+
+static void benchFree(void* p)
+{
+    if (!p)
+        return;
+    unsigned char* block = (unsigned char*)p - ALLOC_HEADER;
+    size_t size;
+    memcpy(&size, block, sizeof(size));
+    g_Alloc.frees++;
+    g_Alloc.currentBytes -= size;
+    free(block);
+}
+
+static void* benchRealloc(void* p, size_t newSize)
+{
+    if (!p)
+        return benchMalloc(newSize);
+    unsigned char* block = (unsigned char*)p - ALLOC_HEADER;
+    size_t oldSize;
+    memcpy(&oldSize, block, sizeof(oldSize));
+    unsigned char* grown = (unsigned char*)realloc(block, newSize + ALLOC_HEADER);
+    if (!grown)
+        return nullptr;
+    memcpy(grown, &newSize, sizeof(newSize));
+    g_Alloc.reallocations++;
+    g_Alloc.currentBytes = g_Alloc.currentBytes - oldSize + newSize;
+    if (g_Alloc.currentBytes > g_Alloc.peakBytes)
+        g_Alloc.peakBytes = g_Alloc.currentBytes;
+    return grown + ALLOC_HEADER;
+}
+
+#define STBI_MALLOC(sz)       benchMalloc(sz)
+#define STBI_REALLOC(p, newsz) benchRealloc(p, newsz)
+#define STBI_FREE(p)          benchFree(p)
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "bench_common.h"
+#include "bench_image_writers.h"
+#include "filesystem.h"
+#include "assetpack.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct ImageFile
+{
+    std::string name;    // label used in the report
+    std::string path;    // on-disk location (for the stbi_load/stbi_info file paths)
+    std::vector<char> bytes;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+};
+
+struct CaseResult
+{
+    BenchTiming timing;
+    AllocStats alloc;
+};
+
+// times `op`, then runs it once more with fresh counters to attribute allocations
+template <typename Op>
+static CaseResult measure(Op op, int minIterations, double minSeconds)
+{
+    CaseResult result;
+    result.timing = benchRun(op, minIterations, minSeconds);
+
+    AllocStats before = g_Alloc;
+    g_Alloc.peakBytes = g_Alloc.currentBytes;
+    op();
+    result.alloc.allocations = g_Alloc.allocations - before.allocations;
+    result.alloc.reallocations = g_Alloc.reallocations - before.reallocations;
+    result.alloc.frees = g_Alloc.frees - before.frees;
+    result.alloc.peakBytes = g_Alloc.peakBytes - before.currentBytes;
+    result.alloc.currentBytes = g_Alloc.currentBytes - before.currentBytes; // non-zero means a leak
+    g_Alloc.peakBytes = before.peakBytes > g_Alloc.peakBytes ? before.peakBytes : g_Alloc.peakBytes;
+    return result;
+}
+
+static void report(BenchJson& json, const char* api, const std::string& image, size_t inputBytes, long long pixels, const CaseResult& r)
+{
+    double seconds = r.timing.medianMs / 1000.0;
+    double mbPerSecond = seconds > 0 ? inputBytes / (1024.0 * 1024.0) / seconds : 0.0;
+    double mpixPerSecond = seconds > 0 && pixels > 0 ? pixels / 1.0e6 / seconds : 0.0;
+
+    printf("%-32s %-24s %9.3f %9.1f %9.1f %8lld %10.2f\n", api, image.c_str(), r.timing.medianMs,
+        mbPerSecond, mpixPerSecond, r.alloc.allocations, r.alloc.peakBytes / (1024.0 * 1024.0));
+
+    json.beginResult();
+    json.field("api", api);
+    json.field("image", image);
+    json.field("input_bytes", inputBytes);
+    json.field("pixels", pixels);
+    json.field("iterations", r.timing.iterations);
+    json.field("mean_ms", r.timing.meanMs);
+    json.field("median_ms", r.timing.medianMs);
+    json.field("min_ms", r.timing.minMs);
+    json.field("mb_per_s", mbPerSecond);
+    json.field("mpixel_per_s", mpixPerSecond);
+    json.field("allocations", r.alloc.allocations);
+    json.field("reallocations", r.alloc.reallocations);
+    json.field("frees", r.alloc.frees);
+    json.field("peak_bytes", r.alloc.peakBytes);
+    json.field("leaked_bytes", r.alloc.currentBytes);
+}
+
+static bool writeFile(const std::string& path, const ByteBuffer& bytes)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    size_t written = fwrite(bytes.data(), 1, bytes.size(), file);
+    fclose(file);
+    return written == bytes.size();
+}
+
+// generates the large synthetic corpus once; existing files are reused
+static void buildCorpus(const std::string& dir, const std::vector<int>& sizes, std::vector<ImageFile>& images)
+{
+    std::error_code ignored;
+    std::filesystem::create_directories(dir, ignored);
+    for (int size : sizes)
+    {
+        const char* kinds[] = { "png", "jpg", "tga" };
+        ByteBuffer pixels;
+        for (const char* kind : kinds)
+        {
+            std::string name = "synthetic_" + std::to_string(size) + "." + kind;
+            std::string path = dir + "/" + name;
+            if (!std::filesystem::exists(path))
+            {
+                if (pixels.empty())
+                    pixels = makeTestImage(size, size, 3, (unsigned int)size);
+                ByteBuffer encoded;
+                if (strcmp(kind, "png") == 0)
+                    encoded = encodePNG(pixels.data(), size, size, 3);
+                else if (strcmp(kind, "jpg") == 0)
+                    encoded = JpegWriter::encode(pixels.data(), size, size, 3, 90);
+                else
+                    encoded = encodeTGA(pixels.data(), size, size, 3, true);
+                if (!writeFile(path, encoded))
+                {
+                    printf("cannot write corpus file %s\n", path.c_str());
+                    continue;
+                }
+            }
+            ImageFile image;
+            image.name = name;
+            image.path = path;
+            images.push_back(image);
+        }
+    }
+}
+
+// concatenates the IDAT payloads of a PNG into its zlib stream
+static bool extractZlibStream(const std::vector<char>& png, std::vector<char>& out)
+{
+    const unsigned char* p = (const unsigned char*)png.data();
+    size_t size = png.size();
+    if (size < 8 || memcmp(p, "\x89PNG", 4) != 0)
+        return false;
+    out.clear();
+    for (size_t pos = 8; pos + 12 <= size;)
+    {
+        size_t length = ((size_t)p[pos] << 24) | (p[pos + 1] << 16) | (p[pos + 2] << 8) | p[pos + 3];
+        if (pos + 12 + length > size)
+            return false;
+        if (memcmp(p + pos + 4, "IDAT", 4) == 0)
+            out.insert(out.end(), png.begin() + pos + 8, png.begin() + pos + 8 + length);
+        pos += 12 + length;
+    }
+    return !out.empty();
+}
+
+int main(int argc, char** argv)
+{
+    std::string jsonPath = "bench_image_decode.json";
+    std::string corpusDir = "bench_corpus";
+    bool quick = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--corpus") == 0 && i + 1 < argc) corpusDir = argv[++i];
+        else if (strcmp(argv[i], "--quick") == 0) quick = true;
+        else
+        {
+            printf("usage: %s [--json <file>] [--corpus <dir>] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+    int minIterations = quick ? 2 : 5;
+    double minSeconds = quick ? 0.05 : 0.25;
+
+    std::vector<ImageFile> images;
+    std::string textureDir = FileSystem::getPath("resources/textures");
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(textureDir, error))
+    {
+        if (!entry.is_regular_file())
+            continue;
+        ImageFile image;
+        image.name = entry.path().filename().string();
+        image.path = entry.path().string();
+        images.push_back(image);
+    }
+    if (error)
+        printf("cannot list %s (set LOGL_ROOT_PATH to the repo root)\n", textureDir.c_str());
+    std::sort(images.begin(), images.end(), [](const ImageFile& a, const ImageFile& b) { return a.name < b.name; });
+    buildCorpus(corpusDir, quick ? std::vector<int>{ 1024 } : std::vector<int>{ 1024, 4096 }, images);
+
+    for (size_t i = 0; i < images.size();)
+    {
+        ImageFile& image = images[i];
+        if (!AssetPack::readWholeFile(image.path, image.bytes)
+            || !stbi_info_from_memory((const stbi_uc*)image.bytes.data(), (int)image.bytes.size(), &image.width, &image.height, &image.channels))
+        {
+            printf("skipping %s: %s\n", image.name.c_str(), image.bytes.empty() ? "unreadable" : stbi_failure_reason());
+            images.erase(images.begin() + i);
+            continue;
+        }
+        i++;
+    }
+
+    BenchJson json("image_decode");
+    printf("%-32s %-24s %9s %9s %9s %8s %10s\n", "api", "image", "median ms", "MB/s", "MPix/s", "allocs", "peak MB");
+
+    for (const ImageFile& image : images)
+    {
+        const stbi_uc* data = (const stbi_uc*)image.bytes.data();
+        int length = (int)image.bytes.size();
+        long long pixels = (long long)image.width * image.height;
+        int x, y, n;
+
+        report(json, "stbi_info", image.name, image.bytes.size(), 0, measure([&]() {
+            stbi_info(image.path.c_str(), &x, &y, &n);
+        }, minIterations, minSeconds));
+
+        report(json, "stbi_info_from_memory", image.name, image.bytes.size(), 0, measure([&]() {
+            stbi_info_from_memory(data, length, &x, &y, &n);
+        }, minIterations, minSeconds));
+
+        report(json, "stbi_load", image.name, image.bytes.size(), pixels, measure([&]() {
+            stbi_image_free(stbi_load(image.path.c_str(), &x, &y, &n, 0));
+        }, minIterations, minSeconds));
+
+        report(json, "stbi_load_from_memory", image.name, image.bytes.size(), pixels, measure([&]() {
+            stbi_image_free(stbi_load_from_memory(data, length, &x, &y, &n, 0));
+        }, minIterations, minSeconds));
+
+        // the path main.cpp uses for textures: RGB into a caller-owned, flipped buffer
+        int stride = (image.width * 3 + 3) & ~3;
+        std::vector<stbi_uc> target((size_t)stride * image.height);
+        report(json, "stbi_load_into_from_memory", image.name, image.bytes.size(), pixels, measure([&]() {
+            stbi_load_into_from_memory(data, length, target.data(), target.size(), stride, &x, &y, &n, 3, 1);
+        }, minIterations, minSeconds));
+
+        for (int denom = 2; denom <= 8; denom *= 2)
+        {
+            std::string label = "stbi_load_scaled_from_memory/" + std::to_string(denom);
+            report(json, label.c_str(), image.name, image.bytes.size(), pixels, measure([&]() {
+                stbi_image_free(stbi_load_scaled_from_memory(data, length, &x, &y, &n, 0, denom));
+            }, minIterations, minSeconds));
+        }
+
+        std::vector<char> stream;
+        if (extractZlibStream(image.bytes, stream))
+        {
+            int inflated = 0;
+            report(json, "stbi_zlib_decode_malloc", image.name, stream.size(), 0, measure([&]() {
+                stbi_image_free(stbi_zlib_decode_malloc(stream.data(), (int)stream.size(), &inflated));
+            }, minIterations, minSeconds));
+        }
+    }
+
+    if (!json.write(jsonPath))
+    {
+        printf("cannot write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    printf("results written to %s\n", jsonPath.c_str());
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Standalone benchmark for retained ImGui windows (retainedwindow.h).
+//
+// Usage: imgui-retained-bench [--json <file>] [--count <n>] [--quick]
+//
+// Builds ImGui frames (NewFrame, n static panels of text, a progress bar and
+// a few widgets, Render) in a headless context, once submitting every window
+// every frame and once through RetainedWindow, first with the mouse away from
+// the windows and then hovering one of them (which is rebuilt every frame).
+// Reports CPU milliseconds per frame, the windows built and retained per
+// frame, and whether the draw data matches the immediate-mode frame.
+
+#include "retainedwindow.h"
+#include "redrawgate.h"
+#include "bench_common.h"
+
+#include "imgui.h"
+
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Panel
+{
+    std::string name;
+    float values[4];
+    bool enabled;
+    float progress;
+};
+
+static void panelContents(Panel& panel)
+{
+    ImGui::Text("%s", panel.name.c_str());
+    ImGui::Separator();
+    for (int k = 0; k < 4; k++)
+        ImGui::Text("value %d: %.3f", k, panel.values[k]);
+    ImGui::Checkbox("Enabled", &panel.enabled);
+    ImGui::SliderFloat("Scale", &panel.values[0], 0.0f, 10.0f);
+    ImGui::ProgressBar(panel.progress);
+}
+
+static void buildFrame(std::vector<Panel>& panels, std::vector<RetainedWindow>* retained, const ImVec2& mouse)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    io.MousePos = mouse;
+    ImGui::NewFrame();
+    for (size_t i = 0; i < panels.size(); i++)
+    {
+        Panel& panel = panels[i];
+        ImGui::SetNextWindowPos(ImVec2(10.0f + (i % 8) * 230.0f, 10.0f + (i / 8) * 40.0f), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowSize(ImVec2(220.0f, 180.0f), ImGuiCond_FirstUseEver);
+        if (retained)
+        {
+            RedrawGate::Key key;
+            key.add(panel.values).add(panel.enabled).add(panel.progress);
+            if ((*retained)[i].begin(panel.name.c_str(), key.value, true))
+                panelContents(panel);
+            (*retained)[i].end();
+        }
+        else
+        {
+            if (ImGui::Begin(panel.name.c_str()))
+                panelContents(panel);
+            ImGui::End();
+        }
+    }
+    ImGui::Render();
+}
+
+static void report(BenchJson& json, const char* scenario, const char* path, int count, const BenchTiming& timing,
+    double baselineMs, double builtPerFrame, double reusedPerFrame, bool matches)
+{
+    printf("%-10s %-10s %9.3f %8.2fx %8.1f %8.1f %8s\n", scenario, path, timing.medianMs, baselineMs / timing.medianMs,
+        builtPerFrame, reusedPerFrame, matches ? "yes" : "NO");
+
+    json.beginResult();
+    json.field("scenario", scenario);
+    json.field("path", path);
+    json.field("windows", count);
+    json.field("iterations", timing.iterations);
+    json.field("median_ms", timing.medianMs);
+    json.field("min_ms", timing.minMs);
+    json.field("speedup", baselineMs / timing.medianMs);
+    json.field("built_per_frame", builtPerFrame);
+    json.field("retained_per_frame", reusedPerFrame);
+    json.field("draw_data_matches", matches);
+}
+
+int main(int argc, char** argv)
+{
+    std::string jsonPath = "bench_imgui_retained.json";
+    int count = 200;
+    bool quick = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) count = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--quick") == 0) quick = true;
+        else
+        {
+            printf("usage: %s [--json <file>] [--count <n>] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+    int minIterations = quick ? 2 : 5;
+    double minSeconds = quick ? 0.05 : 0.25;
+
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+    io.DeltaTime = 1.0f / 60.0f;
+    io.BackendRendererName = "none";
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    io.Fonts->SetTexID((ImTextureID)(intptr_t)1);
+
+    std::vector<Panel> panels(count);
+    for (int i = 0; i < count; i++)
+    {
+        panels[i].name = "Panel " + std::to_string(i);
+        for (int k = 0; k < 4; k++)
+            panels[i].values[k] = i * 0.5f + k;
+        panels[i].enabled = (i % 2) == 0;
+        panels[i].progress = (i % 100) / 100.0f;
+    }
+    std::vector<RetainedWindow> retained(count);
+
+    printf("%d windows\n", count);
+    printf("%-10s %-10s %9s %9s %8s %8s %8s\n", "scenario", "path", "median ms", "speedup", "built", "retained", "matches");
+    BenchJson json("imgui_retained");
+
+    // the mouse off every window, then over the title bar of the last one
+    // (the top-most, so it is the one hovered)
+    struct Scenario { const char* name; ImVec2 mouse; };
+    Scenario scenarios[] = {
+        { "static", ImVec2(-FLT_MAX, -FLT_MAX) },
+        { "hovered", ImVec2(110.0f, 18.0f) },
+    };
+    for (const Scenario& scenario : scenarios)
+    {
+        // a few frames so windows have appeared and the hover is settled
+        for (int frame = 0; frame < 5; frame++)
+            buildFrame(panels, nullptr, scenario.mouse);
+        uint64_t immediateHash = RedrawGate::hashDrawData(ImGui::GetDrawData());
+        BenchTiming immediate = benchRun([&]() { buildFrame(panels, nullptr, scenario.mouse); }, minIterations, minSeconds);
+        report(json, scenario.name, "immediate", count, immediate, immediate.medianMs, (double)count, 0.0, true);
+
+        for (int frame = 0; frame < 5; frame++)
+            buildFrame(panels, &retained, scenario.mouse);
+        uint64_t retainedHash = RedrawGate::hashDrawData(ImGui::GetDrawData());
+        int built = 0, reused = 0;
+        RetainedWindow::takeCounts(&built, &reused);
+        BenchTiming timing = benchRun([&]() { buildFrame(panels, &retained, scenario.mouse); }, minIterations, minSeconds);
+        RetainedWindow::takeCounts(&built, &reused);
+        int frames = timing.iterations + 1;
+        report(json, scenario.name, "retained", count, timing, immediate.medianMs, (double)built / frames,
+            (double)reused / frames, retainedHash == immediateHash);
+    }
+    ImGui::DestroyContext();
+
+    if (!json.write(jsonPath))
+    {
+        printf("cannot write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    printf("results written to %s\n", jsonPath.c_str());
+    return 0;
+}
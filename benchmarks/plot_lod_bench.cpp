@@ -0,0 +1,200 @@
+// Standalone benchmark for decimated line plots (plotlod.h).
+//
+// Usage: plot-lod-bench [--json <file>] [--width <px>] [--quick]
+//
+// Plots a frame-time log of 10K, 1M and 10M samples (a noisy 16 ms with a
+// few one-sample spikes) in a headless ImGui frame, once with
+// ImGui::PlotLines() and once with PlotLod::plotLines(), first the whole log
+// and then a window of a tenth of it panning along (a zoomed-in view). Reports
+// CPU milliseconds per frame, the vertices the plot window emits, whether
+// the tallest spike is drawn, and what pushing the samples into the pyramid
+// costs. The pyramid's ranges are checked against a plain scan.
+
+#include "plotlod.h"
+#include "bench_common.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static float g_Width = 600.0f;
+
+struct PlotResult
+{
+    int vertices = 0;
+    bool spikeDrawn = false;
+};
+
+// one frame with one window holding the plot of [first, first + count)
+static PlotResult plotFrame(PlotLod& series, bool decimated, int first, int count)
+{
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(g_Width + 100.0f, 200.0f));
+    ImGui::Begin("Plot");
+    ImGui::SetNextItemWidth(g_Width);
+    float top = ImGui::GetCursorScreenPos().y + ImGui::GetStyle().FramePadding.y;
+    if (decimated)
+        series.plotLines("##frames", first, count, nullptr, FLT_MAX, FLT_MAX, ImVec2(0.0f, 120.0f));
+    else
+        ImGui::PlotLines("##frames", series.data() + first, count, 0, nullptr, FLT_MAX, FLT_MAX, ImVec2(0.0f, 120.0f));
+    ImDrawList* list = ImGui::GetWindowDrawList();
+    ImGui::End();
+    ImGui::Render();
+
+    // auto-scaled, the tallest sample is at the top of the plot
+    PlotResult result;
+    result.vertices = list->VtxBuffer.Size;
+    for (const ImDrawVert& vertex : list->VtxBuffer)
+        if (vertex.pos.y <= top + 2.5f && vertex.pos.y >= top - 2.5f)
+            result.spikeDrawn = true;
+    return result;
+}
+
+static bool rangesMatch(const PlotLod& series)
+{
+    const float* values = series.data();
+    uint32_t state = 12345u;
+    for (int i = 0; i < 2000; i++)
+    {
+        state = state * 1664525u + 1013904223u;
+        int first = (int)(state % (uint32_t)series.size());
+        state = state * 1664525u + 1013904223u;
+        int count = (int)(state % (uint32_t)std::min(series.size() - first, i < 1000 ? 100 : series.size()));
+        float vMin, vMax;
+        series.range(first, count, &vMin, &vMax);
+        float sMin = FLT_MAX, sMax = -FLT_MAX;
+        for (int k = first; k < first + count; k++)
+        {
+            sMin = std::min(sMin, values[k]);
+            sMax = std::max(sMax, values[k]);
+        }
+        if (vMin != sMin || vMax != sMax)
+            return false;
+    }
+    return true;
+}
+
+static void report(BenchJson& json, int samples, const char* view, const char* path, const BenchTiming& timing,
+    double baselineMs, const PlotResult& result)
+{
+    printf("%9d %-7s %-16s %10.3f %8.1fx %9d %6s\n", samples, view, path, timing.medianMs, baselineMs / timing.medianMs,
+        result.vertices, result.spikeDrawn ? "yes" : "no");
+
+    json.beginResult();
+    json.field("samples", samples);
+    json.field("view", view);
+    json.field("path", path);
+    json.field("iterations", timing.iterations);
+    json.field("median_ms", timing.medianMs);
+    json.field("min_ms", timing.minMs);
+    json.field("speedup", baselineMs / timing.medianMs);
+    json.field("vertices", result.vertices);
+    json.field("spike_drawn", result.spikeDrawn);
+}
+
+int main(int argc, char** argv)
+{
+    std::string jsonPath = "bench_plot_lod.json";
+    bool quick = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--width") == 0 && i + 1 < argc) g_Width = std::max(16.0f, (float)atof(argv[++i]));
+        else if (strcmp(argv[i], "--quick") == 0) quick = true;
+        else
+        {
+            printf("usage: %s [--json <file>] [--width <px>] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+    int minIterations = quick ? 2 : 5;
+    double minSeconds = quick ? 0.05 : 0.25;
+
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+    io.DeltaTime = 1.0f / 60.0f;
+    io.BackendRendererName = "none";
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    io.Fonts->SetTexID((ImTextureID)(intptr_t)1);
+
+    printf("plot %.0f px wide\n", g_Width);
+    printf("%9s %-7s %-16s %10s %9s %9s %6s\n", "samples", "view", "path", "median ms", "speedup", "vertices", "spike");
+    BenchJson json("plot_lod");
+    bool matches = true;
+    const int sizes[] = { 10000, 1000000, 10000000 };
+    for (int samples : sizes)
+    {
+        // 16 ms +- 2, a 60 ms spike every 104729 samples and one 80 ms spike
+        std::vector<float> values(samples);
+        uint32_t state = 1u;
+        for (int i = 0; i < samples; i++)
+        {
+            state = state * 1664525u + 1013904223u;
+            values[i] = 16.0f + (state >> 8) * (4.0f / 16777216.0f) - 2.0f;
+            if (i % 104729 == 7919)
+                values[i] = 60.0f;
+        }
+        values[samples / 2 + 7] = 80.0f;
+
+        PlotLod series;
+        BenchTiming pushing = benchRun([&]() {
+            series.clear();
+            for (float value : values)
+                series.push(value);
+        }, 1, minSeconds);
+        printf("%9d pushed in %.2f ms (%.1f ns a sample), pyramid %.1f KB on %.1f KB of samples\n", samples,
+            pushing.medianMs, pushing.medianMs * 1e6 / samples, series.pyramidBytes() / 1024.0,
+            samples * sizeof(float) / 1024.0);
+        bool match = rangesMatch(series);
+        matches = matches && match;
+
+        json.beginResult();
+        json.field("samples", samples);
+        json.field("push_ms", pushing.medianMs);
+        json.field("pyramid_bytes", series.pyramidBytes());
+        json.field("ranges_match", match);
+
+        // the whole log, then a tenth of it panning one pixel column a frame
+        for (int zoomed = 0; zoomed < 2; zoomed++)
+        {
+            const char* view = zoomed ? "zoomed" : "full";
+            int count = zoomed ? samples / 10 : samples;
+            int step = std::max(1, (int)(count / g_Width));
+            int frame = 0;
+            auto viewFirst = [&]() { return zoomed ? (samples / 2 - count / 2 + (frame++ % 64) * step) : 0; };
+
+            PlotResult immediateResult = plotFrame(series, false, zoomed ? samples / 2 - count / 2 : 0, count);
+            BenchTiming immediate = benchRun([&]() { plotFrame(series, false, viewFirst(), count); }, minIterations,
+                minSeconds);
+            report(json, samples, view, "ImGui::PlotLines", immediate, immediate.medianMs, immediateResult);
+
+            frame = 0;
+            PlotResult lodResult = plotFrame(series, true, zoomed ? samples / 2 - count / 2 : 0, count);
+            BenchTiming lod = benchRun([&]() { plotFrame(series, true, viewFirst(), count); }, minIterations, minSeconds);
+            report(json, samples, view, "PlotLod", lod, immediate.medianMs, lodResult);
+        }
+    }
+    ImGui::DestroyContext();
+    printf("pyramid ranges match a scan: %s\n", matches ? "yes" : "NO");
+
+    if (!json.write(jsonPath))
+    {
+        printf("cannot write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    printf("results written to %s\n", jsonPath.c_str());
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+// Standalone benchmark for the TransformBatch kernels against per-object glm.
+//
+// Usage: transform-bench [--json <file>] [--count <n>] [--quick]
+//
+// For n objects with random position/rotation/scale: model matrices from
+// glm::translate/glm::rotate/glm::scale versus TransformBatch::compose,
+// projection * view * model with glm's operator* versus TransformBatch::multiply,
+// points and bounding boxes through a matrix, and the per-frame update of
+// spinning objects (an angle from the time through glm::rotate versus
+// quaternions advanced by TransformBatch::integrateRotations). Every
+// TransformBatch kernel runs once per SIMD path this CPU supports (scalar,
+// SSE2, AVX2, AVX-512; picked at run time). Reports nanoseconds per object
+// and the largest difference from the glm results.
+
+#include "transformbatch.h"
+#include "bench_common.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static void report(BenchJson& json, const char* kernel, const char* path, int count, const BenchTiming& timing,
+    double baselineMs, double maxError)
+{
+    double nsPerObject = timing.medianMs * 1e6 / count;
+    printf("%-22s %-28s %9.3f %9.2f %8.2fx %10.2e\n", kernel, path, timing.medianMs, nsPerObject,
+        baselineMs / timing.medianMs, maxError);
+
+    json.beginResult();
+    json.field("kernel", kernel);
+    json.field("path", path);
+    json.field("count", count);
+    json.field("iterations", timing.iterations);
+    json.field("median_ms", timing.medianMs);
+    json.field("min_ms", timing.minMs);
+    json.field("ns_per_object", nsPerObject);
+    json.field("speedup", baselineMs / timing.medianMs);
+    json.field("max_abs_error", maxError);
+}
+
+static double maxDifference(const float* a, const float* b, size_t count)
+{
+    double worst = 0.0;
+    for (size_t i = 0; i < count; i++)
+        worst = std::max(worst, (double)std::fabs(a[i] - b[i]));
+    return worst;
+}
+
+int main(int argc, char** argv)
+{
+    std::string jsonPath = "bench_transform.json";
+    int count = 10000;
+    bool quick = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) count = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--quick") == 0) quick = true;
+        else
+        {
+            printf("usage: %s [--json <file>] [--count <n>] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+    int minIterations = quick ? 2 : 5;
+    double minSeconds = quick ? 0.05 : 0.25;
+
+    // the sandbox's inputs: a position, an axis/angle in degrees and a scale per object
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> coordinate(-50.0f, 50.0f), unit(-1.0f, 1.0f), size(0.2f, 3.0f), degrees(0.0f, 360.0f);
+    std::vector<glm::vec3> positions(count), axes(count), scales(count), boxMin(count), boxMax(count);
+    std::vector<float> angles(count);
+    TransformArrays transforms;
+    transforms.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        positions[i] = glm::vec3(coordinate(random), coordinate(random), coordinate(random));
+        axes[i] = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.01f, 0.0f));
+        angles[i] = degrees(random);
+        scales[i] = glm::vec3(size(random), size(random), size(random));
+        boxMin[i] = -glm::vec3(size(random), size(random), size(random));
+        boxMax[i] = glm::vec3(size(random), size(random), size(random));
+        transforms.set(i, positions[i], glm::angleAxis(glm::radians(angles[i]), axes[i]), scales[i]);
+    }
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 500.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(3.0f, 8.0f, 30.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 viewProjection = projection * view;
+
+    // scalar up to the widest this CPU runs
+    std::vector<TransformBatch::SimdPath> paths;
+    for (int path = TransformBatch::SCALAR; path <= TransformBatch::supportedPath(); path++)
+        paths.push_back((TransformBatch::SimdPath)path);
+    auto pathLabel = [](const char* name, TransformBatch::SimdPath path) { return std::string(name) + " " + TransformBatch::pathName(path); };
+
+    printf("SIMD paths: scalar to %s, %d objects\n", TransformBatch::pathName(TransformBatch::supportedPath()), count);
+    printf("%-22s %-28s %9s %9s %9s %10s\n", "kernel", "path", "median ms", "ns/object", "speedup", "max error");
+    BenchJson json("transform");
+    const size_t floats = (size_t)count * 16;
+
+    // model matrices
+    std::vector<glm::mat4> models(count), batchModels(count);
+    BenchTiming glmCompose = benchRun([&]() {
+        for (int i = 0; i < count; i++)
+        {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), positions[i]);
+            model = glm::rotate(model, glm::radians(angles[i]), axes[i]);
+            models[i] = glm::scale(model, scales[i]);
+        }
+    }, minIterations, minSeconds);
+    report(json, "compose TRS", "glm translate/rotate/scale", count, glmCompose, glmCompose.medianMs, 0.0);
+    for (TransformBatch::SimdPath path : paths)
+    {
+        // compose() has no path wider than AVX2
+        if (path > TransformBatch::AVX2)
+            break;
+        TransformBatch::setMaxPath(path);
+        BenchTiming batchCompose = benchRun([&]() {
+            TransformBatch::compose(transforms, batchModels.data());
+        }, minIterations, minSeconds);
+        report(json, "compose TRS", pathLabel("TransformBatch", path).c_str(), count, batchCompose, glmCompose.medianMs,
+            maxDifference(&models[0][0][0], &batchModels[0][0][0], floats));
+    }
+
+    // projection * view * model
+    std::vector<glm::mat4> clip(count), batchClip(count);
+    BenchTiming glmMultiply = benchRun([&]() {
+        for (int i = 0; i < count; i++)
+            clip[i] = viewProjection * models[i];
+    }, minIterations, minSeconds);
+    report(json, "viewProjection * model", "glm operator*", count, glmMultiply, glmMultiply.medianMs, 0.0);
+    for (TransformBatch::SimdPath path : paths)
+    {
+        TransformBatch::setMaxPath(path);
+        BenchTiming batchMultiply = benchRun([&]() {
+            TransformBatch::multiply(viewProjection, models.data(), batchClip.data(), count);
+        }, minIterations, minSeconds);
+        report(json, "viewProjection * model", pathLabel("TransformBatch", path).c_str(), count, batchMultiply,
+            glmMultiply.medianMs, maxDifference(&clip[0][0][0], &batchClip[0][0][0], floats));
+    }
+
+    // points (the positions, moved by the view matrix)
+    std::vector<float> xs(count), ys(count), zs(count), glmOut((size_t)count * 3), batchOut((size_t)count * 3);
+    for (int i = 0; i < count; i++)
+    {
+        xs[i] = positions[i].x;
+        ys[i] = positions[i].y;
+        zs[i] = positions[i].z;
+    }
+    BenchTiming glmPoints = benchRun([&]() {
+        for (int i = 0; i < count; i++)
+        {
+            glm::vec4 p = view * glm::vec4(xs[i], ys[i], zs[i], 1.0f);
+            glmOut[i] = p.x;
+            glmOut[count + i] = p.y;
+            glmOut[2 * count + i] = p.z;
+        }
+    }, minIterations, minSeconds);
+    report(json, "transform points", "glm mat4 * vec4", count, glmPoints, glmPoints.medianMs, 0.0);
+    for (TransformBatch::SimdPath path : paths)
+    {
+        TransformBatch::setMaxPath(path);
+        BenchTiming batchPoints = benchRun([&]() {
+            TransformBatch::transformPoints(view, xs.data(), ys.data(), zs.data(), batchOut.data(), batchOut.data() + count,
+                batchOut.data() + 2 * count, count);
+        }, minIterations, minSeconds);
+        report(json, "transform points", pathLabel("TransformBatch", path).c_str(), count, batchPoints, glmPoints.medianMs,
+            maxDifference(glmOut.data(), batchOut.data(), glmOut.size()));
+    }
+
+    // bounding boxes, the way main.cpp used to do it: all eight corners
+    std::vector<glm::vec3> glmMin(count), glmMax(count), batchMin(count), batchMax(count);
+    BenchTiming glmBoxes = benchRun([&]() {
+        for (int i = 0; i < count; i++)
+        {
+            glm::vec3 low(1e30f), high(-1e30f);
+            for (int c = 0; c < 8; c++)
+            {
+                glm::vec3 corner((c & 1) ? boxMax[i].x : boxMin[i].x, (c & 2) ? boxMax[i].y : boxMin[i].y, (c & 4) ? boxMax[i].z : boxMin[i].z);
+                glm::vec3 world(models[i] * glm::vec4(corner, 1.0f));
+                low = glm::min(low, world);
+                high = glm::max(high, world);
+            }
+            glmMin[i] = low;
+            glmMax[i] = high;
+        }
+    }, minIterations, minSeconds);
+    report(json, "transform AABBs", "glm, eight corners", count, glmBoxes, glmBoxes.medianMs, 0.0);
+    for (TransformBatch::SimdPath path : paths)
+    {
+        // transformBoxes() has no path wider than SSE2
+        if (path > TransformBatch::SSE2)
+            break;
+        TransformBatch::setMaxPath(path);
+        BenchTiming batchBoxes = benchRun([&]() {
+            TransformBatch::transformBoxes(models.data(), boxMin.data(), boxMax.data(), batchMin.data(), batchMax.data(), count);
+        }, minIterations, minSeconds);
+        report(json, "transform AABBs", pathLabel("TransformBatch", path).c_str(), count, batchBoxes, glmBoxes.medianMs,
+            std::max(maxDifference(&glmMin[0].x, &batchMin[0].x, (size_t)count * 3),
+                maxDifference(&glmMax[0].x, &batchMax[0].x, (size_t)count * 3)));
+    }
+
+    // spinning objects: the old per-frame path builds each model from an angle
+    // (sin/cos per object); the new one steps quaternions and composes
+    const float frameTime = 1.0f / 60.0f, spinRate = glm::radians(12.5f);
+    std::vector<float> spinX(count), spinY(count), spinZ(count);
+    for (int i = 0; i < count; i++)
+    {
+        spinX[i] = axes[i].x * spinRate;
+        spinY[i] = axes[i].y * spinRate;
+        spinZ[i] = axes[i].z * spinRate;
+    }
+    float time = 0.0f;
+    BenchTiming glmSpin = benchRun([&]() {
+        time += frameTime;
+        for (int i = 0; i < count; i++)
+        {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), positions[i]);
+            model = glm::rotate(model, glm::radians(angles[i]) + spinRate * time, axes[i]);
+            models[i] = glm::scale(model, scales[i]);
+        }
+    }, minIterations, minSeconds);
+    report(json, "spin update", "glm rotate from time", count, glmSpin, glmSpin.medianMs, 0.0);
+
+    // accuracy: ten minutes of 60 Hz steps against the closed form
+    const int steps = 60 * 600;
+    std::vector<glm::mat4> closedForm(count);
+    for (int i = 0; i < count; i++)
+    {
+        float angle = std::fmod(glm::radians(angles[i]) + spinRate * frameTime * steps, glm::two_pi<float>());
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), positions[i]);
+        model = glm::rotate(model, angle, axes[i]);
+        closedForm[i] = glm::scale(model, scales[i]);
+    }
+    for (TransformBatch::SimdPath path : paths)
+    {
+        TransformBatch::setMaxPath(path);
+        TransformArrays spinning = transforms;
+        BenchTiming batchSpin = benchRun([&]() {
+            TransformBatch::integrateRotations(spinning, spinX.data(), spinY.data(), spinZ.data(), frameTime);
+            TransformBatch::compose(spinning, batchModels.data());
+        }, minIterations, minSeconds);
+
+        spinning = transforms;
+        for (int step = 0; step < steps; step++)
+            TransformBatch::integrateRotations(spinning, spinX.data(), spinY.data(), spinZ.data(), frameTime);
+        TransformBatch::compose(spinning, batchModels.data());
+        report(json, "spin update", pathLabel("integrate+compose", path).c_str(), count, batchSpin, glmSpin.medianMs,
+            maxDifference(&closedForm[0][0][0], &batchModels[0][0][0], floats));
+    }
+    if (!json.write(jsonPath))
+    {
+        printf("cannot write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    printf("results written to %s\n", jsonPath.c_str());
+    return 0;
+}
@@ -0,0 +1,234 @@
+#ifndef CASCADEDSHADOWS_H
+#define CASCADEDSHADOWS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "shadowcascades.h"
+#include "shader_m.h"
+
+#include <functional>
+#include <vector>
+
+// Something that can land in the shadow map. draw() sets "model" (and the
+// given view/projection) on the shader and returns the draw calls it issued.
+struct ShadowCaster
+{
+    glm::vec3 center;
+    float radius;
+    bool isStatic;    // doesn't move; kept in the cached cascades between frames
+    std::function<int(const Shader& shader, const glm::mat4& view, const glm::mat4& projection)> draw;
+};
+
+struct ShadowPassStats
+{
+    int draws = 0;              // draw calls this frame
+    int casters = 0;            // casters that passed the cascade's bounding test
+    bool staticRendered = false;
+    double gpuMs = 0.0;         // GPU time of the cascade, a couple of frames old
+};
+
+// GPU side of the directional light's cascaded shadow maps (layout in
+// ShadowCascades). Every cascade is one layer of a depth texture array that
+// shadows.glsl samples with hardware depth compare. Cached cascades keep their
+// static casters in a second array and only copy them over (plus whatever
+// dynamic casters touch them) each frame.
+class CascadedShadows
+{
+public:
+    static const int SHADOW_UNIT = 8;   // after the clustered lighting buffers
+
+    void init(int resolution = 2048)
+    {
+        m_Resolution = resolution;
+        glGenTextures(2, m_Maps);
+        for (int i = 0; i < 2; i++)
+        {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, m_Maps[i]);
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, resolution, resolution, ShadowCascades::MAX_CASCADES,
+                0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+            const float border[4] = { 1.0f, 1.0f, 1.0f, 1.0f }; // outside the map is lit
+            glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        glGenFramebuffers(2, m_Framebuffers);
+        for (int i = 0; i < 2; i++)
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffers[i]);
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glGenQueries(2 * ShadowCascades::MAX_CASCADES, &m_Queries[0][0]);
+    }
+
+    void destroy()
+    {
+        glDeleteQueries(2 * ShadowCascades::MAX_CASCADES, &m_Queries[0][0]);
+        glDeleteFramebuffers(2, m_Framebuffers);
+        glDeleteTextures(2, m_Maps);
+    }
+
+    // fit the cascades to the camera and render whatever changed; depthShader
+    // only has to transform positions (vertex.vert + shadow.frag)
+    void render(const ShadowSettings& settings, const glm::mat4& cameraView, float fovY, float aspect, float zNear,
+        const glm::vec3& sunDirection, uint64_t staticVersion, const std::vector<ShadowCaster>& casters, const Shader& depthShader)
+    {
+        m_Cascades.update(settings, m_Resolution, cameraView, fovY, aspect, zNear, sunDirection, staticVersion);
+        readTimings();
+
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glViewport(0, 0, m_Resolution, m_Resolution);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.0f, 4.0f);
+        depthShader.use();
+
+        int set = m_Frame & 1;
+        for (int i = 0; i < m_Cascades.count(); i++)
+        {
+            const ShadowCascade& cascade = m_Cascades.cascade(i);
+            ShadowPassStats& stats = m_Stats[i];
+            stats.draws = 0;
+            stats.casters = 0;
+            stats.staticRendered = false;
+
+            m_Visible.clear();
+            for (size_t c = 0; c < casters.size(); c++)
+            {
+                if (m_Cascades.touches(i, casters[c].center, casters[c].radius))
+                    m_Visible.push_back(c);
+            }
+            stats.casters = (int)m_Visible.size();
+
+            glBeginQuery(GL_TIME_ELAPSED, m_Queries[set][i]);
+            if (!cascade.cached)
+            {
+                attach(m_Framebuffers[0], LIVE, i);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                for (size_t c : m_Visible)
+                    stats.draws += casters[c].draw(depthShader, cascade.view, cascade.projection);
+                m_LiveIsStatic[i] = false;
+            }
+            else
+            {
+                if (cascade.staticDirty)
+                {
+                    attach(m_Framebuffers[0], STATIC, i);
+                    glClear(GL_DEPTH_BUFFER_BIT);
+                    for (size_t c : m_Visible)
+                    {
+                        if (casters[c].isStatic)
+                            stats.draws += casters[c].draw(depthShader, cascade.view, cascade.projection);
+                    }
+                    stats.staticRendered = true;
+                }
+
+                bool dynamic = false;
+                for (size_t c : m_Visible)
+                    dynamic |= !casters[c].isStatic;
+                // the live layer is a copy of the static one plus this frame's dynamic casters
+                if (dynamic || cascade.staticDirty || !m_LiveIsStatic[i])
+                {
+                    attach(m_Framebuffers[1], STATIC, i);
+                    attach(m_Framebuffers[0], LIVE, i);
+                    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_Framebuffers[1]);
+                    glBlitFramebuffer(0, 0, m_Resolution, m_Resolution, 0, 0, m_Resolution, m_Resolution, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+                    for (size_t c : m_Visible)
+                    {
+                        if (!casters[c].isStatic)
+                            stats.draws += casters[c].draw(depthShader, cascade.view, cascade.projection);
+                    }
+                    m_LiveIsStatic[i] = !dynamic;
+                }
+            }
+            glEndQuery(GL_TIME_ELAPSED);
+            m_Pending[set][i] = true;
+        }
+        m_Frame++;
+
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+
+    // sun and shadow uniforms for lighting.glsl; call after shader.use()
+    void bind(const Shader& shader, const glm::vec3& sunDirection, const glm::vec3& sunColor) const
+    {
+        glActiveTexture(GL_TEXTURE0 + SHADOW_UNIT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_Maps[LIVE]);
+        glActiveTexture(GL_TEXTURE0);
+
+        // clip space [-1, 1] to texture space [0, 1]
+        const glm::mat4 bias(0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.5f, 0.5f, 0.5f, 1.0f);
+        glm::mat4 matrices[ShadowCascades::MAX_CASCADES];
+        glm::vec4 splits(0.0f), texelSizes(0.0f);
+        for (int i = 0; i < m_Cascades.count(); i++)
+        {
+            const ShadowCascade& cascade = m_Cascades.cascade(i);
+            matrices[i] = bias * cascade.projection * cascade.view;
+            splits[i] = cascade.splitFar;
+            texelSizes[i] = cascade.texelSize;
+        }
+
+        shader.setInt("shadowMap", SHADOW_UNIT);
+        glUniformMatrix4fv(glGetUniformLocation(shader.ID, "shadowMatrices"), ShadowCascades::MAX_CASCADES, GL_FALSE, &matrices[0][0][0]);
+        shader.setVec4("cascadeSplits", splits);
+        shader.setVec4("cascadeTexelSize", texelSizes);
+        shader.setInt("cascadeCount", m_Cascades.count());
+        shader.setVec3("sunDirection", sunDirection);
+        shader.setVec3("sunColor", sunColor);
+    }
+
+    const ShadowCascades& cascades() const { return m_Cascades; }
+    const ShadowPassStats& stats(int cascade) const { return m_Stats[cascade]; }
+
+private:
+    enum { LIVE = 0, STATIC = 1 };
+
+    ShadowCascades m_Cascades;
+    int m_Resolution = 0;
+    unsigned int m_Maps[2] = { 0, 0 };
+    unsigned int m_Framebuffers[2] = { 0, 0 };
+    // timer queries alternate between two sets so results are read a frame late without stalling
+    unsigned int m_Queries[2][ShadowCascades::MAX_CASCADES] = {};
+    bool m_Pending[2][ShadowCascades::MAX_CASCADES] = {};
+    unsigned int m_Frame = 0;
+    bool m_LiveIsStatic[ShadowCascades::MAX_CASCADES] = {};
+    ShadowPassStats m_Stats[ShadowCascades::MAX_CASCADES];
+    std::vector<size_t> m_Visible;
+
+    void attach(unsigned int framebuffer, int map, int layer)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_Maps[map], 0, layer);
+    }
+
+    void readTimings()
+    {
+        int set = m_Frame & 1;
+        for (int i = 0; i < ShadowCascades::MAX_CASCADES; i++)
+        {
+            if (!m_Pending[set][i])
+                continue;
+            GLint available = 0;
+            glGetQueryObjectiv(m_Queries[set][i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                continue; // a later frame picks it up, or it is overwritten
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(m_Queries[set][i], GL_QUERY_RESULT, &elapsed);
+            m_Stats[i].gpuMs = elapsed / 1000000.0;
+            m_Pending[set][i] = false;
+        }
+    }
+};
+
+// CASCADEDSHADOWS_H
+#endif
@@ -0,0 +1,123 @@
+#ifndef CLUSTEREDLIGHTING_H
+#define CLUSTEREDLIGHTING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "affine.h"
+#include "lightclusters.h"
+#include "shader_m.h"
+
+#include <cstring>
+#include <vector>
+
+// GPU side of clustered forward lighting. Every frame the lights are binned on
+// the CPU (LightClusterGrid) and the result is uploaded into three texture
+// buffers that lighting.glsl reads:
+//   lightData       RGBA32F  two texels per light: position.xyz + radius, color * intensity
+//   clusterData     RG32UI   per cluster: first entry in lightIndexData, light count
+//   lightIndexData  R32UI    light indices, grouped by cluster
+// The buffers are orphaned before each upload so the driver never has to wait
+// for last frame's draws to finish reading them.
+class ClusteredLighting
+{
+public:
+    // texture units used by the lighting samplers (0-4 are the material textures)
+    static const int LIGHT_UNIT = 5;
+    static const int CLUSTER_UNIT = 6;
+    static const int INDEX_UNIT = 7;
+
+    void init()
+    {
+        glGenBuffers(3, m_Buffers);
+        glGenTextures(3, m_Textures);
+        const GLenum formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R32UI };
+        for (int i = 0; i < 3; i++)
+        {
+            // texture buffers need storage before they are sampled
+            glBindBuffer(GL_TEXTURE_BUFFER, m_Buffers[i]);
+            glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, m_Textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], m_Buffers[i]);
+        }
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void destroy()
+    {
+        glDeleteTextures(3, m_Textures);
+        glDeleteBuffers(3, m_Buffers);
+    }
+
+    // bin the lights for this camera and upload the result
+    void update(const glm::mat4& view, const glm::mat4& projection, float zNear, float zFar, const std::vector<PointLight>& lights)
+    {
+        m_Grid.build(view, projection, zNear, zFar, lights);
+        m_ViewPos = Affine(view).inverse().translation();
+
+        // light data only changes when the lights themselves do
+        m_Texels.resize(lights.size() * 2);
+        for (size_t i = 0; i < lights.size(); i++)
+        {
+            m_Texels[i * 2 + 0] = glm::vec4(lights[i].position, lights[i].radius);
+            m_Texels[i * 2 + 1] = glm::vec4(lights[i].color * lights[i].intensity, 0.0f);
+        }
+        if (m_Texels.size() != m_UploadedTexels.size()
+            || (!m_Texels.empty() && memcmp(m_Texels.data(), m_UploadedTexels.data(), m_Texels.size() * sizeof(glm::vec4)) != 0))
+        {
+            upload(m_Buffers[0], m_Texels.data(), m_Texels.size() * sizeof(glm::vec4));
+            m_UploadedTexels = m_Texels;
+        }
+
+        const std::vector<uint32_t>& ranges = m_Grid.clusterRanges();
+        const std::vector<uint32_t>& indices = m_Grid.lightIndices();
+        upload(m_Buffers[1], ranges.data(), ranges.size() * sizeof(uint32_t));
+        upload(m_Buffers[2], indices.data(), indices.size() * sizeof(uint32_t));
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // point the shader's lighting uniforms at this frame's clusters; call after shader.use()
+    void bind(const Shader& shader, const glm::vec3& ambient, int viewportWidth, int viewportHeight) const
+    {
+        const int units[3] = { LIGHT_UNIT, CLUSTER_UNIT, INDEX_UNIT };
+        for (int i = 0; i < 3; i++)
+        {
+            glActiveTexture(GL_TEXTURE0 + units[i]);
+            glBindTexture(GL_TEXTURE_BUFFER, m_Textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0); // the material textures are bound to unit 0 without selecting it
+
+        shader.setInt("lightData", LIGHT_UNIT);
+        shader.setInt("clusterData", CLUSTER_UNIT);
+        shader.setInt("lightIndexData", INDEX_UNIT);
+        glUniform3i(glGetUniformLocation(shader.ID, "clusterGrid"), m_Grid.tilesX(), m_Grid.tilesY(), m_Grid.slices());
+        shader.setVec2("clusterDepth", m_Grid.sliceScale(), m_Grid.sliceBias());
+        shader.setVec2("viewportSize", (float)viewportWidth, (float)viewportHeight);
+        shader.setVec3("viewPos", m_ViewPos);
+        shader.setVec3("ambientLight", ambient);
+    }
+
+    const LightClusterGrid& grid() const { return m_Grid; }
+
+private:
+    LightClusterGrid m_Grid;
+    unsigned int m_Buffers[3] = { 0, 0, 0 };
+    unsigned int m_Textures[3] = { 0, 0, 0 };
+    glm::vec3 m_ViewPos = glm::vec3(0.0f);
+    std::vector<glm::vec4> m_Texels;
+    std::vector<glm::vec4> m_UploadedTexels;
+
+    static void upload(unsigned int buffer, const void* data, size_t size)
+    {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        // never allocate zero bytes; out-of-range fetches just read zeros
+        size_t storage = size > 16 ? size : 16;
+        glBufferData(GL_TEXTURE_BUFFER, storage, nullptr, GL_STREAM_DRAW);
+        if (size > 0)
+            glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+    }
+};
+
+// CLUSTEREDLIGHTING_H
+#endif
@@ -0,0 +1,110 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPUFEATURES_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// MSVC compiles any intrinsic in any function, whatever /arch says; GCC and
+// Clang only in functions marked with the instruction set they use. Code
+// built this way must only run when CpuFeatures says the CPU has it.
+//
+// A template shared by several paths cannot carry their targets, so it is
+// CPU_FORCE_INLINE instead: inlined into each targeted caller, it is built
+// for that caller's instruction set and never passes wide vectors through a
+// function built for another (whose calling convention differs).
+//
+// AVX-512F brings FMA along, and GCC would fuse the intrinsics' multiplies
+// and adds into it, rounding differently from the narrower paths.
+#if defined(CPUFEATURES_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CPU_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define CPU_TARGET_AVX2 __attribute__((target("avx2")))
+#if defined(__clang__)
+#define CPU_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define CPU_TARGET_AVX512 __attribute__((target("avx512f"), optimize("fp-contract=off")))
+#endif
+#define CPU_FORCE_INLINE inline __attribute__((always_inline))
+#else
+#define CPU_TARGET_SSE41
+#define CPU_TARGET_AVX2
+#define CPU_TARGET_AVX512
+#define CPU_FORCE_INLINE inline
+#endif
+
+// The instruction sets the CPU and the OS support, read once with cpuid, so
+// the wide SIMD paths can be picked at run time instead of with /arch.
+struct CpuFeatures
+{
+    bool sse41 = false;
+    bool avx2 = false;
+    bool avx512 = false;    // AVX-512F
+
+    static const CpuFeatures& get()
+    {
+        static const CpuFeatures features = detect();
+        return features;
+    }
+
+private:
+    static CpuFeatures detect()
+    {
+        CpuFeatures features;
+#ifdef CPUFEATURES_X86
+        unsigned int info[4];
+        cpuid(0, info);
+        unsigned int maxLeaf = info[0];
+        if (maxLeaf < 1)
+            return features;
+        cpuid(1, info);
+        features.sse41 = (info[2] & (1u << 19)) != 0;
+        // the OS has to save the wide registers on a context switch too
+        if (maxLeaf < 7 || !(info[2] & (1u << 27)))   // OSXSAVE
+            return features;
+        uint64_t xcr0 = xgetbv();
+        bool ymm = (xcr0 & 0x6) == 0x6;     // SSE and AVX state
+        bool zmm = (xcr0 & 0xE6) == 0xE6;   // plus the opmask and upper ZMM state
+        cpuid(7, info);
+        features.avx2 = ymm && (info[1] & (1u << 5));
+        features.avx512 = zmm && (info[1] & (1u << 16));
+#endif
+        return features;
+    }
+
+#ifdef CPUFEATURES_X86
+    // eax, ebx, ecx, edx of leaf `leaf`, subleaf 0
+    static void cpuid(unsigned int leaf, unsigned int info[4])
+    {
+#if defined(_MSC_VER)
+        int registers[4];
+        __cpuidex(registers, (int)leaf, 0);
+        for (int i = 0; i < 4; i++)
+            info[i] = (unsigned int)registers[i];
+#else
+        __cpuid_count(leaf, 0, info[0], info[1], info[2], info[3]);
+#endif
+    }
+
+    static uint64_t xgetbv()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned int eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return ((uint64_t)edx << 32) | eax;
+#endif
+    }
+#endif
+};
+
+// CPUFEATURES_H
+#endif
@@ -46,8 +46,7 @@ public:
         // Optional: Set default transforms for the shape
         scale = glm::vec3(1.0f);
         position = glm::vec3(0.0f);
-        rotationAxis = glm::vec3(0.0f, 1.0f, 0.0f);
-        rotationAngle = 0.0f;
+        rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
     }
 
     virtual ~Cube()
@@ -86,10 +85,7 @@ public:
         glUseProgram(shaderID);
 
         // Create model matrix from our position/rotation/scale
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, position);
-        model = glm::rotate(model, glm::radians(rotationAngle), rotationAxis);
-        model = glm::scale(model, scale);
+        glm::mat4 model = modelMatrix();
 
         // Pass uniforms to the shader
         unsigned int locModel = glGetUniformLocation(shaderID, "model");
@@ -105,5 +101,16 @@ public:
         glDrawArrays(GL_TRIANGLES, 0, 36);
         glBindVertexArray(0);
     }
+
+    // Non-indexed triangles, so the index list just counts up
+    virtual void getMesh(std::vector<float>& meshVertices, std::vector<unsigned int>& indices) const override
+    {
+        meshVertices.assign(std::begin(vertices), std::end(vertices));
+        indices.resize(meshVertices.size() / 3);
+        for (size_t i = 0; i < indices.size(); i++)
+            indices[i] = (unsigned int)i;
+    }
+
+    virtual std::string meshKey() const override { return "cube"; }
 };
 
@@ -0,0 +1,35 @@
+#pragma once
+// Buffers shared by the GPU culling pass (cull.comp) and the indirect draw
+// (indirect.vert); the layouts match the structs in gpuculling.h.
+
+// the model matrix's top three rows (Affine); its bottom row is 0, 0, 0, 1
+struct CullObject
+{
+    vec4 modelRows[3];
+    uint mesh;
+    uint occluded;
+    uint pad1;
+    uint pad2;
+};
+
+struct CullMesh
+{
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    float radius;       // object-space bounding sphere around the origin
+};
+
+struct DrawElementsIndirectCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout(std430, binding = 0) readonly buffer CullObjects
+{
+    CullObject objects[];
+};
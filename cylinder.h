@@ -21,8 +21,7 @@ public:
         // Default transform
         scale = glm::vec3(1.0f);
         position = glm::vec3(0.0f);
-        rotationAxis = glm::vec3(0.0f, 1.0f, 0.0f);
-        rotationAngle = 0.0f;
+        rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
     }
 
     virtual ~Cylinder()
@@ -73,11 +72,7 @@ public:
         glUseProgram(shaderID);
 
         // Build the model matrix from transforms
-        glm::mat4 model(1.0f);
-        model = glm::translate(model, position);
-        if (rotationAngle != 0.0f)
-            model = glm::rotate(model, glm::radians(rotationAngle), rotationAxis);
-        model = glm::scale(model, scale);
+        glm::mat4 model = modelMatrix();
 
         // Pass matrices to the shader
         GLint locModel = glGetUniformLocation(shaderID, "model");
@@ -93,6 +88,18 @@ public:
         glBindVertexArray(0);
     }
 
+    // Generated in init()
+    virtual void getMesh(std::vector<float>& vertices, std::vector<unsigned int>& indices) const override
+    {
+        vertices = m_Vertices;
+        indices = m_Indices;
+    }
+
+    virtual std::string meshKey() const override
+    {
+        return "cylinder " + std::to_string(m_Slices) + " " + std::to_string(m_Radius) + " " + std::to_string(m_Height);
+    }
+
 private:
     // User-defined parameters
     int   m_Slices;       // how many subdivisions around the circle
@@ -41,6 +41,44 @@ IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyFontsTexture();
 IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_CreateDeviceObjects();
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyDeviceObjects();
 
+// (Optional) Single-upload mode, off by default (desktop GL 3.2+, otherwise ignored): each frame, all draw lists are copied
+// into one streaming vertex buffer and one index buffer, each mapped once with glMapBufferRange(), and drawn with
+// glDrawElementsBaseVertex() offsets, instead of two glBufferData() calls per draw list. ImDrawCmd callbacks work as before.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetSingleUpload(bool enable);
+// (Optional) About the last ImGui_ImplOpenGL3_RenderDrawData(): draw lists, buffer upload/map calls, bytes uploaded.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_GetUploadStats(int* out_draw_lists, int* out_upload_calls, int* out_upload_bytes);
+
+// (Optional) Trusted state, none by default: RenderDrawData() neither queries nor restores the GL state in these groups.
+// Declare only state your application sets again itself before it next depends on it; the backend leaves its own values
+// behind (its program, texture on unit 0, buffers, full viewport, blending on, scissor test on, depth test and culling off).
+enum ImGui_ImplOpenGL3_TrustedState_
+{
+    ImGui_ImplOpenGL3_TrustedState_None         = 0,
+    ImGui_ImplOpenGL3_TrustedState_Program      = 1 << 0,   // Current program
+    ImGui_ImplOpenGL3_TrustedState_Textures     = 1 << 1,   // Active texture unit, 2D texture and sampler of unit 0
+    ImGui_ImplOpenGL3_TrustedState_Buffers      = 1 << 2,   // Vertex array object and array buffer (ES2: element buffer and attributes)
+    ImGui_ImplOpenGL3_TrustedState_Viewport     = 1 << 3,   // Viewport and scissor box
+    ImGui_ImplOpenGL3_TrustedState_Blend        = 1 << 4,   // Blend equations and functions
+    ImGui_ImplOpenGL3_TrustedState_Capabilities = 1 << 5,   // Blend/cull/depth/stencil/scissor/primitive restart enables, polygon mode
+    ImGui_ImplOpenGL3_TrustedState_All          = (1 << 6) - 1,
+};
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetTrustedState(int trusted_state_flags);
+// (Optional) glGetIntegerv()/glIsEnabled()/glIsProgram() calls made by the last RenderDrawData(), counted in our loader
+// (-1 when built with IMGUI_IMPL_OPENGL_LOADER_CUSTOM or for ES, where the calls don't go through it).
+IMGUI_IMPL_API int      ImGui_ImplOpenGL3_GetStateQueryCount();
+
+// (Optional) Alpha8 font texture, off by default (GL 3.3+/ES 3.0+, otherwise ignored): the atlas is uploaded as a single
+// GL_R8 channel with a (1, 1, 1, R) texture swizzle instead of RGBA32, a quarter of the memory. Changing it destroys the
+// font texture, which the next NewFrame() uploads again. GetFontTextureBytes() returns the texel bytes of the upload.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetFontTextureAlpha8(bool enable);
+IMGUI_IMPL_API int      ImGui_ImplOpenGL3_GetFontTextureBytes();
+
+// (Optional) Signed distance field font atlas (GL 3.3+/ES 3.0+ with a GLSL 1.30+ shader, otherwise refused): a built atlas
+// whose Alpha8 texels are distances to the glyph outlines, 128 on them. The next NewFrame() uploads it as its own GL_R8
+// texture and sets its TexID; draw commands using that texture are drawn with distance-field sampling, so its fonts stay
+// crisp at any scale. nullptr removes it. Returns false when not supported.
+IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_SetSdfFontAtlas(ImFontAtlas* atlas);
+
 // Configuration flags to add in your imconfig file:
 //#define IMGUI_IMPL_OPENGL_ES2     // Enable ES 2 (Auto-detected on Emscripten)
 //#define IMGUI_IMPL_OPENGL_ES3     // Enable ES 3 (Auto-detected on iOS/Android)
@@ -0,0 +1,142 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <chrono>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+// Reports which of a set of files changed since the last poll(), without blocking.
+// Linux uses inotify on the containing directories (editors often save by
+// writing a temp file and renaming it over the original); elsewhere the
+// modification times are compared at most every POLL_INTERVAL_MS.
+class FileWatcher
+{
+public:
+    FileWatcher()
+    {
+#ifdef __linux__
+        m_Fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    }
+    ~FileWatcher()
+    {
+#ifdef __linux__
+        if (m_Fd >= 0)
+            ::close(m_Fd);
+#endif
+    }
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // `path` is what gets reported back by poll()
+    void watch(const std::string& path)
+    {
+        for (const Entry& entry : m_Entries)
+            if (entry.path == path)
+                return;
+
+        Entry entry;
+        entry.path = path;
+        size_t slash = path.find_last_of("/\\");
+        entry.directory = slash == std::string::npos ? "." : path.substr(0, slash);
+        entry.name = slash == std::string::npos ? path : path.substr(slash + 1);
+#ifdef __linux__
+        if (m_Fd >= 0)
+            entry.wd = inotify_add_watch(m_Fd, entry.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+#else
+        entry.mtime = modificationTime(path);
+#endif
+        m_Entries.push_back(entry);
+    }
+
+    // appends each changed path once to `changed`; returns true if anything changed
+    bool poll(std::vector<std::string>& changed)
+    {
+        size_t before = changed.size();
+#ifdef __linux__
+        if (m_Fd < 0)
+            return false;
+        alignas(inotify_event) char buffer[4096];
+        for (;;)
+        {
+            ssize_t length = read(m_Fd, buffer, sizeof(buffer));
+            if (length <= 0)
+                break; // EAGAIN: nothing more queued
+            for (char* p = buffer; p < buffer + length;)
+            {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                p += sizeof(inotify_event) + event->len;
+                if (event->len == 0)
+                    continue;
+                for (const Entry& entry : m_Entries)
+                    if (entry.wd == event->wd && entry.name == event->name)
+                        addOnce(changed, before, entry.path);
+            }
+        }
+#else
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now - m_LastPoll < std::chrono::milliseconds(POLL_INTERVAL_MS))
+            return false;
+        m_LastPoll = now;
+        for (Entry& entry : m_Entries)
+        {
+            long long mtime = modificationTime(entry.path);
+            if (mtime != entry.mtime)
+            {
+                entry.mtime = mtime;
+                addOnce(changed, before, entry.path);
+            }
+        }
+#endif
+        return changed.size() > before;
+    }
+
+private:
+    struct Entry
+    {
+        std::string path;
+        std::string directory;
+        std::string name;
+#ifdef __linux__
+        int wd = -1;
+#else
+        long long mtime = 0;
+#endif
+    };
+
+    std::vector<Entry> m_Entries;
+#ifdef __linux__
+    int m_Fd = -1;
+#else
+    static const int POLL_INTERVAL_MS = 250;
+    std::chrono::steady_clock::time_point m_LastPoll;
+
+    static long long modificationTime(const std::string& path)
+    {
+        struct stat info;
+        return stat(path.c_str(), &info) == 0 ? (long long)info.st_mtime : 0;
+    }
+#endif
+
+    static void addOnce(std::vector<std::string>& changed, size_t from, const std::string& path)
+    {
+        for (size_t i = from; i < changed.size(); i++)
+            if (changed[i] == path)
+                return;
+        changed.push_back(path);
+    }
+};
+
+// FILEWATCHER_H
+#endif
@@ -0,0 +1,417 @@
+#ifndef FONTATLASCACHE_H
+#define FONTATLASCACHE_H
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include "assetpack.h"
+#include "filesystem.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// What the last FontAtlasCache::build() did
+struct FontAtlasCacheStats
+{
+    bool hit = false;
+    double keyMs = 0.0;     // hashing the font files and configuration
+    double loadMs = 0.0;    // reading and restoring a cached atlas
+    double buildMs = 0.0;   // rasterizing and packing on a miss
+    double storeMs = 0.0;
+    size_t fileBytes = 0;
+    int glyphs = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Cache file layout: FontAtlasCacheHeader, the atlas UVs, customRectCount
+// FontAtlasCacheRect, per font a FontAtlasCacheFont and its glyphs, then the
+// width * height Alpha8 pixels
+const uint32_t FONT_ATLAS_CACHE_MAGIC = 0x53544146; // "FATS"
+const uint32_t FONT_ATLAS_CACHE_VERSION = 1;
+const char* const FONT_ATLAS_CACHE_DIR = "fontcache";
+
+struct FontAtlasCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    int32_t width;
+    int32_t height;
+    int32_t fontCount;
+    int32_t customRectCount;
+    int32_t packIdMouseCursors;
+    int32_t packIdLines;
+};
+
+struct FontAtlasCacheRect
+{
+    uint16_t width, height, x, y;
+    uint32_t glyphId;
+    float glyphAdvanceX;
+    float glyphOffsetX, glyphOffsetY;
+    int32_t font;   // index in atlas->Fonts, -1 for none
+};
+
+struct FontAtlasCacheFont
+{
+    float fontSize;
+    float ascent;
+    float descent;
+    int32_t metricsTotalSurface;
+    int32_t glyphCount;
+};
+
+// On-disk cache of a baked ImFontAtlas (the Alpha8 pixels, every font's
+// glyphs and metrics, the custom rects), keyed by the FNV-1a hash of the font
+// files and everything in the atlas and font configs that changes the result.
+// A hit restores the atlas without rasterizing or packing a single glyph,
+// which is what startup spends its time on with large (CJK) glyph ranges.
+// Add the fonts first, then call build() instead of letting the backend build
+// the atlas. Anything unexpected in a file is a miss.
+class FontAtlasCache
+{
+public:
+    // fills an atlas with fonts added but not built, from the cache or with
+    // Build() (storing the result); false when Build() failed
+    static bool build(ImFontAtlas* atlas)
+    {
+        FontAtlasCacheStats& s = stats();
+        s = FontAtlasCacheStats();
+        if (atlas->ConfigData.Size == 0)
+            atlas->AddFontDefault();
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        uint64_t cacheKey = key(atlas);
+        s.keyMs = elapsedMs(start);
+        std::string path = pathFor(cacheKey);
+
+        start = std::chrono::steady_clock::now();
+        s.hit = load(atlas, cacheKey, path);
+        if (s.hit)
+        {
+            s.loadMs = elapsedMs(start);
+        }
+        else
+        {
+            start = std::chrono::steady_clock::now();
+            if (!atlas->Build())
+                return false;
+            s.buildMs = elapsedMs(start);
+
+            start = std::chrono::steady_clock::now();
+            makeDirectory(FileSystem::getPath(FONT_ATLAS_CACHE_DIR));
+            store(atlas, cacheKey, path);
+            s.storeMs = elapsedMs(start);
+        }
+
+        s.width = atlas->TexWidth;
+        s.height = atlas->TexHeight;
+        for (const ImFont* font : atlas->Fonts)
+            s.glyphs += font->Glyphs.Size;
+        return true;
+    }
+
+    static uint64_t key(ImFontAtlas* atlas)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        int version = IMGUI_VERSION_NUM;
+        hash = combine(hash, &version, sizeof(version));
+        int sizes[3] = { (int)sizeof(ImFontGlyph), (int)sizeof(ImWchar), atlas->Fonts.Size };
+        hash = combine(hash, sizes, sizeof(sizes));
+        int atlasSettings[4] = { atlas->Flags, atlas->TexDesiredWidth, atlas->TexGlyphPadding, (int)atlas->FontBuilderFlags };
+        hash = combine(hash, atlasSettings, sizeof(atlasSettings));
+        bool customBuilder = atlas->FontBuilderIO != nullptr;
+        hash = combine(hash, &customBuilder, sizeof(customBuilder));
+
+        for (const ImFontConfig& cfg : atlas->ConfigData)
+        {
+            hash = combine(hash, cfg.FontData, (size_t)cfg.FontDataSize);
+            int ints[6] = { cfg.FontNo, cfg.OversampleH, cfg.OversampleV, (int)cfg.FontBuilderFlags, (int)cfg.EllipsisChar,
+                fontIndex(atlas, cfg.DstFont) };
+            hash = combine(hash, ints, sizeof(ints));
+            float floats[9] = { cfg.SizePixels, cfg.GlyphExtraSpacing.x, cfg.GlyphExtraSpacing.y, cfg.GlyphOffset.x,
+                cfg.GlyphOffset.y, cfg.GlyphMinAdvanceX, cfg.GlyphMaxAdvanceX, cfg.RasterizerMultiply, cfg.RasterizerDensity };
+            hash = combine(hash, floats, sizeof(floats));
+            bool flags[2] = { cfg.PixelSnapH, cfg.MergeMode };
+            hash = combine(hash, flags, sizeof(flags));
+            const ImWchar* ranges = cfg.GlyphRanges ? cfg.GlyphRanges : atlas->GetGlyphRangesDefault();
+            size_t rangeCount = 0;
+            while (ranges[rangeCount] != 0)
+                rangeCount++;
+            hash = combine(hash, ranges, rangeCount * sizeof(ImWchar));
+        }
+        for (const ImFontAtlasCustomRect& rect : atlas->CustomRects)
+        {
+            FontAtlasCacheRect r = toCacheRect(atlas, rect);
+            r.x = r.y = 0;  // outputs of the build
+            hash = combine(hash, &r, sizeof(r));
+        }
+        return hash;
+    }
+
+    // restores a cached atlas into `atlas` (fonts added, not built); false on a miss
+    static bool load(ImFontAtlas* atlas, uint64_t cacheKey, const std::string& path)
+    {
+        std::vector<char> file;
+        if (!AssetPack::readWholeFile(path, file) || file.size() < sizeof(FontAtlasCacheHeader))
+            return false;
+
+        FontAtlasCacheHeader header;
+        memcpy(&header, file.data(), sizeof(header));
+        if (header.magic != FONT_ATLAS_CACHE_MAGIC || header.version != FONT_ATLAS_CACHE_VERSION || header.key != cacheKey
+            || header.fontCount != atlas->Fonts.Size || header.width <= 0 || header.height <= 0 || header.customRectCount < 0)
+            return false;
+
+        // read everything before touching the atlas
+        Reader in(file, sizeof(header));
+        ImVec2 uvScale, uvWhitePixel;
+        ImVec4 uvLines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+        in.read(&uvScale, sizeof(uvScale));
+        in.read(&uvWhitePixel, sizeof(uvWhitePixel));
+        in.read(uvLines, sizeof(uvLines));
+        std::vector<FontAtlasCacheRect> rects(header.customRectCount);
+        in.read(rects.data(), rects.size() * sizeof(FontAtlasCacheRect));
+        std::vector<FontAtlasCacheFont> fonts(header.fontCount);
+        std::vector<const char*> glyphs(header.fontCount);
+        for (int i = 0; i < header.fontCount && in.ok; i++)
+        {
+            in.read(&fonts[i], sizeof(FontAtlasCacheFont));
+            glyphs[i] = in.skip(fonts[i].glyphCount >= 0 ? (size_t)fonts[i].glyphCount * sizeof(ImFontGlyph) : file.size());
+        }
+        size_t pixelBytes = (size_t)header.width * (size_t)header.height;
+        const char* pixels = in.skip(pixelBytes);
+        if (!in.ok || in.offset != file.size())
+            return false;
+        for (const FontAtlasCacheRect& r : rects)
+            if (r.font < -1 || r.font >= header.fontCount)
+                return false;
+
+        // what Build() does, with the results read back instead of computed
+        ImFontAtlasBuildInit(atlas);    // rounds the font sizes, registers the default custom rects
+        atlas->TexID = (ImTextureID)NULL;
+        atlas->ClearTexData();
+        atlas->TexWidth = header.width;
+        atlas->TexHeight = header.height;
+        atlas->TexUvScale = uvScale;
+        atlas->TexUvWhitePixel = uvWhitePixel;
+        memcpy(atlas->TexUvLines, uvLines, sizeof(uvLines));
+        atlas->PackIdMouseCursors = header.packIdMouseCursors;
+        atlas->PackIdLines = header.packIdLines;
+        atlas->CustomRects.resize(header.customRectCount);
+        for (int i = 0; i < header.customRectCount; i++)
+        {
+            const FontAtlasCacheRect& r = rects[i];
+            ImFontAtlasCustomRect& rect = atlas->CustomRects[i];
+            rect.Width = r.width;
+            rect.Height = r.height;
+            rect.X = r.x;
+            rect.Y = r.y;
+            rect.GlyphID = r.glyphId;
+            rect.GlyphAdvanceX = r.glyphAdvanceX;
+            rect.GlyphOffset = ImVec2(r.glyphOffsetX, r.glyphOffsetY);
+            rect.Font = r.font >= 0 ? atlas->Fonts[r.font] : nullptr;
+        }
+        atlas->TexPixelsAlpha8 = (unsigned char*)IM_ALLOC(pixelBytes);
+        memcpy(atlas->TexPixelsAlpha8, pixels, pixelBytes);
+
+        for (int i = 0; i < header.fontCount; i++)
+        {
+            ImFont* font = atlas->Fonts[i];
+            font->ClearOutputData();
+            font->FontSize = fonts[i].fontSize;
+            font->ContainerAtlas = atlas;
+            font->Ascent = fonts[i].ascent;
+            font->Descent = fonts[i].descent;
+            font->MetricsTotalSurface = fonts[i].metricsTotalSurface;
+            font->Glyphs.resize(fonts[i].glyphCount);
+            memcpy(font->Glyphs.Data, glyphs[i], (size_t)fonts[i].glyphCount * sizeof(ImFontGlyph));
+            font->BuildLookupTable();
+        }
+        atlas->TexReady = true;
+
+        stats().fileBytes = file.size();
+        return true;
+    }
+
+    // writes a built atlas; false when it has no Alpha8 pixels or cannot be written
+    static bool store(const ImFontAtlas* atlas, uint64_t cacheKey, const std::string& path)
+    {
+        if (!atlas->TexPixelsAlpha8 || !atlas->TexReady)
+            return false;
+
+        FontAtlasCacheHeader header;
+        header.magic = FONT_ATLAS_CACHE_MAGIC;
+        header.version = FONT_ATLAS_CACHE_VERSION;
+        header.key = cacheKey;
+        header.width = atlas->TexWidth;
+        header.height = atlas->TexHeight;
+        header.fontCount = atlas->Fonts.Size;
+        header.customRectCount = atlas->CustomRects.Size;
+        header.packIdMouseCursors = atlas->PackIdMouseCursors;
+        header.packIdLines = atlas->PackIdLines;
+
+        std::vector<char> out;
+        append(out, &header, sizeof(header));
+        append(out, &atlas->TexUvScale, sizeof(atlas->TexUvScale));
+        append(out, &atlas->TexUvWhitePixel, sizeof(atlas->TexUvWhitePixel));
+        append(out, atlas->TexUvLines, sizeof(atlas->TexUvLines));
+        for (const ImFontAtlasCustomRect& rect : atlas->CustomRects)
+        {
+            FontAtlasCacheRect r = toCacheRect(atlas, rect);
+            append(out, &r, sizeof(r));
+        }
+        for (const ImFont* font : atlas->Fonts)
+        {
+            FontAtlasCacheFont f;
+            f.fontSize = font->FontSize;
+            f.ascent = font->Ascent;
+            f.descent = font->Descent;
+            f.metricsTotalSurface = font->MetricsTotalSurface;
+            f.glyphCount = font->Glyphs.Size;
+            append(out, &f, sizeof(f));
+            append(out, font->Glyphs.Data, (size_t)font->Glyphs.Size * sizeof(ImFontGlyph));
+        }
+        append(out, atlas->TexPixelsAlpha8, (size_t)atlas->TexWidth * (size_t)atlas->TexHeight);
+
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            std::cout << "ERROR::FONTATLASCACHE::CANNOT_WRITE: " << path << std::endl;
+            return false;
+        }
+        fwrite(out.data(), 1, out.size(), file);
+        bool ok = ferror(file) == 0;
+        fclose(file);
+        if (!ok)
+        {
+            remove(path.c_str());
+            return false;
+        }
+        stats().fileBytes = out.size();
+        return true;
+    }
+
+    static std::string pathFor(uint64_t cacheKey)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.atlas", (unsigned long long)cacheKey);
+        return FileSystem::getPath(std::string(FONT_ATLAS_CACHE_DIR) + "/" + name);
+    }
+
+    static FontAtlasCacheStats& stats()
+    {
+        static FontAtlasCacheStats cacheStats;
+        return cacheStats;
+    }
+
+    static void printStats()
+    {
+        const FontAtlasCacheStats& s = stats();
+        std::cout << "Font atlas: " << s.width << "x" << s.height << ", " << s.glyphs << " glyphs, "
+            << (s.hit ? "cached: " : "built: ") << s.keyMs << " ms hashing, "
+            << (s.hit ? s.loadMs : s.buildMs) << (s.hit ? " ms loading, " : " ms rasterizing, ")
+            << s.fileBytes / 1024 << " KB file" << std::endl;
+    }
+
+    // continues FNV-1a over another block (with a length prefix so "ab"+"c" != "a"+"bc")
+    static uint64_t combine(uint64_t hash, const void* data, size_t size)
+    {
+        uint64_t length = size;
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&length);
+        for (size_t i = 0; i < sizeof(length); i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        bytes = reinterpret_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    static void makeDirectory(const std::string& path)
+    {
+#ifdef _WIN32
+        _mkdir(path.c_str());
+#else
+        mkdir(path.c_str(), 0755);
+#endif
+    }
+
+private:
+    struct Reader
+    {
+        const std::vector<char>& data;
+        size_t offset;
+        bool ok = true;
+
+        Reader(const std::vector<char>& bytes, size_t start) : data(bytes), offset(start) {}
+
+        // the next `size` bytes, or nullptr (and !ok) past the end
+        const char* skip(size_t size)
+        {
+            if (!ok || size > data.size() - offset)
+            {
+                ok = false;
+                return nullptr;
+            }
+            const char* at = data.data() + offset;
+            offset += size;
+            return at;
+        }
+
+        void read(void* out, size_t size)
+        {
+            const char* at = skip(size);
+            if (at && size > 0)
+                memcpy(out, at, size);
+        }
+    };
+
+    static void append(std::vector<char>& out, const void* data, size_t size)
+    {
+        const char* bytes = (const char*)data;
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    static int fontIndex(const ImFontAtlas* atlas, const ImFont* font)
+    {
+        for (int i = 0; i < atlas->Fonts.Size; i++)
+            if (atlas->Fonts[i] == font)
+                return i;
+        return -1;
+    }
+
+    static FontAtlasCacheRect toCacheRect(const ImFontAtlas* atlas, const ImFontAtlasCustomRect& rect)
+    {
+        FontAtlasCacheRect r;
+        memset(&r, 0, sizeof(r));
+        r.width = rect.Width;
+        r.height = rect.Height;
+        r.x = rect.X;
+        r.y = rect.Y;
+        r.glyphId = rect.GlyphID;
+        r.glyphAdvanceX = rect.GlyphAdvanceX;
+        r.glyphOffsetX = rect.GlyphOffset.x;
+        r.glyphOffsetY = rect.GlyphOffset.y;
+        r.font = fontIndex(atlas, rect.Font);
+        return r;
+    }
+
+    static double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// FONTATLASCACHE_H
+#endif
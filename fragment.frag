@@ -2,11 +2,15 @@
 out vec4 FragColor;
 
 in vec2 TexCoord;
+in vec3 FragPos;
 
 // texture sampler
 uniform sampler2D texture1;
 
+#include "lighting.glsl"
+
 void main()
 {
-    FragColor = texture(texture1, TexCoord);
+    vec4 albedo = texture(texture1, TexCoord);
+    FragColor = vec4(clusteredLighting(FragPos, albedo.rgb), albedo.a);
 }
\ No newline at end of file
@@ -0,0 +1,296 @@
+#ifndef GPUCULLING_H
+#define GPUCULLING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "affine.h"
+#include "baseShape.h"
+#include "shader_m.h"
+#include "shaderpreprocessor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// GL 4.3 layouts; culling.glsl declares the same structs (std430)
+struct DrawElementsIndirectCommand
+{
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t baseInstance;
+};
+
+// model is the three top rows only (the bottom row is always 0, 0, 0, 1):
+// 64 bytes per object instead of 80, and the shaders use the rows directly
+struct CullObject
+{
+    Affine model;
+    uint32_t mesh;
+    uint32_t occluded;  // hidden by the CPU occlusion culler; never drawn
+    uint32_t pad[2];
+};
+
+struct CullMesh
+{
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    float radius;       // object-space bounding sphere around the origin
+};
+
+// GPU-driven path for the placed shapes (GL 4.3+). Every distinct shape mesh
+// is appended to one merged vertex/index buffer; per-object transforms live
+// in an SSBO. Each frame a compute shader (cull.comp) tests every object's
+// bounding sphere against the frustum and writes one indexed draw command per
+// object, and all shapes are drawn with a single glMultiDrawElementsIndirect.
+// cullOnCpu() computes the same commands on the CPU so the GPU results can be
+// checked (see verify()).
+class GpuCulling
+{
+public:
+    static bool supported() { return GLAD_GL_VERSION_4_3 != 0; }
+
+    // planes as (inward normal, distance), from a projection * view matrix
+    static void frustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+    {
+        glm::mat4 m = glm::transpose(viewProjection);
+        planes[0] = m[3] + m[0];   // left
+        planes[1] = m[3] - m[0];   // right
+        planes[2] = m[3] + m[1];   // bottom
+        planes[3] = m[3] - m[1];   // top
+        planes[4] = m[3] + m[2];   // near
+        planes[5] = m[3] - m[2];   // far
+        for (int i = 0; i < 6; i++)
+            planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+
+    // the CPU mirror of cull.comp
+    static void cullOnCpu(const std::vector<CullObject>& objects, const std::vector<CullMesh>& meshes, const glm::vec4 planes[6],
+        std::vector<DrawElementsIndirectCommand>& commands)
+    {
+        commands.resize(objects.size());
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            const Affine& model = objects[i].model;
+            const CullMesh& mesh = meshes[objects[i].mesh];
+            glm::vec3 center = model.translation();
+            float scale = std::max(glm::length(model.column(0)), std::max(glm::length(model.column(1)), glm::length(model.column(2))));
+            float radius = mesh.radius * scale;
+
+            bool visible = objects[i].occluded == 0;
+            for (int p = 0; p < 6; p++)
+                visible = visible && glm::dot(glm::vec3(planes[p]), center) + planes[p].w >= -radius;
+
+            commands[i] = { mesh.indexCount, visible ? 1u : 0u, mesh.firstIndex, mesh.baseVertex, (uint32_t)i };
+        }
+    }
+
+    bool init()
+    {
+        if (!supported())
+            return false;
+        std::string source;
+        std::vector<std::string> files;
+        if (!ShaderPreprocessor::process("cull.comp", ShaderDefines(), source, files))
+            return false;
+        const char* code = source.c_str();
+        unsigned int shader = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(shader, 1, &code, NULL);
+        glCompileShader(shader);
+        m_Program = glCreateProgram();
+        glAttachShader(m_Program, shader);
+        glLinkProgram(m_Program);
+        glDeleteShader(shader);
+        GLint success;
+        glGetProgramiv(m_Program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            GLchar infoLog[1024];
+            glGetProgramInfoLog(m_Program, 1024, NULL, infoLog);
+            std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: COMPUTE\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+            glDeleteProgram(m_Program);
+            m_Program = 0;
+            return false;
+        }
+
+        glGenVertexArrays(1, &m_VAO);
+        glGenBuffers(BUFFER_COUNT, m_Buffers);
+        glBindVertexArray(m_VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_Buffers[VERTICES]);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        // object index per instance; each command's baseInstance offsets it
+        glBindBuffer(GL_ARRAY_BUFFER, m_Buffers[OBJECT_IDS]);
+        glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+        glVertexAttribDivisor(2, 1);
+        glEnableVertexAttribArray(2);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_Buffers[INDICES]);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return true;
+    }
+
+    void destroy()
+    {
+        if (!m_Program)
+            return;
+        glDeleteProgram(m_Program);
+        glDeleteVertexArrays(1, &m_VAO);
+        glDeleteBuffers(BUFFER_COUNT, m_Buffers);
+        m_Program = 0;
+    }
+
+    bool ready() const { return m_Program != 0; }
+
+    // refresh the object buffer from the shapes; meshes not seen before are
+    // appended to the merged buffers
+    // models has each shape's model matrix (TransformBatch::compose)
+    // occluded (optional) has one flag per shape; those get no draw
+    void update(const std::vector<BaseShape*>& shapes, const std::vector<glm::mat4>& models,
+        const std::vector<unsigned char>& occluded = std::vector<unsigned char>())
+    {
+        bool meshesAdded = false;
+        m_Objects.resize(shapes.size());
+        for (size_t i = 0; i < shapes.size(); i++)
+        {
+            std::string key = shapes[i]->meshKey();
+            auto known = m_MeshIds.find(key);
+            if (known == m_MeshIds.end())
+            {
+                known = m_MeshIds.emplace(key, addMesh(*shapes[i])).first;
+                meshesAdded = true;
+            }
+            m_Objects[i].model = Affine(models[i]);
+            m_Objects[i].mesh = known->second;
+            m_Objects[i].occluded = i < occluded.size() ? occluded[i] : 0;
+        }
+
+        if (meshesAdded)
+        {
+            glBindVertexArray(m_VAO); // the element buffer binding is VAO state
+            upload(GL_ARRAY_BUFFER, m_Buffers[VERTICES], m_Vertices.data(), m_Vertices.size() * sizeof(float), GL_STATIC_DRAW);
+            upload(GL_ELEMENT_ARRAY_BUFFER, m_Buffers[INDICES], m_Indices.data(), m_Indices.size() * sizeof(uint32_t), GL_STATIC_DRAW);
+            glBindVertexArray(0);
+            upload(GL_SHADER_STORAGE_BUFFER, m_Buffers[MESHES], m_Meshes.data(), m_Meshes.size() * sizeof(CullMesh), GL_STATIC_DRAW);
+        }
+        if (m_ObjectIds.size() < m_Objects.size())
+        {
+            // grows with the object count, never changes otherwise
+            size_t first = m_ObjectIds.size();
+            m_ObjectIds.resize(std::max(m_Objects.size(), first * 2));
+            for (size_t i = first; i < m_ObjectIds.size(); i++)
+                m_ObjectIds[i] = (uint32_t)i;
+            upload(GL_ARRAY_BUFFER, m_Buffers[OBJECT_IDS], m_ObjectIds.data(), m_ObjectIds.size() * sizeof(uint32_t), GL_STATIC_DRAW);
+            upload(GL_DRAW_INDIRECT_BUFFER, m_Buffers[COMMANDS], nullptr, m_ObjectIds.size() * sizeof(DrawElementsIndirectCommand), GL_DYNAMIC_DRAW);
+        }
+        upload(GL_SHADER_STORAGE_BUFFER, m_Buffers[OBJECTS], m_Objects.data(), m_Objects.size() * sizeof(CullObject), GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    // write this frame's draw commands on the GPU
+    void cull(const glm::mat4& viewProjection)
+    {
+        if (m_Objects.empty())
+            return;
+        frustumPlanes(viewProjection, m_Planes);
+        glUseProgram(m_Program);
+        glUniform4fv(glGetUniformLocation(m_Program, "frustumPlanes"), 6, &m_Planes[0][0]);
+        glUniform1ui(glGetUniformLocation(m_Program, "objectCount"), (GLuint)m_Objects.size());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_Buffers[OBJECTS]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_Buffers[MESHES]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_Buffers[COMMANDS]);
+        glDispatchCompute((GLuint)((m_Objects.size() + 63) / 64), 1, 1);
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+    }
+
+    // every shape in one call; shader is indirect.vert + the usual fragment shader, already in use
+    void draw() const
+    {
+        if (m_Objects.empty())
+            return;
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_Buffers[OBJECTS]);
+        glBindVertexArray(m_VAO);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_Buffers[COMMANDS]);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)m_Objects.size(), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    // read the GPU's commands back (stalls) and compare them with the CPU
+    // mirror; returns the number of objects whose command differs
+    int verify(int& visible)
+    {
+        std::vector<DrawElementsIndirectCommand> expected, actual(m_Objects.size());
+        cullOnCpu(m_Objects, m_Meshes, m_Planes, expected);
+        // cull() only made the commands visible to indirect draws; reading
+        // them back needs the compute writes made visible to buffer reads too
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_Buffers[COMMANDS]);
+        glGetBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, actual.size() * sizeof(DrawElementsIndirectCommand), actual.data());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        int mismatches = 0;
+        visible = 0;
+        for (size_t i = 0; i < actual.size(); i++)
+        {
+            visible += actual[i].instanceCount;
+            if (memcmp(&actual[i], &expected[i], sizeof(DrawElementsIndirectCommand)) != 0)
+                mismatches++;
+        }
+        return mismatches;
+    }
+
+    const std::vector<CullObject>& objects() const { return m_Objects; }
+    const std::vector<CullMesh>& meshes() const { return m_Meshes; }
+
+private:
+    enum { VERTICES, INDICES, OBJECT_IDS, OBJECTS, MESHES, COMMANDS, BUFFER_COUNT };
+
+    unsigned int m_Program = 0;
+    unsigned int m_VAO = 0;
+    unsigned int m_Buffers[BUFFER_COUNT] = {};
+    std::vector<float> m_Vertices;
+    std::vector<uint32_t> m_Indices;
+    std::vector<CullMesh> m_Meshes;
+    std::unordered_map<std::string, uint32_t> m_MeshIds;
+    std::vector<CullObject> m_Objects;
+    std::vector<uint32_t> m_ObjectIds;
+    glm::vec4 m_Planes[6];
+
+    uint32_t addMesh(const BaseShape& shape)
+    {
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+        shape.getMesh(vertices, indices);
+
+        CullMesh mesh;
+        mesh.indexCount = (uint32_t)indices.size();
+        mesh.firstIndex = (uint32_t)m_Indices.size();
+        mesh.baseVertex = (int32_t)(m_Vertices.size() / 3);
+        mesh.radius = 0.0f;
+        for (size_t v = 0; v + 2 < vertices.size(); v += 3)
+            mesh.radius = std::max(mesh.radius, glm::length(glm::vec3(vertices[v], vertices[v + 1], vertices[v + 2])));
+
+        m_Vertices.insert(m_Vertices.end(), vertices.begin(), vertices.end());
+        m_Indices.insert(m_Indices.end(), indices.begin(), indices.end());
+        m_Meshes.push_back(mesh);
+        return (uint32_t)(m_Meshes.size() - 1);
+    }
+
+    static void upload(GLenum target, unsigned int buffer, const void* data, size_t size, GLenum usage)
+    {
+        glBindBuffer(target, buffer);
+        glBufferData(target, size, data, usage);
+    }
+};
+
+// GPUCULLING_H
+#endif
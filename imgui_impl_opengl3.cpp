@@ -207,6 +207,62 @@
 #define IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
 #endif
 
+// Desktop GL 3.3+ and GL ES 3.0+ have texture swizzles, which let the font atlas be uploaded as one 8-bit channel
+// (our loader doesn't define the enums)
+#if !defined(IMGUI_IMPL_OPENGL_ES2)
+#define IMGUI_IMPL_OPENGL_MAY_HAVE_TEXTURE_SWIZZLE
+#ifndef GL_RED
+#define GL_RED                            0x1903
+#endif
+#ifndef GL_R8
+#define GL_R8                             0x8229
+#endif
+#ifndef GL_TEXTURE_SWIZZLE_R
+#define GL_TEXTURE_SWIZZLE_R              0x8E42
+#define GL_TEXTURE_SWIZZLE_G              0x8E43
+#define GL_TEXTURE_SWIZZLE_B              0x8E44
+#define GL_TEXTURE_SWIZZLE_A              0x8E45
+#endif
+#endif
+
+// Desktop GL through our own loader: the state queries can be counted
+#if !defined(IMGUI_IMPL_OPENGL_ES2) && !defined(IMGUI_IMPL_OPENGL_ES3) && !defined(IMGUI_IMPL_OPENGL_LOADER_CUSTOM)
+#define IMGUI_IMPL_OPENGL_COUNT_STATE_QUERIES
+#endif
+
+// Counting loader: the state queries in the loaded function table are replaced by wrappers that count calls
+// before forwarding them, which is how ImGui_ImplOpenGL3_GetStateQueryCount() measures the GL round-trips of a frame.
+// Only possible with our own loader: with a custom one, the calls go to functions we don't own.
+#ifdef IMGUI_IMPL_OPENGL_COUNT_STATE_QUERIES
+static int                  g_StateQueryCount = 0;
+static PFNGLGETINTEGERVPROC g_LoaderGetIntegerv = nullptr;
+static PFNGLISENABLEDPROC   g_LoaderIsEnabled = nullptr;
+static PFNGLISPROGRAMPROC   g_LoaderIsProgram = nullptr;
+static void APIENTRY        ImGui_ImplOpenGL3_CountGetIntegerv(GLenum pname, GLint* data) { g_StateQueryCount++; g_LoaderGetIntegerv(pname, data); }
+static GLboolean APIENTRY   ImGui_ImplOpenGL3_CountIsEnabled(GLenum cap) { g_StateQueryCount++; return g_LoaderIsEnabled(cap); }
+static GLboolean APIENTRY   ImGui_ImplOpenGL3_CountIsProgram(GLuint program) { g_StateQueryCount++; return g_LoaderIsProgram(program); }
+
+static void ImGui_ImplOpenGL3_InstallQueryCounters()
+{
+    // imgl3wInit() reloads the table for every Init(), so wrap whatever it holds unless it is already ours
+    if (imgl3wProcs.gl.GetIntegerv != ImGui_ImplOpenGL3_CountGetIntegerv)
+    {
+        g_LoaderGetIntegerv = imgl3wProcs.gl.GetIntegerv;
+        imgl3wProcs.gl.GetIntegerv = ImGui_ImplOpenGL3_CountGetIntegerv;
+    }
+    if (imgl3wProcs.gl.IsEnabled != ImGui_ImplOpenGL3_CountIsEnabled)
+    {
+        g_LoaderIsEnabled = imgl3wProcs.gl.IsEnabled;
+        imgl3wProcs.gl.IsEnabled = ImGui_ImplOpenGL3_CountIsEnabled;
+    }
+    if (imgl3wProcs.gl.IsProgram != ImGui_ImplOpenGL3_CountIsProgram)
+    {
+        g_LoaderIsProgram = imgl3wProcs.gl.IsProgram;
+        imgl3wProcs.gl.IsProgram = ImGui_ImplOpenGL3_CountIsProgram;
+    }
+}
+#endif
+
 // [Debugging]
 //#define IMGUI_IMPL_OPENGL_DEBUG
 #ifdef IMGUI_IMPL_OPENGL_DEBUG
@@ -238,6 +294,20 @@ struct ImGui_ImplOpenGL3_Data
     bool            HasPolygonMode;
     bool            HasClipOrigin;
     bool            UseBufferSubData;
+    bool            UseSingleUpload;         // ImGui_ImplOpenGL3_SetSingleUpload(): VertexBufferSize/IndexBufferSize are then ring capacities
+    GLsizeiptr      VertexBufferOffset;      // Single upload: where the next frame's vertices/indices go in the ring
+    GLsizeiptr      IndexBufferOffset;
+    int             FrameDrawLists;          // Stats of the last ImGui_ImplOpenGL3_RenderDrawData()
+    int             FrameUploadCalls;
+    int             FrameUploadBytes;
+    int             TrustedState;            // ImGui_ImplOpenGL3_SetTrustedState(): ImGui_ImplOpenGL3_TrustedState_ flags
+    int             FrameStateQueries;       // glGetIntegerv()/glIsEnabled()/glIsProgram() calls of the last frame, -1 when not counted
+    bool            UseAlpha8FontTexture;    // ImGui_ImplOpenGL3_SetFontTextureAlpha8()
+    int             FontTextureBytes;        // Texel bytes of the uploaded font texture
+    ImFontAtlas*    SdfFontAtlas;            // ImGui_ImplOpenGL3_SetSdfFontAtlas()
+    GLuint          SdfFontTexture;
+    GLint           AttribLocationDistanceField; // -1 for the GLSL 1.20 shader, which has no distance-field path
+    bool            DistanceFieldBound;      // The uniform's current value
 
     ImGui_ImplOpenGL3_Data() { memset((void*)this, 0, sizeof(*this)); }
 };
@@ -249,6 +319,10 @@ static ImGui_ImplOpenGL3_Data* ImGui_ImplOpenGL3_GetBackendData()
     return ImGui::GetCurrentContext() ? (ImGui_ImplOpenGL3_Data*)ImGui::GetIO().BackendRendererUserData : nullptr;
 }
 
+// The SDF font texture lives next to the font texture
+static bool ImGui_ImplOpenGL3_CreateSdfFontTexture();
+static void ImGui_ImplOpenGL3_DestroySdfFontTexture();
+
 // OpenGL vertex attribute state (for ES 1.0 and ES 2.0 only)
 #ifndef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
 struct ImGui_ImplOpenGL3_VtxAttribState
@@ -287,6 +361,7 @@ bool    ImGui_ImplOpenGL3_Init(const char* glsl_version)
         fprintf(stderr, "Failed to initialize OpenGL loader!\n");
         return false;
     }
+    ImGui_ImplOpenGL3_InstallQueryCounters();
 #endif
 
     // Setup backend capabilities flags
@@ -406,6 +481,75 @@ void    ImGui_ImplOpenGL3_NewFrame()
         ImGui_ImplOpenGL3_CreateDeviceObjects();
     if (!bd->FontTexture)
         ImGui_ImplOpenGL3_CreateFontsTexture();
+    if (bd->SdfFontAtlas && !bd->SdfFontTexture)
+        ImGui_ImplOpenGL3_CreateSdfFontTexture();
+}
+
+void    ImGui_ImplOpenGL3_SetSingleUpload(bool enable)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized! Did you call ImGui_ImplOpenGL3_Init()?");
+    if (bd->UseSingleUpload == enable)
+        return;
+    // The per-list path resizes the buffers with every glBufferData(): start the ring over on fresh storage
+    bd->UseSingleUpload = enable;
+    bd->VertexBufferSize = bd->IndexBufferSize = 0;
+    bd->VertexBufferOffset = bd->IndexBufferOffset = 0;
+}
+
+void    ImGui_ImplOpenGL3_GetUploadStats(int* out_draw_lists, int* out_upload_calls, int* out_upload_bytes)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized! Did you call ImGui_ImplOpenGL3_Init()?");
+    if (out_draw_lists) *out_draw_lists = bd->FrameDrawLists;
+    if (out_upload_calls) *out_upload_calls = bd->FrameUploadCalls;
+    if (out_upload_bytes) *out_upload_bytes = bd->FrameUploadBytes;
+}
+
+void    ImGui_ImplOpenGL3_SetTrustedState(int trusted_state_flags)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized! Did you call ImGui_ImplOpenGL3_Init()?");
+    bd->TrustedState = trusted_state_flags;
+}
+
+int     ImGui_ImplOpenGL3_GetStateQueryCount()
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized! Did you call ImGui_ImplOpenGL3_Init()?");
+    return bd->FrameStateQueries;
+}
+
+void    ImGui_ImplOpenGL3_SetFontTextureAlpha8(bool enable)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized! Did you call ImGui_ImplOpenGL3_Init()?");
+    if (bd->UseAlpha8FontTexture == enable)
+        return;
+    // Upload it again in the new format at the next NewFrame()
+    bd->UseAlpha8FontTexture = enable;
+    ImGui_ImplOpenGL3_DestroyFontsTexture();
+}
+
+int     ImGui_ImplOpenGL3_GetFontTextureBytes()
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized! Did you call ImGui_ImplOpenGL3_Init()?");
+    return bd->FontTexture ? bd->FontTextureBytes : 0;
+}
+
+bool    ImGui_ImplOpenGL3_SetSdfFontAtlas(ImFontAtlas* atlas)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized! Did you call ImGui_ImplOpenGL3_Init()?");
+    ImGui_ImplOpenGL3_DestroySdfFontTexture();
+    bd->SdfFontAtlas = nullptr;
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_TEXTURE_SWIZZLE
+    // Uploaded at the next NewFrame(), once the shader is known to have the distance-field path
+    if (atlas && (bd->GlVersion >= 330 || bd->GlProfileIsES3))
+        bd->SdfFontAtlas = atlas;
+#endif
+    return bd->SdfFontAtlas == atlas;
 }
 
 static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_width, int fb_height, GLuint vertex_array_object)
@@ -460,6 +604,9 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
     glUseProgram(bd->ShaderHandle);
     glUniform1i(bd->AttribLocationTex, 0);
     glUniformMatrix4fv(bd->AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
+    if (bd->AttribLocationDistanceField >= 0)
+        glUniform1i(bd->AttribLocationDistanceField, 0);
+    bd->DistanceFieldBound = false;
 
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
     if (bd->GlVersion >= 330 || bd->GlProfileIsES3)
@@ -482,6 +629,77 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
     GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)offsetof(ImDrawVert, col)));
 }
 
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
+// Single upload: maps 'size' bytes at the ring position of the buffer bound to 'target'.
+// A range is never written again while the GPU may still read it: when the ring is full the storage is
+// orphaned (glBufferData() with no data hands the driver a fresh block) and writing restarts at 0,
+// which is what makes the unsynchronized mapping safe without fences.
+static void* ImGui_ImplOpenGL3_MapStreamRange(GLenum target, GLsizeiptr* capacity, GLsizeiptr* offset, GLsizeiptr size)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    if (*offset + size > *capacity)
+    {
+        if (size > *capacity)
+            *capacity = size * 4; // A few frames' worth before the next orphaning
+        GL_CALL(glBufferData(target, *capacity, nullptr, GL_STREAM_DRAW));
+        bd->FrameUploadCalls++;
+        *offset = 0;
+    }
+    void* ptr;
+    GL_CALL(ptr = glMapBufferRange(target, *offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+    bd->FrameUploadCalls++;
+    return ptr;
+}
+
+// Single upload: copies all draw lists, back to back, into one mapped range of each buffer.
+// Returns where the frame starts (in vertices and in index bytes), or false when the mode is off or
+// unsupported or the buffers could not be mapped, and the caller uploads list by list instead.
+static bool ImGui_ImplOpenGL3_UploadDrawDataSingle(ImDrawData* draw_data, GLint* out_vtx_base, GLintptr* out_idx_base)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    *out_vtx_base = 0;
+    *out_idx_base = 0;
+    if (!bd->UseSingleUpload || bd->GlVersion < 320)
+        return false;
+    const GLsizeiptr vtx_size = (GLsizeiptr)draw_data->TotalVtxCount * (int)sizeof(ImDrawVert);
+    const GLsizeiptr idx_size = (GLsizeiptr)draw_data->TotalIdxCount * (int)sizeof(ImDrawIdx);
+    if (vtx_size == 0 || idx_size == 0)
+        return true; // Nothing to draw, but callbacks still run
+
+    ImDrawVert* vtx_dst = (ImDrawVert*)ImGui_ImplOpenGL3_MapStreamRange(GL_ARRAY_BUFFER, &bd->VertexBufferSize, &bd->VertexBufferOffset, vtx_size);
+    ImDrawIdx* idx_dst = (ImDrawIdx*)ImGui_ImplOpenGL3_MapStreamRange(GL_ELEMENT_ARRAY_BUFFER, &bd->IndexBufferSize, &bd->IndexBufferOffset, idx_size);
+    bool mapped = vtx_dst != nullptr && idx_dst != nullptr;
+    if (mapped)
+    {
+        for (int n = 0; n < draw_data->CmdListsCount; n++)
+        {
+            const ImDrawList* cmd_list = draw_data->CmdLists[n];
+            memcpy(vtx_dst, cmd_list->VtxBuffer.Data, (size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+            memcpy(idx_dst, cmd_list->IdxBuffer.Data, (size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+            vtx_dst += cmd_list->VtxBuffer.Size;
+            idx_dst += cmd_list->IdxBuffer.Size;
+        }
+    }
+    // glUnmapBuffer() returns GL_FALSE when the contents were lost (e.g. on a display mode change)
+    if (vtx_dst != nullptr && !glUnmapBuffer(GL_ARRAY_BUFFER))
+        mapped = false;
+    if (idx_dst != nullptr && !glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER))
+        mapped = false;
+    if (!mapped)
+    {
+        bd->VertexBufferSize = bd->IndexBufferSize = 0; // Start over with fresh storage next frame
+        return false;
+    }
+
+    *out_vtx_base = (GLint)(bd->VertexBufferOffset / (GLsizeiptr)sizeof(ImDrawVert));
+    *out_idx_base = (GLintptr)bd->IndexBufferOffset;
+    bd->VertexBufferOffset += vtx_size;
+    bd->IndexBufferOffset += idx_size;
+    bd->FrameUploadBytes += (int)(vtx_size + idx_size);
+    return true;
+}
+#endif
+
 // OpenGL3 Render function.
 // Note that this implementation is little overcomplicated because we are saving/setting up/restoring every OpenGL state explicitly.
 // This is in order to be able to run within an OpenGL engine that doesn't do so.
@@ -494,44 +712,73 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
         return;
 
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    bd->FrameDrawLists = draw_data->CmdListsCount;
+    bd->FrameUploadCalls = 0;
+    bd->FrameUploadBytes = 0;
 
-    // Backup GL state
-    GLenum last_active_texture; glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&last_active_texture);
+    // Backup GL state, except what the application declared it restores itself (see ImGui_ImplOpenGL3_SetTrustedState())
+#ifdef IMGUI_IMPL_OPENGL_COUNT_STATE_QUERIES
+    const int state_queries_start = g_StateQueryCount;
+#endif
+    const bool backup_program = (bd->TrustedState & ImGui_ImplOpenGL3_TrustedState_Program) == 0;
+    const bool backup_textures = (bd->TrustedState & ImGui_ImplOpenGL3_TrustedState_Textures) == 0;
+    const bool backup_buffers = (bd->TrustedState & ImGui_ImplOpenGL3_TrustedState_Buffers) == 0;
+    const bool backup_viewport = (bd->TrustedState & ImGui_ImplOpenGL3_TrustedState_Viewport) == 0;
+    const bool backup_blend = (bd->TrustedState & ImGui_ImplOpenGL3_TrustedState_Blend) == 0;
+    const bool backup_capabilities = (bd->TrustedState & ImGui_ImplOpenGL3_TrustedState_Capabilities) == 0;
+    GLenum last_active_texture = GL_TEXTURE0; if (backup_textures) { glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&last_active_texture); }
     glActiveTexture(GL_TEXTURE0);
-    GLuint last_program; glGetIntegerv(GL_CURRENT_PROGRAM, (GLint*)&last_program);
-    GLuint last_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, (GLint*)&last_texture);
+    GLuint last_program = 0; if (backup_program) { glGetIntegerv(GL_CURRENT_PROGRAM, (GLint*)&last_program); }
+    GLuint last_texture = 0; if (backup_textures) { glGetIntegerv(GL_TEXTURE_BINDING_2D, (GLint*)&last_texture); }
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
-    GLuint last_sampler; if (bd->GlVersion >= 330 || bd->GlProfileIsES3) { glGetIntegerv(GL_SAMPLER_BINDING, (GLint*)&last_sampler); } else { last_sampler = 0; }
+    GLuint last_sampler = 0; if (backup_textures && (bd->GlVersion >= 330 || bd->GlProfileIsES3)) { glGetIntegerv(GL_SAMPLER_BINDING, (GLint*)&last_sampler); }
 #endif
-    GLuint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, (GLint*)&last_array_buffer);
+    GLuint last_array_buffer = 0; if (backup_buffers) { glGetIntegerv(GL_ARRAY_BUFFER_BINDING, (GLint*)&last_array_buffer); }
 #ifndef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
     // This is part of VAO on OpenGL 3.0+ and OpenGL ES 3.0+.
-    GLint last_element_array_buffer; glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &last_element_array_buffer);
-    ImGui_ImplOpenGL3_VtxAttribState last_vtx_attrib_state_pos; last_vtx_attrib_state_pos.GetState(bd->AttribLocationVtxPos);
-    ImGui_ImplOpenGL3_VtxAttribState last_vtx_attrib_state_uv; last_vtx_attrib_state_uv.GetState(bd->AttribLocationVtxUV);
-    ImGui_ImplOpenGL3_VtxAttribState last_vtx_attrib_state_color; last_vtx_attrib_state_color.GetState(bd->AttribLocationVtxColor);
+    GLint last_element_array_buffer = 0;
+    ImGui_ImplOpenGL3_VtxAttribState last_vtx_attrib_state_pos, last_vtx_attrib_state_uv, last_vtx_attrib_state_color;
+    if (backup_buffers)
+    {
+        glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &last_element_array_buffer);
+        last_vtx_attrib_state_pos.GetState(bd->AttribLocationVtxPos);
+        last_vtx_attrib_state_uv.GetState(bd->AttribLocationVtxUV);
+        last_vtx_attrib_state_color.GetState(bd->AttribLocationVtxColor);
+    }
 #endif
 #ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
-    GLuint last_vertex_array_object; glGetIntegerv(GL_VERTEX_ARRAY_BINDING, (GLint*)&last_vertex_array_object);
+    GLuint last_vertex_array_object = 0; if (backup_buffers) { glGetIntegerv(GL_VERTEX_ARRAY_BINDING, (GLint*)&last_vertex_array_object); }
 #endif
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_POLYGON_MODE
-    GLint last_polygon_mode[2]; if (bd->HasPolygonMode) { glGetIntegerv(GL_POLYGON_MODE, last_polygon_mode); }
-#endif
-    GLint last_viewport[4]; glGetIntegerv(GL_VIEWPORT, last_viewport);
-    GLint last_scissor_box[4]; glGetIntegerv(GL_SCISSOR_BOX, last_scissor_box);
-    GLenum last_blend_src_rgb; glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&last_blend_src_rgb);
-    GLenum last_blend_dst_rgb; glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&last_blend_dst_rgb);
-    GLenum last_blend_src_alpha; glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&last_blend_src_alpha);
-    GLenum last_blend_dst_alpha; glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&last_blend_dst_alpha);
-    GLenum last_blend_equation_rgb; glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&last_blend_equation_rgb);
-    GLenum last_blend_equation_alpha; glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&last_blend_equation_alpha);
-    GLboolean last_enable_blend = glIsEnabled(GL_BLEND);
-    GLboolean last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
-    GLboolean last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
-    GLboolean last_enable_stencil_test = glIsEnabled(GL_STENCIL_TEST);
-    GLboolean last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
+    GLint last_polygon_mode[2]; if (bd->HasPolygonMode && backup_capabilities) { glGetIntegerv(GL_POLYGON_MODE, last_polygon_mode); }
+#endif
+    GLint last_viewport[4], last_scissor_box[4];
+    if (backup_viewport)
+    {
+        glGetIntegerv(GL_VIEWPORT, last_viewport);
+        glGetIntegerv(GL_SCISSOR_BOX, last_scissor_box);
+    }
+    GLenum last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha, last_blend_equation_rgb, last_blend_equation_alpha;
+    if (backup_blend)
+    {
+        glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&last_blend_src_rgb);
+        glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&last_blend_dst_rgb);
+        glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&last_blend_src_alpha);
+        glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&last_blend_dst_alpha);
+        glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&last_blend_equation_rgb);
+        glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&last_blend_equation_alpha);
+    }
+    GLboolean last_enable_blend = GL_FALSE, last_enable_cull_face = GL_FALSE, last_enable_depth_test = GL_FALSE, last_enable_stencil_test = GL_FALSE, last_enable_scissor_test = GL_FALSE;
+    if (backup_capabilities)
+    {
+        last_enable_blend = glIsEnabled(GL_BLEND);
+        last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
+        last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
+        last_enable_stencil_test = glIsEnabled(GL_STENCIL_TEST);
+        last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
+    }
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_PRIMITIVE_RESTART
-    GLboolean last_enable_primitive_restart = (bd->GlVersion >= 310) ? glIsEnabled(GL_PRIMITIVE_RESTART) : GL_FALSE;
+    GLboolean last_enable_primitive_restart = (bd->GlVersion >= 310 && backup_capabilities) ? glIsEnabled(GL_PRIMITIVE_RESTART) : GL_FALSE;
 #endif
 
     // Setup desired GL state
@@ -547,10 +794,28 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
     ImVec2 clip_off = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
     ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
 
+    // Single-upload mode: all lists are uploaded up front, so draws are offset by where each list landed
+    GLint frame_vtx_base = 0;
+    GLintptr frame_idx_base = 0;
+    bool single_upload = false;
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
+    single_upload = ImGui_ImplOpenGL3_UploadDrawDataSingle(draw_data, &frame_vtx_base, &frame_idx_base);
+#endif
+    int global_vtx_offset = 0;
+    int global_idx_offset = 0;
+
     // Render command lists
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
         const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        const GLint list_vtx_base = frame_vtx_base + global_vtx_offset;
+        const GLintptr list_idx_base = frame_idx_base + (GLintptr)global_idx_offset * (int)sizeof(ImDrawIdx);
+        if (single_upload)
+        {
+            global_vtx_offset += cmd_list->VtxBuffer.Size;
+            global_idx_offset += cmd_list->IdxBuffer.Size;
+        }
+        (void)list_vtx_base; (void)list_idx_base; // Not all compilation paths use these
 
         // Upload vertex/index buffers
         // - OpenGL drivers are in a very sorry state nowadays....
@@ -562,7 +827,13 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
         // - See https://github.com/ocornut/imgui/issues/4468 and please report any corruption issues.
         const GLsizeiptr vtx_buffer_size = (GLsizeiptr)cmd_list->VtxBuffer.Size * (int)sizeof(ImDrawVert);
         const GLsizeiptr idx_buffer_size = (GLsizeiptr)cmd_list->IdxBuffer.Size * (int)sizeof(ImDrawIdx);
-        if (bd->UseBufferSubData)
+        bd->FrameUploadCalls += single_upload ? 0 : 2;
+        bd->FrameUploadBytes += single_upload ? 0 : (int)(vtx_buffer_size + idx_buffer_size);
+        if (single_upload)
+        {
+            // Already uploaded with the rest of the frame by ImGui_ImplOpenGL3_UploadDrawDataSingle()
+        }
+        else if (bd->UseBufferSubData)
         {
             if (bd->VertexBufferSize < vtx_buffer_size)
             {
@@ -606,11 +877,17 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
                 // Apply scissor/clipping rectangle (Y is inverted in OpenGL)
                 GL_CALL(glScissor((int)clip_min.x, (int)((float)fb_height - clip_max.y), (int)(clip_max.x - clip_min.x), (int)(clip_max.y - clip_min.y)));
 
-                // Bind texture, Draw
-                GL_CALL(glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->GetTexID()));
+                // Bind texture (the SDF font atlas with distance-field sampling), Draw
+                GLuint texture = (GLuint)(intptr_t)pcmd->GetTexID();
+                if (bd->SdfFontTexture != 0 && (texture == bd->SdfFontTexture) != bd->DistanceFieldBound)
+                {
+                    bd->DistanceFieldBound = !bd->DistanceFieldBound;
+                    GL_CALL(glUniform1i(bd->AttribLocationDistanceField, bd->DistanceFieldBound ? 1 : 0));
+                }
+                GL_CALL(glBindTexture(GL_TEXTURE_2D, texture));
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
                 if (bd->GlVersion >= 320)
-                    GL_CALL(glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx)), (GLint)pcmd->VtxOffset));
+                    GL_CALL(glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(list_idx_base + pcmd->IdxOffset * sizeof(ImDrawIdx)), list_vtx_base + (GLint)pcmd->VtxOffset));
                 else
 #endif
                 GL_CALL(glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx))));
@@ -625,41 +902,61 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
 
     // Restore modified GL state
     // This "glIsProgram()" check is required because if the program is "pending deletion" at the time of binding backup, it will have been deleted by now and will cause an OpenGL error. See #6220.
-    if (last_program == 0 || glIsProgram(last_program)) glUseProgram(last_program);
-    glBindTexture(GL_TEXTURE_2D, last_texture);
+    if (backup_program && (last_program == 0 || glIsProgram(last_program))) glUseProgram(last_program);
+    if (backup_textures)
+    {
+        glBindTexture(GL_TEXTURE_2D, last_texture);
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
-    if (bd->GlVersion >= 330 || bd->GlProfileIsES3)
-        glBindSampler(0, last_sampler);
+        if (bd->GlVersion >= 330 || bd->GlProfileIsES3)
+            glBindSampler(0, last_sampler);
 #endif
-    glActiveTexture(last_active_texture);
+        glActiveTexture(last_active_texture);
+    }
+    if (backup_buffers)
+    {
 #ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
-    glBindVertexArray(last_vertex_array_object);
+        glBindVertexArray(last_vertex_array_object);
 #endif
-    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
 #ifndef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, last_element_array_buffer);
-    last_vtx_attrib_state_pos.SetState(bd->AttribLocationVtxPos);
-    last_vtx_attrib_state_uv.SetState(bd->AttribLocationVtxUV);
-    last_vtx_attrib_state_color.SetState(bd->AttribLocationVtxColor);
-#endif
-    glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
-    glBlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha);
-    if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-    if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
-    if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
-    if (last_enable_stencil_test) glEnable(GL_STENCIL_TEST); else glDisable(GL_STENCIL_TEST);
-    if (last_enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, last_element_array_buffer);
+        last_vtx_attrib_state_pos.SetState(bd->AttribLocationVtxPos);
+        last_vtx_attrib_state_uv.SetState(bd->AttribLocationVtxUV);
+        last_vtx_attrib_state_color.SetState(bd->AttribLocationVtxColor);
+#endif
+    }
+    if (backup_blend)
+    {
+        glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
+        glBlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha);
+    }
+    if (backup_capabilities)
+    {
+        if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
+        if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
+        if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+        if (last_enable_stencil_test) glEnable(GL_STENCIL_TEST); else glDisable(GL_STENCIL_TEST);
+        if (last_enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_PRIMITIVE_RESTART
-    if (bd->GlVersion >= 310) { if (last_enable_primitive_restart) glEnable(GL_PRIMITIVE_RESTART); else glDisable(GL_PRIMITIVE_RESTART); }
+        if (bd->GlVersion >= 310) { if (last_enable_primitive_restart) glEnable(GL_PRIMITIVE_RESTART); else glDisable(GL_PRIMITIVE_RESTART); }
 #endif
 
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_POLYGON_MODE
-    // Desktop OpenGL 3.0 and OpenGL 3.1 had separate polygon draw modes for front-facing and back-facing faces of polygons
-    if (bd->HasPolygonMode) { if (bd->GlVersion <= 310 || bd->GlProfileIsCompat) { glPolygonMode(GL_FRONT, (GLenum)last_polygon_mode[0]); glPolygonMode(GL_BACK, (GLenum)last_polygon_mode[1]); } else { glPolygonMode(GL_FRONT_AND_BACK, (GLenum)last_polygon_mode[0]); } }
+        // Desktop OpenGL 3.0 and OpenGL 3.1 had separate polygon draw modes for front-facing and back-facing faces of polygons
+        if (bd->HasPolygonMode) { if (bd->GlVersion <= 310 || bd->GlProfileIsCompat) { glPolygonMode(GL_FRONT, (GLenum)last_polygon_mode[0]); glPolygonMode(GL_BACK, (GLenum)last_polygon_mode[1]); } else { glPolygonMode(GL_FRONT_AND_BACK, (GLenum)last_polygon_mode[0]); } }
 #endif // IMGUI_IMPL_OPENGL_MAY_HAVE_POLYGON_MODE
+    }
 
-    glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
-    glScissor(last_scissor_box[0], last_scissor_box[1], (GLsizei)last_scissor_box[2], (GLsizei)last_scissor_box[3]);
+    if (backup_viewport)
+    {
+        glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
+        glScissor(last_scissor_box[0], last_scissor_box[1], (GLsizei)last_scissor_box[2], (GLsizei)last_scissor_box[3]);
+    }
+#ifdef IMGUI_IMPL_OPENGL_COUNT_STATE_QUERIES
+    bd->FrameStateQueries = g_StateQueryCount - state_queries_start;
+#else
+    bd->FrameStateQueries = -1;
+#endif
     (void)bd; // Not all compilation paths use this
 }
 
@@ -669,9 +966,21 @@ bool ImGui_ImplOpenGL3_CreateFontsTexture()
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
 
     // Build texture atlas
+    // Alpha8 mode (GL 3.3+/ES 3.0+): one R8 channel swizzled to (1, 1, 1, R) reads exactly like the RGBA32 texels, at a
+    // quarter of the memory and without the RGBA32 copy of the atlas. Rows must then be 4-byte multiples for the default
+    // unpack alignment, which power-of-two atlas widths always are.
     unsigned char* pixels;
     int width, height;
-    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);   // Load as RGBA 32-bit (75% of the memory is wasted, but default font is so small) because it is more likely to be compatible with user's existing shaders. If your ImTextureId represent a higher-level concept than just a GL texture id, consider calling GetTexDataAsAlpha8() instead to save on GPU memory.
+    bool alpha8 = false;
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_TEXTURE_SWIZZLE
+    if (bd->UseAlpha8FontTexture && (bd->GlVersion >= 330 || bd->GlProfileIsES3))
+    {
+        io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+        alpha8 = (width % 4) == 0;
+    }
+#endif
+    if (!alpha8)
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);   // Load as RGBA 32-bit (75% of the memory is wasted, but default font is so small) because it is more likely to be compatible with user's existing shaders. If your ImTextureId represent a higher-level concept than just a GL texture id, consider calling GetTexDataAsAlpha8() instead to save on GPU memory.
 
     // Upload texture to graphics system
     // (Bilinear sampling is required by default. Set 'io.Fonts->Flags |= ImFontAtlasFlags_NoBakedLines' or 'style.AntiAliasedLinesUseTex = false' to allow point/nearest sampling)
@@ -683,8 +992,20 @@ bool ImGui_ImplOpenGL3_CreateFontsTexture()
     GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
 #ifdef GL_UNPACK_ROW_LENGTH // Not on WebGL/ES
     GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+#endif
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_TEXTURE_SWIZZLE
+    if (alpha8)
+    {
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_ONE));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_ONE));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_ONE));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_RED));
+        GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels));
+    }
+    else
 #endif
     GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+    bd->FontTextureBytes = width * height * (alpha8 ? 1 : 4);
 
     // Store our identifier
     io.Fonts->SetTexID((ImTextureID)(intptr_t)bd->FontTexture);
@@ -707,6 +1028,55 @@ void ImGui_ImplOpenGL3_DestroyFontsTexture()
     }
 }
 
+// The SDF font atlas as one R8 channel swizzled to (1, 1, 1, R), like the Alpha8 font texture: the shader reads the
+// distance from the alpha
+static bool ImGui_ImplOpenGL3_CreateSdfFontTexture()
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    ImFontAtlas* atlas = bd->SdfFontAtlas;
+    unsigned char* pixels;
+    int width, height;
+    atlas->GetTexDataAsAlpha8(&pixels, &width, &height);
+    if (bd->AttribLocationDistanceField < 0 || (width % 4) != 0)
+    {
+        bd->SdfFontAtlas = nullptr;
+        return false;
+    }
+
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_TEXTURE_SWIZZLE
+    GLint last_texture;
+    GL_CALL(glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture));
+    GL_CALL(glGenTextures(1, &bd->SdfFontTexture));
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, bd->SdfFontTexture));
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+#ifdef GL_UNPACK_ROW_LENGTH // Not on WebGL/ES
+    GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+#endif
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_ONE));
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_ONE));
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_ONE));
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_RED));
+    GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels));
+    atlas->SetTexID((ImTextureID)(intptr_t)bd->SdfFontTexture);
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, last_texture));
+    return true;
+#else
+    return false;
+#endif
+}
+
+static void ImGui_ImplOpenGL3_DestroySdfFontTexture()
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    if (bd->SdfFontTexture)
+    {
+        glDeleteTextures(1, &bd->SdfFontTexture);
+        bd->SdfFontAtlas->SetTexID(0);
+        bd->SdfFontTexture = 0;
+    }
+}
+
 // If you get an error please report on github. You may try different GL context version or GLSL version. See GL<>GLSL version table at the top of this file.
 static bool CheckShader(GLuint handle, const char* desc)
 {
@@ -835,35 +1205,58 @@ bool    ImGui_ImplOpenGL3_CreateDeviceObjects()
         "    gl_FragColor = Frag_Color * texture2D(Texture, Frag_UV.st);\n"
         "}\n";
 
+    // GLSL 1.30+ shaders: with DistanceField set the texture's alpha is a distance to a glyph outline (0.5 on it), turned
+    // into coverage over one pixel of screen space, whatever the glyph's scale
     const GLchar* fragment_shader_glsl_130 =
         "uniform sampler2D Texture;\n"
+        "uniform bool DistanceField;\n"
         "in vec2 Frag_UV;\n"
         "in vec4 Frag_Color;\n"
         "out vec4 Out_Color;\n"
         "void main()\n"
         "{\n"
-        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+        "    vec4 texel = texture(Texture, Frag_UV.st);\n"
+        "    if (DistanceField)\n"
+        "    {\n"
+        "        float width = max(length(vec2(dFdx(texel.a), dFdy(texel.a))), 0.0001);\n"
+        "        texel.a = clamp((texel.a - 0.5) / width + 0.5, 0.0, 1.0);\n"
+        "    }\n"
+        "    Out_Color = Frag_Color * texel;\n"
         "}\n";
 
     const GLchar* fragment_shader_glsl_300_es =
         "precision mediump float;\n"
         "uniform sampler2D Texture;\n"
+        "uniform bool DistanceField;\n"
         "in vec2 Frag_UV;\n"
         "in vec4 Frag_Color;\n"
         "layout (location = 0) out vec4 Out_Color;\n"
         "void main()\n"
         "{\n"
-        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+        "    vec4 texel = texture(Texture, Frag_UV.st);\n"
+        "    if (DistanceField)\n"
+        "    {\n"
+        "        float width = max(length(vec2(dFdx(texel.a), dFdy(texel.a))), 0.0001);\n"
+        "        texel.a = clamp((texel.a - 0.5) / width + 0.5, 0.0, 1.0);\n"
+        "    }\n"
+        "    Out_Color = Frag_Color * texel;\n"
         "}\n";
 
     const GLchar* fragment_shader_glsl_410_core =
         "in vec2 Frag_UV;\n"
         "in vec4 Frag_Color;\n"
         "uniform sampler2D Texture;\n"
+        "uniform bool DistanceField;\n"
         "layout (location = 0) out vec4 Out_Color;\n"
         "void main()\n"
         "{\n"
-        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+        "    vec4 texel = texture(Texture, Frag_UV.st);\n"
+        "    if (DistanceField)\n"
+        "    {\n"
+        "        float width = max(length(vec2(dFdx(texel.a), dFdy(texel.a))), 0.0001);\n"
+        "        texel.a = clamp((texel.a - 0.5) / width + 0.5, 0.0, 1.0);\n"
+        "    }\n"
+        "    Out_Color = Frag_Color * texel;\n"
         "}\n";
 
     // Select shaders matching our GLSL versions
@@ -917,6 +1310,7 @@ bool    ImGui_ImplOpenGL3_CreateDeviceObjects()
 
     bd->AttribLocationTex = glGetUniformLocation(bd->ShaderHandle, "Texture");
     bd->AttribLocationProjMtx = glGetUniformLocation(bd->ShaderHandle, "ProjMtx");
+    bd->AttribLocationDistanceField = glGetUniformLocation(bd->ShaderHandle, "DistanceField");
     bd->AttribLocationVtxPos = (GLuint)glGetAttribLocation(bd->ShaderHandle, "Position");
     bd->AttribLocationVtxUV = (GLuint)glGetAttribLocation(bd->ShaderHandle, "UV");
     bd->AttribLocationVtxColor = (GLuint)glGetAttribLocation(bd->ShaderHandle, "Color");
@@ -945,8 +1339,11 @@ void    ImGui_ImplOpenGL3_DestroyDeviceObjects()
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
     if (bd->VboHandle)      { glDeleteBuffers(1, &bd->VboHandle); bd->VboHandle = 0; }
     if (bd->ElementsHandle) { glDeleteBuffers(1, &bd->ElementsHandle); bd->ElementsHandle = 0; }
+    bd->VertexBufferSize = bd->IndexBufferSize = 0;
+    bd->VertexBufferOffset = bd->IndexBufferOffset = 0;
     if (bd->ShaderHandle)   { glDeleteProgram(bd->ShaderHandle); bd->ShaderHandle = 0; }
     ImGui_ImplOpenGL3_DestroyFontsTexture();
+    ImGui_ImplOpenGL3_DestroySdfFontTexture();
 }
 
 //-----------------------------------------------------------------------------
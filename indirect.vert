@@ -0,0 +1,23 @@
+#version 430 core
+// vertex.vert for shapes drawn from the merged mesh buffer with
+// glMultiDrawElementsIndirect: the model matrix comes from the object buffer,
+// as its top three rows
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in uint aObject;   // per instance; offset by the command's baseInstance
+
+#include "culling.glsl"
+
+out vec2 TexCoord;
+out vec3 FragPos;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    vec4 position = vec4(aPos, 1.0);
+    FragPos = vec3(dot(objects[aObject].modelRows[0], position), dot(objects[aObject].modelRows[1], position),
+        dot(objects[aObject].modelRows[2], position));
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+    TexCoord = vec2(0.0); // the shapes have no texture coordinates
+}
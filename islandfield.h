@@ -0,0 +1,150 @@
+#ifndef ISLANDFIELD_H
+#define ISLANDFIELD_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+struct IslandFieldSettings
+{
+    unsigned int seed = 1;
+    float chunkSize = 64.0f;        // world units per chunk side
+    int viewRadius = 2;             // chunks kept around the camera in every direction
+    float minAltitude = -20.0f;
+    float maxAltitude = 40.0f;
+    float clearRadius = 30.0f;      // no generated islands this close to the hand-placed ones at the origin
+
+    // equal when every chunk comes out the same; viewRadius only changes
+    // which chunks are kept, so it is left out
+    bool operator==(const IslandFieldSettings& other) const
+    {
+        return seed == other.seed && chunkSize == other.chunkSize
+            && minAltitude == other.minAltitude && maxAltitude == other.maxAltitude && clearRadius == other.clearRadius;
+    }
+    bool operator!=(const IslandFieldSettings& other) const { return !(*this == other); }
+};
+
+// One chunk's islands, baked into world space and grouped by texture
+// (the same x, y, z, u, v layout as the hand-placed islands).
+struct IslandChunkMesh
+{
+    std::vector<float> vertices;
+    int first[4] = {};      // first vertex of each texture group
+    int count[4] = {};
+    int islands = 0;
+};
+
+// Procedural islands for an endless sky. The XZ plane is cut into square
+// chunks; each chunk's islands (how many, where, how big, how turned, and
+// how their corners are pushed around) come only from a hash of the seed and
+// the chunk coordinates, so a chunk looks the same every time it is
+// generated and can be built on any thread. Every island is a copy of the
+// base island mesh, so a chunk never holds more than MAX_VERTICES vertices.
+// No GL calls here.
+class IslandField
+{
+public:
+    static const int GROUPS = 4;                // texture groups of the base mesh
+    static const int MAX_ISLANDS = 4;           // per chunk
+    static const int BASE_VERTICES = 84;
+    static const int MAX_VERTICES = MAX_ISLANDS * BASE_VERTICES;
+    static const int STRIDE = 5;                // floats per vertex
+
+    // chunk coordinates packed into one key
+    static uint64_t key(int cx, int cz) { return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cz; }
+
+    // mesh: BASE_VERTICES vertices of STRIDE floats; groupEnds: last vertex (exclusive) of each group
+    static void generate(const IslandFieldSettings& settings, int cx, int cz, const float* mesh, const int groupEnds[GROUPS],
+        IslandChunkMesh& out)
+    {
+        Random random(hash(settings.seed, (uint32_t)cx, (uint32_t)cz));
+        glm::mat4 models[MAX_ISLANDS];
+        uint32_t shapes[MAX_ISLANDS];
+        int wanted = (int)(random.next() % (MAX_ISLANDS + 1));
+        out.islands = 0;
+        for (int i = 0; i < wanted; i++)
+        {
+            glm::vec3 position((cx + random.unit()) * settings.chunkSize,
+                settings.minAltitude + random.unit() * (settings.maxAltitude - settings.minAltitude),
+                (cz + random.unit()) * settings.chunkSize);
+            float scale = 1.0f + random.unit() * 2.0f;
+            glm::vec3 axis(random.unit() - 0.5f, random.unit() - 0.5f + 2.0f, random.unit() - 0.5f); // mostly upright
+            float angle = random.unit() * 6.2831853f;
+            uint32_t shape = random.next();
+            if (glm::length(glm::vec2(position.x, position.z)) < settings.clearRadius)
+                continue;
+
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+            model = glm::rotate(model, angle, glm::normalize(axis));
+            models[out.islands] = glm::scale(model, glm::vec3(scale));
+            shapes[out.islands] = shape;
+            out.islands++;
+        }
+
+        out.vertices.resize((size_t)out.islands * BASE_VERTICES * STRIDE);
+        float* write = out.vertices.data();
+        int groupStart = 0;
+        for (int g = 0; g < GROUPS; g++)
+        {
+            out.first[g] = (int)((write - out.vertices.data()) / STRIDE);
+            for (int i = 0; i < out.islands; i++)
+            {
+                for (int v = groupStart; v < groupEnds[g]; v++)
+                {
+                    const float* in = mesh + v * STRIDE;
+                    glm::vec3 p(in[0], in[1], in[2]);
+                    glm::vec3 world(models[i] * glm::vec4(p + jitter(shapes[i], p), 1.0f));
+                    *write++ = world.x;
+                    *write++ = world.y;
+                    *write++ = world.z;
+                    *write++ = in[3];
+                    *write++ = in[4];
+                }
+            }
+            out.count[g] = (int)((write - out.vertices.data()) / STRIDE) - out.first[g];
+            groupStart = groupEnds[g];
+        }
+    }
+
+private:
+    struct Random
+    {
+        uint32_t state;
+        explicit Random(uint32_t seed) : state(seed) {}
+        uint32_t next()
+        {
+            state = state * 1664525u + 1013904223u;
+            return hash(state, 0x9e3779b9u, 0x85ebca6bu);
+        }
+        float unit() { return (next() >> 8) * (1.0f / 16777216.0f); }
+    };
+
+    static uint32_t hash(uint32_t a, uint32_t b, uint32_t c)
+    {
+        uint32_t h = a * 0x27d4eb2du ^ (b + 0x165667b1u) * 0x85ebca77u ^ (c + 0x61c88647u) * 0xc2b2ae3du;
+        h ^= h >> 15;
+        h *= 0x2c1b3c6du;
+        h ^= h >> 12;
+        h *= 0x297a2d39u;
+        h ^= h >> 15;
+        return h;
+    }
+
+    // corners are moved by a hash of where they are, so the copies of a
+    // corner on different faces move together and the mesh stays closed
+    static glm::vec3 jitter(uint32_t shape, const glm::vec3& p)
+    {
+        uint32_t x = (uint32_t)(int32_t)std::lround(p.x * 1000.0f);
+        uint32_t y = (uint32_t)(int32_t)std::lround(p.y * 1000.0f);
+        uint32_t z = (uint32_t)(int32_t)std::lround(p.z * 1000.0f);
+        uint32_t h = hash(shape ^ x, y, z);
+        glm::vec3 offset((h & 1023u) / 1023.0f - 0.5f, ((h >> 10) & 1023u) / 1023.0f - 0.5f, ((h >> 20) & 1023u) / 1023.0f - 0.5f);
+        return offset * 0.6f;
+    }
+};
+
+// ISLANDFIELD_H
+#endif
@@ -0,0 +1,319 @@
+#ifndef ISLANDSTREAMER_H
+#define ISLANDSTREAMER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "islandfield.h"
+#include "jobsystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+struct IslandStreamStats
+{
+    int resident = 0;           // chunks with a GPU slot (in range or cached)
+    int drawn = 0;              // chunks in range and uploaded
+    int pending = 0;            // being generated on the workers
+    int generated = 0;          // since startup
+    int evicted = 0;
+    int uploads = 0;            // this frame
+    double worstGenerateMs = 0.0;
+    size_t gpuBytes = 0;
+};
+
+// Streams IslandField chunks around the camera. Chunks in range are
+// generated on JobSystem workers, nearest first, and the main thread only
+// ever copies finished ones into the GPU: at most MAX_UPLOADS_PER_FRAME per
+// frame, into fixed slots of one preallocated vertex buffer, so crossing a
+// chunk border never allocates or waits. Chunks that leave the range keep
+// their slot until it is needed again (least recently used goes first).
+class IslandStreamer
+{
+public:
+    static const int SLOTS = 128;
+    static const int MAX_VIEW_RADIUS = 5;       // (2 * 5 + 1)^2 = 121 chunks fit in the slots
+    static const int MAX_IN_FLIGHT = 8;         // chunks queued or generating at once
+    static const int MAX_UPLOADS_PER_FRAME = 2;
+
+    // mesh: the base island (IslandField::BASE_VERTICES vertices of x, y, z, u, v);
+    // groupEnds: the last vertex (exclusive) of each texture group
+    void init(const float* mesh, const int groupEnds[IslandField::GROUPS])
+    {
+        m_Mesh = std::make_shared<std::vector<float>>(mesh, mesh + IslandField::BASE_VERTICES * IslandField::STRIDE);
+        for (int g = 0; g < IslandField::GROUPS; g++)
+            m_GroupEnds[g] = groupEnds[g];
+
+        glGenVertexArrays(1, &m_VAO);
+        glGenBuffers(1, &m_VBO);
+        glBindVertexArray(m_VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)SLOTS * SLOT_BYTES, nullptr, GL_DYNAMIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, IslandField::STRIDE * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, IslandField::STRIDE * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        m_FreeSlots.clear();
+        for (int slot = SLOTS - 1; slot >= 0; slot--)
+            m_FreeSlots.push_back(slot);
+        m_Stats.gpuBytes = (size_t)SLOTS * SLOT_BYTES;
+    }
+
+    // called on a worker whenever a chunk has finished generating, e.g. to end
+    // an idle wait for events so the chunk gets uploaded
+    void setOnChunkReady(std::function<void()> onReady) { m_OnChunkReady = std::move(onReady); }
+
+    // chunks still generating finish into memory nobody reads
+    void destroy()
+    {
+        m_Chunks.clear();
+        glDeleteBuffers(1, &m_VBO);
+        glDeleteVertexArrays(1, &m_VAO);
+    }
+
+    void update(const IslandFieldSettings& settings, const glm::vec3& camera)
+    {
+        if (settings != m_Settings)
+        {
+            // a different field: drop everything
+            for (auto& chunk : m_Chunks)
+            {
+                if (chunk.second.slot >= 0)
+                    m_FreeSlots.push_back(chunk.second.slot);
+            }
+            m_Chunks.clear();
+        }
+        // a new view radius keeps every chunk; it only moves the range below
+        m_Settings = settings;
+        m_Frame++;
+        m_Stats.uploads = 0;
+
+        int inFlight = 0;
+        for (auto& chunk : m_Chunks)
+        {
+            if (chunk.second.job && !chunk.second.job->done.load(std::memory_order_acquire))
+                inFlight++;
+        }
+
+        // every chunk in range, nearest first
+        int radius = std::max(0, std::min(settings.viewRadius, (int)MAX_VIEW_RADIUS));
+        int centerX = (int)std::floor(camera.x / settings.chunkSize);
+        int centerZ = (int)std::floor(camera.z / settings.chunkSize);
+        m_InRange.clear();
+        for (int dz = -radius; dz <= radius; dz++)
+        {
+            for (int dx = -radius; dx <= radius; dx++)
+                m_InRange.push_back({ dx * dx + dz * dz, centerX + dx, centerZ + dz });
+        }
+        std::sort(m_InRange.begin(), m_InRange.end(), [](const Nearby& a, const Nearby& b)
+        {
+            return a.distance != b.distance ? a.distance < b.distance : a.cz != b.cz ? a.cz < b.cz : a.cx < b.cx;
+        });
+
+        m_Visible.clear();
+        for (const Nearby& nearby : m_InRange)
+        {
+            Chunk& chunk = m_Chunks[IslandField::key(nearby.cx, nearby.cz)];
+            chunk.cx = nearby.cx;
+            chunk.cz = nearby.cz;
+            chunk.lastUsed = m_Frame;
+            if (chunk.slot < 0 && !chunk.job && inFlight < MAX_IN_FLIGHT)
+            {
+                launch(chunk);
+                inFlight++;
+            }
+            else if (chunk.slot < 0 && chunk.job && chunk.job->done.load(std::memory_order_acquire) && m_Stats.uploads < MAX_UPLOADS_PER_FRAME)
+            {
+                upload(chunk);
+            }
+            if (chunk.slot >= 0)
+                m_Visible.push_back(&chunk);
+        }
+
+        // forget chunks that left the range before they made it to the GPU
+        for (auto it = m_Chunks.begin(); it != m_Chunks.end();)
+        {
+            const Chunk& chunk = it->second;
+            bool generating = chunk.job && !chunk.job->done.load(std::memory_order_acquire);
+            if (chunk.lastUsed != m_Frame && chunk.slot < 0 && !generating)
+                it = m_Chunks.erase(it);
+            else
+                ++it;
+        }
+
+        // multi-draw lists per texture group
+        for (int g = 0; g < IslandField::GROUPS; g++)
+        {
+            m_Firsts[g].clear();
+            m_Counts[g].clear();
+            for (const Chunk* chunk : m_Visible)
+            {
+                m_Firsts[g].push_back(chunk->slot * IslandField::MAX_VERTICES + chunk->first[g]);
+                m_Counts[g].push_back(chunk->count[g]);
+            }
+        }
+
+        m_Stats.resident = SLOTS - (int)m_FreeSlots.size();
+        m_Stats.drawn = (int)m_Visible.size();
+        m_Stats.pending = inFlight;
+    }
+
+    // every chunk in range with one glMultiDrawArrays per texture group; the
+    // vertices are in world space (model = identity)
+    int draw(const unsigned int textures[IslandField::GROUPS]) const
+    {
+        if (m_Visible.empty())
+            return 0;
+        glBindVertexArray(m_VAO);
+        for (int g = 0; g < IslandField::GROUPS; g++)
+        {
+            glBindTexture(GL_TEXTURE_2D, textures[g]);
+            glMultiDrawArrays(GL_TRIANGLES, m_Firsts[g].data(), m_Counts[g].data(), (GLsizei)m_Visible.size());
+        }
+        glBindVertexArray(0);
+        return IslandField::GROUPS;
+    }
+
+    // chunks drawn this frame, for per-chunk passes like the shadow maps
+    int visibleChunks() const { return (int)m_Visible.size(); }
+    void chunkSphere(int i, glm::vec3& center, float& radius) const
+    {
+        const Chunk& chunk = *m_Visible[i];
+        float size = m_Settings.chunkSize;
+        center = glm::vec3((chunk.cx + 0.5f) * size, (m_Settings.minAltitude + m_Settings.maxAltitude) * 0.5f, (chunk.cz + 0.5f) * size);
+        // islands are placed inside the chunk but reach ISLAND_REACH beyond their center
+        radius = glm::length(glm::vec3(size * 0.5f + ISLAND_REACH, (m_Settings.maxAltitude - m_Settings.minAltitude) * 0.5f + ISLAND_REACH,
+            size * 0.5f + ISLAND_REACH));
+    }
+    void drawChunk(int i) const
+    {
+        const Chunk& chunk = *m_Visible[i];
+        glBindVertexArray(m_VAO);
+        glDrawArrays(GL_TRIANGLES, chunk.slot * IslandField::MAX_VERTICES, chunk.islands * IslandField::BASE_VERTICES);
+        glBindVertexArray(0);
+    }
+
+    const IslandStreamStats& stats() const { return m_Stats; }
+
+private:
+    static const int SLOT_BYTES = IslandField::MAX_VERTICES * IslandField::STRIDE * sizeof(float);
+    static constexpr float ISLAND_REACH = 12.0f; // largest scale (3) times the mesh reach (3.5), plus jitter
+
+    struct Job
+    {
+        std::atomic<bool> done{ false };
+        IslandChunkMesh mesh;
+        double ms = 0.0;
+    };
+
+    struct Chunk
+    {
+        int cx = 0;
+        int cz = 0;
+        int slot = -1;
+        std::shared_ptr<Job> job;   // until uploaded
+        uint64_t lastUsed = 0;
+        int first[IslandField::GROUPS] = {};
+        int count[IslandField::GROUPS] = {};
+        int islands = 0;
+    };
+
+    struct Nearby
+    {
+        int distance;
+        int cx;
+        int cz;
+    };
+
+    IslandFieldSettings m_Settings;
+    std::shared_ptr<std::vector<float>> m_Mesh;
+    int m_GroupEnds[IslandField::GROUPS] = {};
+    unsigned int m_VAO = 0;
+    unsigned int m_VBO = 0;
+    std::unordered_map<uint64_t, Chunk> m_Chunks;
+    std::vector<int> m_FreeSlots;
+    std::vector<Nearby> m_InRange;
+    std::vector<const Chunk*> m_Visible;
+    std::vector<GLint> m_Firsts[IslandField::GROUPS];
+    std::vector<GLsizei> m_Counts[IslandField::GROUPS];
+    uint64_t m_Frame = 0;
+    IslandStreamStats m_Stats;
+    std::function<void()> m_OnChunkReady;
+
+    void launch(Chunk& chunk)
+    {
+        std::shared_ptr<Job> job = std::make_shared<Job>();
+        chunk.job = job;
+        std::shared_ptr<std::vector<float>> mesh = m_Mesh;
+        IslandFieldSettings settings = m_Settings;
+        int cx = chunk.cx, cz = chunk.cz;
+        int groupEnds[IslandField::GROUPS];
+        std::copy(m_GroupEnds, m_GroupEnds + IslandField::GROUPS, groupEnds);
+        std::function<void()> onReady = m_OnChunkReady;
+        JobSystem::submit([job, mesh, settings, cx, cz, groupEnds, onReady]()
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            IslandField::generate(settings, cx, cz, mesh->data(), groupEnds, job->mesh);
+            job->ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            job->done.store(true, std::memory_order_release);
+            if (onReady)
+                onReady();
+        });
+    }
+
+    void upload(Chunk& chunk)
+    {
+        int slot = takeSlot();
+        if (slot < 0)
+            return;
+        const IslandChunkMesh& mesh = chunk.job->mesh;
+        if (!mesh.vertices.empty())
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)slot * SLOT_BYTES, mesh.vertices.size() * sizeof(float), mesh.vertices.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        std::copy(mesh.first, mesh.first + IslandField::GROUPS, chunk.first);
+        std::copy(mesh.count, mesh.count + IslandField::GROUPS, chunk.count);
+        chunk.islands = mesh.islands;
+        chunk.slot = slot;
+        m_Stats.generated++;
+        m_Stats.uploads++;
+        m_Stats.worstGenerateMs = std::max(m_Stats.worstGenerateMs, chunk.job->ms);
+        chunk.job.reset();
+    }
+
+    // a free slot, or the one of the least recently used chunk out of range
+    int takeSlot()
+    {
+        if (m_FreeSlots.empty())
+        {
+            auto oldest = m_Chunks.end();
+            for (auto it = m_Chunks.begin(); it != m_Chunks.end(); ++it)
+            {
+                if (it->second.slot >= 0 && it->second.lastUsed != m_Frame && (oldest == m_Chunks.end() || it->second.lastUsed < oldest->second.lastUsed))
+                    oldest = it;
+            }
+            if (oldest == m_Chunks.end())
+                return -1;
+            m_FreeSlots.push_back(oldest->second.slot);
+            m_Chunks.erase(oldest);
+            m_Stats.evicted++;
+        }
+        int slot = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+        return slot;
+    }
+};
+
+// ISLANDSTREAMER_H
+#endif
@@ -0,0 +1,159 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A small persistent pool of worker threads for data-parallel loops.
+// parallelFor splits [0, count) into chunks that workers (and the calling
+// thread) pull from a shared counter, and returns once every chunk is done.
+// Results must not depend on which thread ran a chunk, so callers write into
+// per-index slots and combine them afterwards in index order. parallelFor is
+// meant to be called from one thread (the render thread) at a time.
+//
+// submit() queues background tasks (streaming, generation) that idle workers
+// pick up in order; a parallelFor always goes first, and never waits for a
+// worker that is busy with a task. There is always at least one worker so
+// tasks never run on the render thread.
+class JobSystem
+{
+public:
+    // fn(begin, end) is called for disjoint ranges covering [0, count)
+    static void parallelFor(int count, int chunkSize, const std::function<void(int, int)>& fn)
+    {
+        if (count <= 0)
+            return;
+        chunkSize = std::max(1, chunkSize);
+        JobSystem& jobs = instance();
+        if (jobs.m_LoopWorkers == 0 || count <= chunkSize)
+        {
+            fn(0, count);
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(jobs.m_Mutex);
+        jobs.m_Job = &fn;
+        jobs.m_Count = count;
+        jobs.m_ChunkSize = chunkSize;
+        jobs.m_Next = 0;
+        jobs.m_Generation++;
+        lock.unlock();
+        jobs.m_Wake.notify_all();
+
+        // once every chunk is claimed, close the job to late workers and wait
+        // for the ones that joined
+        jobs.runChunks(fn);
+
+        lock.lock();
+        jobs.m_Job = nullptr;
+        jobs.m_Done.wait(lock, [&jobs]() { return jobs.m_Busy == 0; });
+    }
+
+    // run task on a worker some time later
+    static void submit(std::function<void()> task)
+    {
+        JobSystem& jobs = instance();
+        {
+            std::lock_guard<std::mutex> lock(jobs.m_Mutex);
+            jobs.m_Tasks.push_back(std::move(task));
+        }
+        jobs.m_Wake.notify_one();
+    }
+
+    // workers that take parallelFor chunks (background tasks always have one)
+    static int workerCount() { return instance().m_LoopWorkers; }
+
+private:
+    std::vector<std::thread> m_Workers;
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::condition_variable m_Done;
+    const std::function<void(int, int)>* m_Job = nullptr;
+    int m_Count = 0;
+    int m_ChunkSize = 1;
+    std::atomic<int> m_Next{ 0 };
+    int m_Busy = 0;             // workers inside the current parallelFor
+    unsigned int m_Generation = 0;
+    int m_LoopWorkers = 0;
+    std::deque<std::function<void()>> m_Tasks;
+    bool m_Quit = false;
+
+    JobSystem()
+    {
+        // leave one core for the render thread, which also takes chunks
+        unsigned int cores = std::thread::hardware_concurrency();
+        unsigned int workers = cores > 1 ? std::min(cores - 1, 7u) : 0;
+        m_LoopWorkers = (int)workers;
+        for (unsigned int i = 0; i < std::max(workers, 1u); i++)
+            m_Workers.emplace_back([this]() { workerLoop(); });
+    }
+
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Quit = true;
+        }
+        m_Wake.notify_all();
+        for (std::thread& worker : m_Workers)
+            worker.join();
+    }
+
+    static JobSystem& instance()
+    {
+        static JobSystem jobs;
+        return jobs;
+    }
+
+    void runChunks(const std::function<void(int, int)>& fn)
+    {
+        for (;;)
+        {
+            int begin = m_Next.fetch_add(m_ChunkSize);
+            if (begin >= m_Count)
+                break;
+            fn(begin, std::min(begin + m_ChunkSize, m_Count));
+        }
+    }
+
+    void workerLoop()
+    {
+        unsigned int seen = 0;
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        for (;;)
+        {
+            bool loop = m_LoopWorkers > 0;
+            m_Wake.wait(lock, [&]() { return m_Quit || (loop && m_Job && m_Generation != seen) || !m_Tasks.empty(); });
+            if (m_Quit)
+                return;
+
+            if (loop && m_Job && m_Generation != seen)
+            {
+                seen = m_Generation;
+                m_Busy++;
+                const std::function<void(int, int)>& job = *m_Job;
+                lock.unlock();
+                runChunks(job);
+                lock.lock();
+                if (--m_Busy == 0)
+                    m_Done.notify_one();
+                continue;
+            }
+
+            std::function<void()> task = std::move(m_Tasks.front());
+            m_Tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+};
+
+// JOBSYSTEM_H
+#endif
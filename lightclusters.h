@@ -0,0 +1,290 @@
+#ifndef LIGHTCLUSTERS_H
+#define LIGHTCLUSTERS_H
+
+#include <glm/glm.hpp>
+
+#include "jobsystem.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LIGHTCLUSTERS_SSE 1
+#endif
+
+struct PointLight
+{
+    glm::vec3 position;
+    float radius;       // the light contributes nothing beyond this distance
+    glm::vec3 color;
+    float intensity;
+};
+
+struct LightClusterStats
+{
+    int clusters = 0;
+    int lights = 0;
+    int indexCount = 0;       // total light references over all clusters
+    int maxPerCluster = 0;
+    double buildMs = 0.0;
+};
+
+// CPU light binning for clustered forward shading. The view frustum is cut
+// into tilesX * tilesY screen tiles and `slices` exponentially spaced depth
+// slices ("froxels"); every point light is assigned to each cluster its
+// sphere touches (tested against the cluster's view-space AABB). Slices are
+// binned in parallel, four lights per SIMD test. No GL calls here, so the
+// results can be checked on the CPU.
+//
+// Output layout (what the shader reads):
+//   clusterRanges()[2 * c + 0]  first entry in lightIndices() for cluster c
+//   clusterRanges()[2 * c + 1]  number of lights in cluster c
+// The first entries are the running sum of the counts, so lightIndices() is
+// exactly as long as all clusters' lists together and no cluster is capped.
+//   cluster c = (slice * tilesY + tileY) * tilesX + tileX, tileY counted from the bottom
+class LightClusterGrid
+{
+public:
+    LightClusterGrid(int tilesX = 16, int tilesY = 9, int slices = 24)
+        : m_TilesX(tilesX), m_TilesY(tilesY), m_Slices(slices)
+    {
+    }
+
+    int tilesX() const { return m_TilesX; }
+    int tilesY() const { return m_TilesY; }
+    int slices() const { return m_Slices; }
+    int clusterCount() const { return m_TilesX * m_TilesY * m_Slices; }
+
+    // slice = floor(log(depth) * scale + bias); depth is the positive view-space distance
+    float sliceScale() const { return m_SliceScale; }
+    float sliceBias() const { return m_SliceBias; }
+
+    // depths in front of the near plane (and NaN) go to the first slice, past
+    // the far plane to the last; clamped before the log and the cast
+    int sliceForDepth(float depth) const
+    {
+        float nearest = m_Near > 0.0f ? m_Near : 1e-6f;
+        if (!(depth > nearest))
+            depth = nearest;
+        float slice = std::floor(std::log(depth) * m_SliceScale + m_SliceBias);
+        if (!(slice > 0.0f))
+            return 0;
+        return slice >= (float)(m_Slices - 1) ? m_Slices - 1 : (int)slice;
+    }
+
+    const std::vector<uint32_t>& clusterRanges() const { return m_Ranges; }
+    const std::vector<uint32_t>& lightIndices() const { return m_Indices; }
+    const LightClusterStats& stats() const { return m_Stats; }
+
+    void clusterBounds(int cluster, glm::vec3& boundsMin, glm::vec3& boundsMax) const
+    {
+        boundsMin = m_BoundsMin[cluster];
+        boundsMax = m_BoundsMax[cluster];
+    }
+
+    void build(const glm::mat4& view, const glm::mat4& projection, float zNear, float zFar, const std::vector<PointLight>& lights)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (projection != m_Projection || zNear != m_Near || zFar != m_Far || m_BoundsMin.empty())
+            computeBounds(projection, zNear, zFar);
+
+        // lights to view space, structure-of-arrays and padded to a multiple of
+        // four with lights that can't touch anything
+        size_t padded = (lights.size() + 3) & ~(size_t)3;
+        m_X.assign(padded, 1e30f);
+        m_Y.assign(padded, 0.0f);
+        m_Z.assign(padded, 0.0f);
+        m_R.assign(padded, 0.0f);
+        for (size_t i = 0; i < lights.size(); i++)
+        {
+            glm::vec4 p = view * glm::vec4(lights[i].position, 1.0f);
+            m_X[i] = p.x;
+            m_Y[i] = p.y;
+            m_Z[i] = p.z;
+            m_R[i] = lights[i].radius;
+        }
+
+        m_SliceResults.resize(m_Slices);
+        JobSystem::parallelFor(m_Slices, 1, [this, &lights](int begin, int end) {
+            for (int slice = begin; slice < end; slice++)
+                binSlice(slice, (int)lights.size(), m_SliceResults[slice]);
+        });
+
+        // stitch the per-slice lists together in slice order (deterministic)
+        m_Ranges.assign((size_t)clusterCount() * 2, 0);
+        m_Indices.clear();
+        m_Stats = LightClusterStats();
+        int perSlice = m_TilesX * m_TilesY;
+        for (int slice = 0; slice < m_Slices; slice++)
+        {
+            const SliceResult& result = m_SliceResults[slice];
+            uint32_t base = (uint32_t)m_Indices.size();
+            m_Indices.insert(m_Indices.end(), result.indices.begin(), result.indices.end());
+            for (int i = 0; i < perSlice; i++)
+            {
+                size_t cluster = (size_t)slice * perSlice + i;
+                m_Ranges[cluster * 2] = base + result.ranges[i * 2];
+                m_Ranges[cluster * 2 + 1] = result.ranges[i * 2 + 1];
+                if ((int)result.ranges[i * 2 + 1] > m_Stats.maxPerCluster)
+                    m_Stats.maxPerCluster = (int)result.ranges[i * 2 + 1];
+            }
+        }
+        m_Stats.clusters = clusterCount();
+        m_Stats.lights = (int)lights.size();
+        m_Stats.indexCount = (int)m_Indices.size();
+        m_Stats.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // scalar sphere/AABB test; the non-SIMD path and the reference for checking the SIMD one
+    static bool sphereTouchesBox(const glm::vec3& center, float radius, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+    {
+        glm::vec3 d = glm::max(glm::max(boundsMin - center, center - boundsMax), glm::vec3(0.0f));
+        return glm::dot(d, d) <= radius * radius;
+    }
+
+private:
+    struct SliceResult
+    {
+        std::vector<uint32_t> ranges;     // local offset/count pairs for the slice's clusters
+        std::vector<uint32_t> indices;
+        std::vector<uint32_t> candidates; // lights overlapping the slice's depth range
+        std::vector<float> cx, cy, cz, cr;
+    };
+
+    int m_TilesX, m_TilesY, m_Slices;
+    glm::mat4 m_Projection = glm::mat4(0.0f);
+    float m_Near = 0.0f, m_Far = 0.0f;
+    float m_SliceScale = 0.0f, m_SliceBias = 0.0f;
+    std::vector<glm::vec3> m_BoundsMin, m_BoundsMax;
+    std::vector<float> m_X, m_Y, m_Z, m_R;
+    std::vector<SliceResult> m_SliceResults;
+    std::vector<uint32_t> m_Ranges;
+    std::vector<uint32_t> m_Indices;
+    LightClusterStats m_Stats;
+
+    float sliceDepth(int slice) const
+    {
+        return m_Near * std::pow(m_Far / m_Near, (float)slice / m_Slices);
+    }
+
+    // view-space AABBs of every froxel; only depends on the projection
+    void computeBounds(const glm::mat4& projection, float zNear, float zFar)
+    {
+        m_Projection = projection;
+        m_Near = zNear;
+        m_Far = zFar;
+        m_SliceScale = m_Slices / std::log(zFar / zNear);
+        m_SliceBias = -m_Slices * std::log(zNear) / std::log(zFar / zNear);
+
+        glm::mat4 inverse = glm::inverse(projection);
+        m_BoundsMin.resize(clusterCount());
+        m_BoundsMax.resize(clusterCount());
+        for (int slice = 0; slice < m_Slices; slice++)
+        {
+            float depths[2] = { sliceDepth(slice), sliceDepth(slice + 1) };
+            for (int ty = 0; ty < m_TilesY; ty++)
+            {
+                for (int tx = 0; tx < m_TilesX; tx++)
+                {
+                    glm::vec3 lo(1e30f), hi(-1e30f);
+                    for (int corner = 0; corner < 4; corner++)
+                    {
+                        float ndcX = -1.0f + 2.0f * (tx + (corner & 1)) / m_TilesX;
+                        float ndcY = -1.0f + 2.0f * (ty + (corner >> 1)) / m_TilesY;
+                        glm::vec4 onNear = inverse * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+                        glm::vec3 ray = glm::vec3(onNear) / onNear.w;
+                        for (float depth : depths)
+                        {
+                            glm::vec3 point = ray * (depth / -ray.z);
+                            lo = glm::min(lo, point);
+                            hi = glm::max(hi, point);
+                        }
+                    }
+                    int cluster = (slice * m_TilesY + ty) * m_TilesX + tx;
+                    m_BoundsMin[cluster] = lo;
+                    m_BoundsMax[cluster] = hi;
+                }
+            }
+        }
+    }
+
+    void binSlice(int slice, int lightCount, SliceResult& result) const
+    {
+        // 1. keep only lights whose sphere reaches into this slice's depth range
+        float nearDepth = sliceDepth(slice), farDepth = sliceDepth(slice + 1);
+        result.candidates.clear();
+        for (int i = 0; i < lightCount; i++)
+        {
+            float depth = -m_Z[i];
+            if (depth + m_R[i] >= nearDepth && depth - m_R[i] <= farDepth)
+                result.candidates.push_back((uint32_t)i);
+        }
+        size_t padded = (result.candidates.size() + 3) & ~(size_t)3;
+        result.cx.assign(padded, 1e30f);
+        result.cy.assign(padded, 0.0f);
+        result.cz.assign(padded, 0.0f);
+        result.cr.assign(padded, 0.0f);
+        for (size_t i = 0; i < result.candidates.size(); i++)
+        {
+            uint32_t light = result.candidates[i];
+            result.cx[i] = m_X[light];
+            result.cy[i] = m_Y[light];
+            result.cz[i] = m_Z[light];
+            result.cr[i] = m_R[light];
+        }
+
+        // 2. test the candidates against every cluster in the slice
+        int perSlice = m_TilesX * m_TilesY;
+        result.ranges.assign((size_t)perSlice * 2, 0);
+        result.indices.clear();
+        for (int i = 0; i < perSlice; i++)
+        {
+            int cluster = slice * perSlice + i;
+            uint32_t offset = (uint32_t)result.indices.size();
+            uint32_t count = 0;
+            const glm::vec3& lo = m_BoundsMin[cluster];
+            const glm::vec3& hi = m_BoundsMax[cluster];
+#ifdef LIGHTCLUSTERS_SSE
+            __m128 minX = _mm_set1_ps(lo.x), minY = _mm_set1_ps(lo.y), minZ = _mm_set1_ps(lo.z);
+            __m128 maxX = _mm_set1_ps(hi.x), maxY = _mm_set1_ps(hi.y), maxZ = _mm_set1_ps(hi.z);
+            __m128 zero = _mm_setzero_ps();
+            for (size_t l = 0; l < padded; l += 4)
+            {
+                __m128 x = _mm_loadu_ps(&result.cx[l]);
+                __m128 y = _mm_loadu_ps(&result.cy[l]);
+                __m128 z = _mm_loadu_ps(&result.cz[l]);
+                __m128 r = _mm_loadu_ps(&result.cr[l]);
+                __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minX, x), _mm_sub_ps(x, maxX)), zero);
+                __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minY, y), _mm_sub_ps(y, maxY)), zero);
+                __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minZ, z), _mm_sub_ps(z, maxZ)), zero);
+                __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                int mask = _mm_movemask_ps(_mm_cmple_ps(distance2, _mm_mul_ps(r, r)));
+                for (int lane = 0; mask && lane < 4; lane++, mask >>= 1)
+                {
+                    if (!(mask & 1))
+                        continue;
+                    result.indices.push_back(result.candidates[l + lane]);
+                    count++;
+                }
+            }
+#else
+            for (size_t l = 0; l < result.candidates.size(); l++)
+            {
+                if (sphereTouchesBox(glm::vec3(result.cx[l], result.cy[l], result.cz[l]), result.cr[l], lo, hi))
+                {
+                    result.indices.push_back(result.candidates[l]);
+                    count++;
+                }
+            }
+#endif
+            result.ranges[i * 2] = offset;
+            result.ranges[i * 2 + 1] = count;
+        }
+    }
+};
+
+// LIGHTCLUSTERS_H
+#endif
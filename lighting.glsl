@@ -0,0 +1,50 @@
+#pragma once
+// Clustered forward lighting (see clusteredlighting.h for the buffer layout).
+// Each fragment finds its cluster from its screen tile and view-space depth
+// and only loops over the point lights binned into that cluster. The sun is
+// a directional light with cascaded shadows.
+
+#include "shadows.glsl"
+
+uniform samplerBuffer lightData;        // 2 texels per light: position.xyz + radius, color * intensity
+uniform usamplerBuffer clusterData;     // per cluster: first light index, light count
+uniform usamplerBuffer lightIndexData;
+uniform ivec3 clusterGrid;              // tiles x, tiles y, depth slices
+uniform vec2 clusterDepth;              // slice = log(depth) * x + y
+uniform vec2 viewportSize;
+uniform vec3 viewPos;
+uniform vec3 ambientLight;
+uniform vec3 sunDirection;              // towards the sun
+uniform vec3 sunColor;                  // black when the sun is off
+uniform mat4 view;
+
+vec3 clusteredLighting(vec3 worldPos, vec3 albedo)
+{
+    // the meshes carry no normals, so use the face normal, turned towards the camera
+    vec3 normal = normalize(cross(dFdx(worldPos), dFdy(worldPos)));
+    if (dot(normal, viewPos - worldPos) < 0.0)
+        normal = -normal;
+
+    float depth = -(view * vec4(worldPos, 1.0)).z;
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / viewportSize * vec2(clusterGrid.xy)), ivec2(0), clusterGrid.xy - 1);
+    int slice = clamp(int(floor(log(max(depth, 1e-4)) * clusterDepth.x + clusterDepth.y)), 0, clusterGrid.z - 1);
+    int cluster = (slice * clusterGrid.y + tile.y) * clusterGrid.x + tile.x;
+
+    uvec2 range = texelFetch(clusterData, cluster).xy;
+    vec3 light = ambientLight;
+    if (sunColor != vec3(0.0))
+        light += sunColor * max(dot(normal, sunDirection), 0.0) * sunShadow(worldPos, normal, depth);
+
+    for (uint i = 0u; i < range.y; i++)
+    {
+        int index = int(texelFetch(lightIndexData, int(range.x + i)).x);
+        vec4 positionRadius = texelFetch(lightData, index * 2);
+        vec3 color = texelFetch(lightData, index * 2 + 1).rgb;
+
+        vec3 toLight = positionRadius.xyz - worldPos;
+        float distance = length(toLight);
+        float falloff = clamp(1.0 - distance / positionRadius.w, 0.0, 1.0);
+        light += color * (falloff * falloff) * max(dot(normal, toLight / max(distance, 1e-4)), 0.0);
+    }
+    return albedo * light;
+}
@@ -9,8 +9,23 @@
 
 // Helper functions
 #include "shader_m.h"
+#include "shaderlibrary.h"
+#include "shaderreload.h"
+#include "clusteredlighting.h"
+#include "cascadedshadows.h"
+#include "gpuculling.h"
+#include "occlusionculler.h"
+#include "transformbatch.h"
+#include "terrain.h"
+#include "islandstreamer.h"
+#include "redrawgate.h"
+#include "retainedwindow.h"
+#include "fontatlascache.h"
+#include "sdffont.h"
+#include "plotlod.h"
 #include "camera.h"
 #include "filesystem.h"
+#include "vfs.h"
 
 // Polyhedrons
 #include "cube.h"
@@ -20,6 +35,7 @@
 
 // Built-in libraries
 #include <iostream>
+#include <map>
 #include <vector>
 
 // GLM
@@ -35,7 +51,12 @@ void loadTexture(unsigned int& textureName, const std::string& path);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+void window_refresh_callback(GLFWwindow* window);
 void processInput(GLFWwindow* window);
+void scatterLights(std::vector<PointLight>& lights, unsigned int seed, const TerrainChunks& ground);
+void meshBounds(const BaseShape& shape, glm::vec3& boxMin, glm::vec3& boxMax);
 
 // settings
 const unsigned int SCR_WIDTH = 1600;
@@ -50,6 +71,11 @@ bool firstMouse = true;
 // timing
 float deltaTime = 0.0f;	// time between current frame and last frame
 float lastFrame = 0.0f;
+// every drawn frame's time in ms, plotted in Global Settings (see plotlod.h)
+PlotLod frameTimes;
+const int FRAME_TIME_LOG_MAX = 1 << 22;     // about 19 hours at 60 fps; the log starts over when full
+int frameTimesShown = 36000;
+int frameTimesBack = 0;
 
 bool guiMode = false; // Start in simulation mode
 
@@ -62,29 +88,117 @@ bool showGlobalSettings = false;
 // Baseplate settings
 bool showBaseplate = false;                  
 float baseplateSize = 125.0f;               // Default size (250x250)
-// A 1x1 square centered at (0,0):
-float baseplateVertices[] = {
-    -0.5f, 0.0f, -0.5f,  // Bottom-left
-     0.5f, 0.0f, -0.5f,  // Bottom-right
-     0.5f, 0.0f,  0.5f,  // Top-right
-    -0.5f, 0.0f,  0.5f   // Top-left
-};
-
 float baseplateColor[3] = { 0.1f, 0.5f, 0.1f }; // Default color (green)
 glm::vec3 baseplatePosition(0.0f, 0.0f, 0.0f); // Default position (origin)
+// The baseplate is heightmap terrain (see terrainchunks.h)
+float terrainHeight = 12.0f;        // from the lowest to the highest point
+float terrainFeatures = 4.0f;       // roughly the number of hills across
+unsigned int terrainSeed = 1;
+float terrainLodDistance = 2.0f;    // full detail within this many chunk widths
+
+// Lighting settings (ambient 1 and no point lights looks like the unlit scene)
+float ambientLight = 1.0f;
+int lightCount = 0;
+float lightRadius = 6.0f;
+float lightIntensity = 1.0f;
+unsigned int lightSeed = 1;
+std::vector<PointLight> g_Lights;
+
+// Sun settings (intensity 0 turns the sun and its shadow pass off)
+float sunIntensity = 0.0f;
+float sunAzimuth = 45.0f;   // degrees
+float sunElevation = 50.0f; // degrees
+float sunColor[3] = { 1.0f, 0.95f, 0.85f };
+ShadowSettings shadowSettings;
+uint64_t staticGeometryVersion = 0; // bumped when the baseplate or the placed shapes change
+
+// Shape rendering (the GPU-culled path needs a GL 4.3 context: run with --gpu-culling)
+bool gpuCullingEnabled = true;
+bool verifyGpuCulling = false;
+bool occlusionCulling = true;   // skip shapes hidden behind the islands or the baseplate
+
+// The Dear ImGui renderer: every window's draw list in one mapped upload per
+// frame, no GL state backed up around it (the render loop sets its own state
+// again every frame), windows whose contents did not change kept from the last
+// frame instead of built again (see retainedwindow.h), the font atlas baked
+// once and kept in the font cache (see fontatlascache.h) and uploaded as one
+// 8-bit channel, optionally a distance-field font that is sharp at any UI
+// scale (see sdffont.h), and extra windows to measure it with
+bool imguiSingleUpload = true;
+bool imguiTrustedState = true;
+bool imguiRetainedWindows = true;
+bool imguiAlpha8Font = true;
+bool imguiSdfFont = false;
+float imguiUiScale = 1.0f;
+int imguiStressWindows = 0;
+float imguiRenderMs = 0.0f;
+
+// Idle redraw: when nothing changes, the loop waits for events instead of
+// drawing the same frame again (see redrawgate.h)
+bool idleRedraw = true;
+bool spinCubes = true;
+unsigned int inputEvents = 0;   // counted by the GLFW callbacks
+
+// The endless island field around the hand-placed islands (see islandfield.h)
+bool streamIslands = true;
+IslandFieldSettings islandField;
 
 // A container of shape pointers
 std::vector<BaseShape*> g_Shapes;
 
+// Everything bundled into the asset pack (run with --build-pack to regenerate it)
+const char* ASSET_PACK = "assets.pak";
+const char* assetManifest[] = {
+    "vertex.vert", "fragment.frag", "baseplate.frag", "lighting.glsl", "shadows.glsl", "shadow.frag",
+    "culling.glsl", "cull.comp", "indirect.vert", "terrain.vert",
+    "resources/textures/dirt.png", "resources/textures/grass.jpg", "resources/textures/tree.jpg",
+    "resources/textures/leaf.jpg", "resources/textures/snow.jpg"
+};
+
 
-int main()
+int main(int argc, char** argv)
 {
+    // asset pack: build it from the loose files and exit, or map it if it exists
+    // -------------------------------------------------------------------------
+    if (argc > 1 && std::string(argv[1]) == "--build-pack")
+    {
+        std::vector<std::string> names, sources;
+        for (const char* asset : assetManifest)
+        {
+            names.push_back(asset);
+            sources.push_back(FileSystem::getPath(asset));
+        }
+        bool built = AssetPack::build(FileSystem::getPath(ASSET_PACK), names, sources);
+        std::cout << (built ? "Wrote " : "Failed to write ") << FileSystem::getPath(ASSET_PACK) << std::endl;
+        return built ? 0 : -1;
+    }
+    VFS::mount(FileSystem::getPath(ASSET_PACK)); // falls back to loose files during development
+
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
 
+    // --gpu-culling asks for GL 4.3 (compute shaders, multi-draw indirect);
+    // everything else only needs 3.3
+    bool wantGpuCulling = false;
+    // --flythrough flies a fixed path through the island field and reports the worst frame
+    bool flythrough = false;
+    // --cjk-font <ttf> merges a font's Chinese glyphs into the UI font
+    const char* cjkFont = nullptr;
+    // --sdf-font <ttf> is the distance-field UI font (the default font otherwise)
+    const char* sdfFontPath = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        wantGpuCulling |= std::string(argv[i]) == "--gpu-culling";
+        flythrough |= std::string(argv[i]) == "--flythrough";
+        if (std::string(argv[i]) == "--cjk-font" && i + 1 < argc)
+            cjkFont = argv[++i];
+        if (std::string(argv[i]) == "--sdf-font" && i + 1 < argc)
+            sdfFontPath = argv[++i];
+    }
+
     const char* glsl_version = "#version 330";
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, wantGpuCulling ? 4 : 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -95,6 +209,12 @@ int main()
     // glfw window creation
     // --------------------
     GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Demo", NULL, NULL);
+    if (window == NULL && wantGpuCulling)
+    {
+        std::cout << "No GL 4.3 context, falling back to 3.3 without GPU culling" << std::endl;
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Demo", NULL, NULL);
+    }
     if (window == NULL)
     {
         std::cout << "Failed to create GLFW window" << std::endl;
@@ -105,6 +225,9 @@ int main()
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
     // tell GLFW to capture our mouse
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -124,8 +247,25 @@ int main()
 
     // build and compile our shader program
     // ------------------------------------
-    Shader mainShader("vertex.vert", "fragment.frag");
-	Shader baseplateShader("baseplate.vert", "baseplate.frag");
+    // (programs share their compiled stages)
+    Shader& mainShader = ShaderLibrary::get("vertex.vert", "fragment.frag");
+    Shader& baseplateShader = ShaderLibrary::get("terrain.vert", "baseplate.frag");
+    Shader& shadowShader = ShaderLibrary::get("vertex.vert", "shadow.frag");
+    Shader& terrainShadowShader = ShaderLibrary::get("terrain.vert", "shadow.frag");
+    // shapes drawn from merged buffers with GPU culling, when the context allows it
+    GpuCulling gpuCulling;
+    Shader* indirectShader = nullptr;
+    if (wantGpuCulling && gpuCulling.init())
+        indirectShader = &ShaderLibrary::get("indirect.vert", "fragment.frag");
+    int gpuCullingMismatches = 0, gpuCullingVisible = 0;
+    OcclusionCuller occlusionCuller;
+    std::vector<unsigned char> shapeOccluded;
+    // the shapes' transforms, composed into model matrices once per frame
+    TransformArrays shapeTransforms;
+    std::vector<glm::mat4> shapeModels;
+    std::vector<glm::vec3> shapeLocalMin, shapeLocalMax, shapeWorldMin, shapeWorldMax;
+    ProgramCache::printStats();
+    ShaderLibrary::printStats();
 
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
@@ -272,6 +412,12 @@ int main()
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
+    // the streamed islands are copies of the same mesh, with the same texture groups
+    IslandStreamer islandStreamer;
+    const int islandGroups[IslandField::GROUPS] = { 18, 36, 66, 84 };
+    islandStreamer.init(vertices, islandGroups);
+    islandStreamer.setOnChunkReady([]() { glfwPostEmptyEvent(); }); // wakes an idle wait
+
 
     // load and create a texture 
     // -------------------------
@@ -282,15 +428,61 @@ int main()
     loadTexture(texture3, texturePath[2]);
     loadTexture(texture4, texturePath[3]);
     loadTexture(texture5, texturePath[4]);
+    VFS::printStats();
+
+    // tell opengl for each sampler to which texture unit it belongs to (once per linked program)
+    // ------------------------------------------------------------------------------------------
+    auto bindSamplers = [&mainShader]()
+    {
+        mainShader.use();
+        mainShader.setInt("texture1", 0);
+        mainShader.setInt("texture2", 1);
+        mainShader.setInt("texture3", 2);
+        mainShader.setInt("texture4", 3);
+        mainShader.setInt("texture5", 4);
+    };
+    bindSamplers();
+
+    // point lights are binned into view-frustum clusters every frame
+    ClusteredLighting clusteredLighting;
+    clusteredLighting.init();
+
+    // the sun's cascaded shadow maps
+    CascadedShadows cascadedShadows;
+    cascadedShadows.init();
+
+    // the baseplate's heightmap terrain
+    Terrain terrain;
+    terrain.init();
+    terrain.generate(terrainSeed, terrainFeatures);
+    std::vector<ShadowCaster> shadowCasters;
+
+    // the textured cubes spin in place at 12.5 degrees/s, each starting 20
+    // degrees further on; their rotations are quaternions advanced by an
+    // angular velocity every frame, so the trig happens only here
+    const int cubeCount = sizeof(cubePositions) / sizeof(cubePositions[0]);
+    TransformArrays cubeTransforms;
+    cubeTransforms.resize(cubeCount);
+    std::vector<float> cubeSpinX(cubeCount), cubeSpinY(cubeCount), cubeSpinZ(cubeCount);
+    std::vector<glm::mat4> cubeModels(cubeCount);
+    for (int i = 0; i < cubeCount; i++)
+    {
+        // the first object turns about Y, the others about a tilted axis
+        glm::vec3 axis = glm::normalize(i == 0 ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(10.0f, 20.0f, 5.0f));
+        cubeTransforms.set(i, cubePositions[i], glm::angleAxis(glm::radians(20.0f * i), axis), glm::vec3(1.0f));
+        glm::vec3 spin = axis * glm::radians(12.5f);
+        cubeSpinX[i] = spin.x;
+        cubeSpinY[i] = spin.y;
+        cubeSpinZ[i] = spin.z;
+    }
 
-    // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
-    // -------------------------------------------------------------------------------------------
-    mainShader.use();
-    mainShader.setInt("texture1", 0);
-    mainShader.setInt("texture2", 1);
-	mainShader.setInt("texture3", 2);
-	mainShader.setInt("texture4", 3);
-    mainShader.setInt("texture5", 4);
+    // hot reload the shaders while iterating on loose files (packs are immutable)
+    ShaderReloader shaderReloader;
+    if (!VFS::isPacked())
+    {
+        for (Shader* shader : ShaderLibrary::programs())
+            shaderReloader.watch(*shader);
+    }
 
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
@@ -302,89 +494,135 @@ int main()
 
     ImGui::StyleColorsDark();
 
+    // Fonts: the default one, plus the --cjk-font glyphs; the baked atlas comes
+    // from the font cache unless the fonts or their settings changed
+    io.Fonts->AddFontDefault();
+    if (cjkFont)
+    {
+        std::vector<char> fontData;
+        if (AssetPack::readWholeFile(cjkFont, fontData) && !fontData.empty())
+        {
+            ImFontConfig config;
+            config.MergeMode = true;
+            config.OversampleH = 1;
+            config.PixelSnapH = true;
+            void* data = IM_ALLOC(fontData.size()); // owned by the atlas
+            memcpy(data, fontData.data(), fontData.size());
+            io.Fonts->AddFontFromMemoryTTF(data, (int)fontData.size(), 13.0f, &config, io.Fonts->GetGlyphRangesChineseFull());
+        }
+        else
+        {
+            std::cout << "ERROR::FONT::FILE_NOT_SUCCESSFULLY_READ: " << cjkFont << std::endl;
+        }
+    }
+    FontAtlasCache::build(io.Fonts);
+    FontAtlasCache::printStats();
+
+    // The distance-field UI font, baked once (and cached) for every UI scale
+    ImFontAtlas sdfAtlas;
+    std::vector<char> sdfFontData;
+    if (sdfFontPath && !AssetPack::readWholeFile(sdfFontPath, sdfFontData))
+        std::cout << "ERROR::FONT::FILE_NOT_SUCCESSFULLY_READ: " << sdfFontPath << std::endl;
+    ImFont* sdfFont = sdfFontData.empty()
+        ? SdfFont::build(&sdfAtlas, io.Fonts->ConfigData[0].FontData, io.Fonts->ConfigData[0].FontDataSize, 13.0f)
+        : SdfFont::build(&sdfAtlas, sdfFontData.data(), (int)sdfFontData.size(), 13.0f);
+    if (sdfFont)
+        SdfFont::printStats();
+
     // Setup Platform/Renderer bindings
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init(glsl_version);
+    ImGui_ImplOpenGL3_SetFontTextureAlpha8(imguiAlpha8Font);
+    if (sdfFont && !ImGui_ImplOpenGL3_SetSdfFontAtlas(&sdfAtlas))
+        sdfFont = nullptr;
+    ImGui_ImplOpenGL3_SetSingleUpload(imguiSingleUpload);
+    ImGui_ImplOpenGL3_SetTrustedState(imguiTrustedState ? ImGui_ImplOpenGL3_TrustedState_All : ImGui_ImplOpenGL3_TrustedState_None);
+
+    // flythrough timing
+    float flythroughStart = -1.0f;
+    float worstFrame = 0.0f, totalFrames = 0.0f;
+    int flythroughFrames = 0;
+
+    RedrawGate redrawGate;
+    unsigned int inputEventsSeen = 0;
+    RetainedWindow modeToggleWindow;
+    std::vector<RetainedWindow> stressWindows;
+    int imguiWindowsBuilt = 0, imguiWindowsRetained = 0;
+    int shaderReloads = 0;
 
     // render loop
     while (!glfwWindowShouldClose(window))
     {
+        // nothing to draw: sleep until input, a streamed chunk or the timeout
+        if (idleRedraw && redrawGate.idle())
+        {
+            glfwWaitEventsTimeout(RedrawGate::IDLE_TIMEOUT);
+            lastFrame = static_cast<float>(glfwGetTime()); // waiting is not frame time
+        }
+
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-		glm::vec3 cameraPosition = camera.Position;
-
-        processInput(window);
-
-        glfwPollEvents();
-        glfwSetInputMode(window, GLFW_CURSOR, guiMode ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
-
-        glClearColor(bgColor[0], bgColor[1], bgColor[2], 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
+        if (spinCubes)
+        {
+            TransformBatch::integrateRotations(cubeTransforms, cubeSpinX.data(), cubeSpinY.data(), cubeSpinZ.data(), deltaTime);
+            TransformBatch::compose(cubeTransforms, cubeModels.data());
+        }
 
-        if (showBaseplate)
+        if (flythrough)
         {
-            unsigned int baseplateIndices[] = {
-                0, 1, 2, // First triangle
-                2, 3, 0  // Second triangle
-            };
-
-            // Static VAO/VBO/EBO
-            static unsigned int baseplateVAO = 0, baseplateVBO, baseplateEBO;
-            if (baseplateVAO == 0)
+            // a straight, slightly weaving line at 60 units/s; the first two
+            // seconds (startup, first chunks) are not counted
+            if (flythroughStart < 0.0f)
+                flythroughStart = currentFrame;
+            float t = currentFrame - flythroughStart;
+            camera.Position = glm::vec3(t * 42.0f, 10.0f + 8.0f * sin(t * 0.4f), t * 42.0f + 30.0f * sin(t * 0.25f));
+            camera.Yaw = 45.0f + 20.0f * sin(t * 0.3f);
+            camera.ProcessMouseMovement(0.0f, 0.0f);
+            if (t > 2.0f)
             {
-                glGenVertexArrays(1, &baseplateVAO);
-                glGenBuffers(1, &baseplateVBO);
-                glGenBuffers(1, &baseplateEBO);
-
-                glBindVertexArray(baseplateVAO);
-
-                glBindBuffer(GL_ARRAY_BUFFER, baseplateVBO);
-                glBufferData(GL_ARRAY_BUFFER, sizeof(baseplateVertices), baseplateVertices, GL_STATIC_DRAW);
-
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, baseplateEBO);
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(baseplateIndices), baseplateIndices, GL_STATIC_DRAW);
-
-                // Position attribute
-                glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-                glEnableVertexAttribArray(0);
+                worstFrame = std::max(worstFrame, deltaTime);
+                totalFrames += deltaTime;
+                flythroughFrames++;
             }
+            if (t > 32.0f)
+            {
+                const IslandStreamStats& streamed = islandStreamer.stats();
+                std::cout << "Flythrough: " << flythroughFrames << " frames, worst " << worstFrame * 1000.0f << " ms, average "
+                    << totalFrames * 1000.0f / std::max(flythroughFrames, 1) << " ms, " << streamed.generated << " chunks generated (worst "
+                    << streamed.worstGenerateMs << " ms), " << streamed.evicted << " evicted" << std::endl;
+                glfwSetWindowShouldClose(window, true);
+            }
+        }
 
-            // Render the baseplate
-            baseplateShader.use();
-
-            // Pass the camera matrices
-            glm::mat4 view = camera.GetViewMatrix();
-            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom),
-                (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f);
-            baseplateShader.setMat4("view", view);
-            baseplateShader.setMat4("projection", projection);
-
-            // ---------- Build/translate the model matrix ----------
-            // 1. Build the base (translation) part:
-            glm::mat4 baseplateModel = glm::mat4(1.0f);
-            baseplateModel = glm::translate(baseplateModel, baseplatePosition);
-
-            // 2. Scale in X and Z by baseplateSize
-            baseplateModel = glm::scale(baseplateModel, glm::vec3(baseplateSize, 1.0f, baseplateSize));
+		glm::vec3 cameraPosition = camera.Position;
 
-            baseplateShader.setMat4("model", baseplateModel);
+        processInput(window);
 
+        glfwPollEvents();
+        for (Shader* reloaded : shaderReloader.update())
+        {
+            shaderReloads++;
+            if (reloaded == &mainShader)
+                bindSamplers(); // a new program starts with default uniforms
+        }
+        glfwSetInputMode(window, GLFW_CURSOR, guiMode ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
 
-            // Set the baseplate color from the GUI color palette
-            baseplateShader.setVec3("baseplateColor", glm::vec3(baseplateColor[0], baseplateColor[1], baseplateColor[2]));
+        int display_w, display_h;
+        glfwGetFramebufferSize(window, &display_w, &display_h);
 
-            // Bind VAO and draw
-            glBindVertexArray(baseplateVAO);
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-            glBindVertexArray(0);
-        }
+        // island field chunks stream in around the camera
+        if (streamIslands)
+            islandStreamer.update(islandField, camera.Position);
 
         // Before starting ImGui's new frame in the main loop
         ImGui::GetIO().WantCaptureMouse = guiMode;
         ImGui::GetIO().WantCaptureKeyboard = guiMode;
+        // a new UI scale is only a font scale: no atlas is rebuilt, and the
+        // distance-field font stays sharp at it
+        ImGui::GetIO().FontGlobalScale = imguiUiScale;
+        ImGui::GetIO().FontDefault = imguiSdfFont && sdfFont ? sdfFont : nullptr;
 
         //std::cout << "WantCaptureMouse: " << ImGui::GetIO().WantCaptureMouse
         //    << ", WantCaptureKeyboard: " << ImGui::GetIO().WantCaptureKeyboard << std::endl;
@@ -397,28 +635,32 @@ int main()
 
         // Display the main window
         ImGui::SetNextWindowSize(ImVec2(400, 150), ImGuiCond_FirstUseEver);
-        ImGui::Begin("Mode Toggle");
-        ImGui::Text("Press Tab to toggle between GUI and Simulation");
-        if (guiMode)
-        {
-            ImGui::Text("Mode: GUI");
-        }
-        else
+        RedrawGate::Key modeToggleKey;
+        modeToggleKey.add(guiMode).add(cameraPosition).add(showGlobalSettings);
+        if (modeToggleWindow.begin("Mode Toggle", modeToggleKey.value, imguiRetainedWindows))
         {
-            ImGui::Text("Mode: Simulation");
-        }
+            ImGui::Text("Press Tab to toggle between GUI and Simulation");
+            if (guiMode)
+            {
+                ImGui::Text("Mode: GUI");
+            }
+            else
+            {
+                ImGui::Text("Mode: Simulation");
+            }
 
-        // Add camera coordinates
-        ImGui::Separator(); // Visual separator
-        ImGui::Text("Camera Coordinates: X: %.2f, Y: %.2f, Z: %.2f",
-            cameraPosition.x, cameraPosition.y, cameraPosition.z);
-        ImGui::Separator();
+            // Add camera coordinates
+            ImGui::Separator(); // Visual separator
+            ImGui::Text("Camera Coordinates: X: %.2f, Y: %.2f, Z: %.2f",
+                cameraPosition.x, cameraPosition.y, cameraPosition.z);
+            ImGui::Separator();
 
-        if (ImGui::Button(showGlobalSettings ? "Hide Global Settings" : "Show Global Settings"))
-        {
-            showGlobalSettings = !showGlobalSettings;
+            if (ImGui::Button(showGlobalSettings ? "Hide Global Settings" : "Show Global Settings"))
+            {
+                showGlobalSettings = !showGlobalSettings;
+            }
         }
-        ImGui::End();
+        modeToggleWindow.end();
 
         // Show Global Settings Window if toggled on
         if (showGlobalSettings)
@@ -433,20 +675,341 @@ int main()
             // Baseplate settings
             ImGui::Separator();
             ImGui::Text("Baseplate Settings");
-            ImGui::Checkbox("Show Baseplate", &showBaseplate);
-            ImGui::DragFloat("Baseplate Size", &baseplateSize, 1.0f, 1.0f, 1000.0f, "%.1f");
+            if (ImGui::Checkbox("Show Baseplate", &showBaseplate))
+                staticGeometryVersion++;
+            if (ImGui::DragFloat("Baseplate Size", &baseplateSize, 1.0f, 1.0f, 1000.0f, "%.1f"))
+                staticGeometryVersion++;
             ImGui::ColorEdit3("Baseplate Color", baseplateColor);
-            ImGui::DragFloat3("Baseplate Position", &baseplatePosition[0], 1.0f, -500.0f, 500.0f, "%.1f");
+            if (ImGui::DragFloat3("Baseplate Position", &baseplatePosition[0], 1.0f, -500.0f, 500.0f, "%.1f"))
+                staticGeometryVersion++;
+            if (ImGui::DragFloat("Terrain Height", &terrainHeight, 0.1f, 0.0f, 200.0f, "%.1f"))
+                staticGeometryVersion++;
+            bool terrainChanged = ImGui::DragFloat("Terrain Features", &terrainFeatures, 0.05f, 0.5f, 32.0f, "%.2f");
+            if (ImGui::Button("New Terrain"))
+            {
+                terrainSeed++;
+                terrainChanged = true;
+            }
+            if (terrainChanged)
+            {
+                terrain.generate(terrainSeed, terrainFeatures);
+                scatterLights(g_Lights, lightSeed, terrain.chunks());
+                staticGeometryVersion++;
+            }
+            ImGui::SliderFloat("Terrain LOD Distance", &terrainLodDistance, 0.5f, 8.0f, "%.1f chunks");
+            if (showBaseplate)
+                ImGui::Text("Terrain: %d triangles", terrain.chunks().triangles());
+
+            // Lighting settings
+            ImGui::Separator();
+            ImGui::Text("Lighting");
+            ImGui::SliderFloat("Ambient", &ambientLight, 0.0f, 1.0f, "%.2f");
+            bool lightsChanged = ImGui::SliderInt("Point Lights", &lightCount, 0, 4096);
+            lightsChanged |= ImGui::DragFloat("Light Radius", &lightRadius, 0.1f, 0.5f, 100.0f, "%.1f");
+            lightsChanged |= ImGui::DragFloat("Light Intensity", &lightIntensity, 0.05f, 0.0f, 20.0f, "%.2f");
+            if (ImGui::Button("Scatter Lights"))
+            {
+                lightSeed++;
+                lightsChanged = true;
+            }
+            if (lightsChanged)
+                scatterLights(g_Lights, lightSeed, terrain.chunks());
+            const LightClusterStats& clusterStats = clusteredLighting.grid().stats();
+            ImGui::Text("%d clusters, %d light refs, max %d per cluster",
+                clusterStats.clusters, clusterStats.indexCount, clusterStats.maxPerCluster);
+            ImGui::Text("Light binning: %.2f ms", clusterStats.buildMs);
+
+            // Sun and shadow settings
+            ImGui::Separator();
+            ImGui::Text("Sun & Shadows");
+            ImGui::SliderFloat("Sun Intensity", &sunIntensity, 0.0f, 3.0f, "%.2f");
+            ImGui::SliderFloat("Sun Azimuth", &sunAzimuth, 0.0f, 360.0f, "%.0f deg");
+            ImGui::SliderFloat("Sun Elevation", &sunElevation, 5.0f, 90.0f, "%.0f deg");
+            ImGui::ColorEdit3("Sun Color", sunColor);
+            ImGui::SliderInt("Cascades", &shadowSettings.cascades, 1, ShadowCascades::MAX_CASCADES);
+            ImGui::SliderInt("Cached Cascades", &shadowSettings.cachedCascades, 0, shadowSettings.cascades);
+            ImGui::DragFloat("Shadow Distance", &shadowSettings.distance, 1.0f, 10.0f, 1000.0f, "%.0f");
+            ImGui::SliderFloat("Split Lambda", &shadowSettings.splitLambda, 0.0f, 1.0f, "%.2f");
+            if (sunIntensity > 0.0f)
+            {
+                const ShadowCascades& cascades = cascadedShadows.cascades();
+                for (int i = 0; i < cascades.count(); i++)
+                {
+                    const ShadowPassStats& pass = cascadedShadows.stats(i);
+                    ImGui::Text("Cascade %d (to %.1f): %d casters, %d draws, %.3f ms%s", i, cascades.cascade(i).splitFar,
+                        pass.casters, pass.draws, pass.gpuMs, !cascades.cascade(i).cached ? "" : pass.staticRendered ? " (static redrawn)" : " (static cached)");
+                }
+            }
+
+            // Island field
+            ImGui::Separator();
+            ImGui::Text("Island Field");
+            ImGui::Checkbox("Stream Islands", &streamIslands);
+            ImGui::SliderInt("View Radius", &islandField.viewRadius, 1, IslandStreamer::MAX_VIEW_RADIUS, "%d chunks");
+            ImGui::DragFloat2("Altitude Range", &islandField.minAltitude, 0.5f, -200.0f, 200.0f, "%.1f");
+            if (ImGui::Button("New Field"))
+                islandField.seed++;
+            const IslandStreamStats& streamed = islandStreamer.stats();
+            ImGui::Text("%d chunks drawn, %d resident of %d, %d generating", streamed.drawn, streamed.resident, IslandStreamer::SLOTS,
+                streamed.pending);
+            ImGui::Text("%d generated (worst %.2f ms), %d evicted, %.1f KB of vertices", streamed.generated, streamed.worstGenerateMs,
+                streamed.evicted, streamed.gpuBytes / 1024.0f);
+
+            // Shape rendering path
+            ImGui::Separator();
+            ImGui::Text("Shapes (%d placed)", (int)g_Shapes.size());
+            if (indirectShader)
+            {
+                ImGui::Checkbox("GPU culling + multi-draw indirect", &gpuCullingEnabled);
+                ImGui::Checkbox("Check GPU commands against CPU", &verifyGpuCulling);
+                if (gpuCullingEnabled && verifyGpuCulling)
+                    ImGui::Text("%d visible, %d commands differ from the CPU mirror", gpuCullingVisible, gpuCullingMismatches);
+            }
+            else
+            {
+                ImGui::Text("GPU culling needs GL 4.3 (run with --gpu-culling)");
+            }
+            ImGui::Checkbox("Occlusion culling (islands, baseplate)", &occlusionCulling);
+            if (occlusionCulling)
+            {
+                const OcclusionStats& occlusion = occlusionCuller.stats();
+                ImGui::Text("%d of %d culled (%.0f%%), %d occluder triangles, %.2f ms", occlusion.culled, occlusion.tested,
+                    occlusion.culledFraction() * 100.0f, occlusion.occluderTriangles, occlusion.rasterMs);
+            }
+
+            // Idle redraw
+            ImGui::Separator();
+            ImGui::Text("Idle Redraw");
+            ImGui::Checkbox("Skip unchanged frames", &idleRedraw);
+            ImGui::Checkbox("Spin cubes", &spinCubes);
+            if (idleRedraw)
+            {
+                ImGui::Text("%d frames drawn, %d skipped", redrawGate.drawnFrames(), redrawGate.skippedFrames());
+                // on by default, and an animating scene is drawn every frame
+                if (spinCubes)
+                    ImGui::Text("Spinning cubes: every frame is drawn");
+            }
+
+            // Frame times: a min/max envelope per pixel, however many frames are shown
+            ImGui::Separator();
+            ImGui::Text("Frame Times");
+            {
+                int logged = frameTimes.size();
+                ImGui::SliderInt("Frames Shown", &frameTimesShown, 100, FRAME_TIME_LOG_MAX, "%d", ImGuiSliderFlags_Logarithmic);
+                int shown = std::min(frameTimesShown, logged);
+                ImGui::SliderInt("Frames Back", &frameTimesBack, 0, std::max(logged - shown, 0));
+                frameTimesBack = std::min(frameTimesBack, logged - shown);
+                int first = logged - shown - frameTimesBack;
+                float best, worst;
+                frameTimes.range(first, shown, &best, &worst);
+                char overlay[64];
+                snprintf(overlay, sizeof(overlay), "%.2f .. %.2f ms", shown > 0 ? best : 0.0f, shown > 0 ? worst : 0.0f);
+                frameTimes.plotLines("##frameTimes", first, shown, overlay, 0.0f, FLT_MAX, ImVec2(0.0f, 80.0f));
+                ImGui::Text("%d frames logged, %.1f KB pyramid", logged, frameTimes.pyramidBytes() / 1024.0f);
+            }
+
+            // Dear ImGui renderer
+            ImGui::Separator();
+            ImGui::Text("Dear ImGui");
+            if (ImGui::Checkbox("Single-upload draw data", &imguiSingleUpload))
+                ImGui_ImplOpenGL3_SetSingleUpload(imguiSingleUpload);
+            if (ImGui::Checkbox("Trusted GL state", &imguiTrustedState))
+                ImGui_ImplOpenGL3_SetTrustedState(imguiTrustedState ? ImGui_ImplOpenGL3_TrustedState_All : ImGui_ImplOpenGL3_TrustedState_None);
+            ImGui::Checkbox("Retained windows", &imguiRetainedWindows);
+            if (ImGui::Checkbox("Alpha8 font texture", &imguiAlpha8Font))
+                ImGui_ImplOpenGL3_SetFontTextureAlpha8(imguiAlpha8Font);
+            if (sdfFont)
+                ImGui::Checkbox("Distance-field font", &imguiSdfFont);
+            else
+                ImGui::Text("Distance-field font unavailable (needs FreeType and GL 3.3)");
+            ImGui::SliderFloat("UI Scale", &imguiUiScale, 0.5f, 3.0f, "%.2f");
+            ImGui::SliderInt("Stress Windows", &imguiStressWindows, 0, 200);
+            int imguiLists = 0, imguiUploads = 0, imguiBytes = 0;
+            ImGui_ImplOpenGL3_GetUploadStats(&imguiLists, &imguiUploads, &imguiBytes);
+            ImGui::Text("%d draw lists, %d buffer uploads, %.1f KB, %.3f ms", imguiLists, imguiUploads, imguiBytes / 1024.0f,
+                imguiRenderMs);
+            ImGui::Text("%d GL state queries", ImGui_ImplOpenGL3_GetStateQueryCount());
+            ImGui::Text("%d windows built, %d retained", imguiWindowsBuilt, imguiWindowsRetained);
+            {
+                const FontAtlasCacheStats& fontAtlas = FontAtlasCache::stats();
+                ImGui::Text("Font atlas %dx%d, %d glyphs, %.1f KB texture, %s in %.1f ms", fontAtlas.width, fontAtlas.height,
+                    fontAtlas.glyphs, ImGui_ImplOpenGL3_GetFontTextureBytes() / 1024.0f, fontAtlas.hit ? "cached" : "baked",
+                    fontAtlas.keyMs + (fontAtlas.hit ? fontAtlas.loadMs : fontAtlas.buildMs));
+            }
+            if (sdfFont)
+            {
+                const SdfFontStats& sdf = SdfFont::stats();
+                ImGui::Text("SDF atlas %dx%d, %d glyphs at %.0f px, %.1f KB texture, %s in %.1f ms", sdf.width, sdf.height,
+                    sdf.glyphs, sdf.bakeSize, sdf.width * sdf.height / 1024.0f, sdf.hit ? "cached" : "baked", sdf.buildMs);
+            }
 
             ImGui::End();
         }
 
+        // stress windows for the ImGui renderer (not saved to imgui.ini); the
+        // progress moves in whole percents, so most frames can retain them
+        stressWindows.resize(imguiStressWindows);
+        for (int i = 0; i < imguiStressWindows; i++)
+        {
+            float progress = floorf(fmodf(currentFrame * 0.2f + i * 0.05f, 1.0f) * 100.0f) / 100.0f;
+            RedrawGate::Key stressKey;
+            stressKey.add(i).add(progress);
+            ImGui::SetNextWindowPos(ImVec2(40.0f + (i % 10) * 70.0f, 60.0f + (i / 10) * 35.0f), ImGuiCond_FirstUseEver);
+            ImGui::SetNextWindowSize(ImVec2(220.0f, 110.0f), ImGuiCond_FirstUseEver);
+            if (stressWindows[i].begin(("Stress " + std::to_string(i)).c_str(), stressKey.value, imguiRetainedWindows, nullptr,
+                ImGuiWindowFlags_NoSavedSettings))
+            {
+                ImGui::Text("Window %d", i);
+                ImGui::ProgressBar(progress);
+            }
+            stressWindows[i].end();
+        }
+        RetainedWindow::takeCounts(&imguiWindowsBuilt, &imguiWindowsRetained);
+        ImGui::Render();
+
+        // skip drawing and swapping when neither input, the scene nor the UI
+        // changed (the UI is built anyway: its draw data is part of the test)
+        if (idleRedraw)
+        {
+            const IslandStreamStats& streaming = islandStreamer.stats();
+            RedrawGate::Key sceneKey;
+            sceneKey.add(camera.Position).add(camera.Front).add(camera.Zoom).add(display_w).add(display_h);
+            sceneKey.add(staticGeometryVersion).add(shaderReloads).add(streaming.drawn);
+            bool input = inputEvents != inputEventsSeen;
+            inputEventsSeen = inputEvents;
+            bool animating = spinCubes || flythrough || streaming.uploads > 0;
+            if (!redrawGate.shouldDraw(input, sceneKey.value, animating, RedrawGate::hashDrawData(ImGui::GetDrawData())))
+                continue;
+        }
+        if (frameTimes.size() >= FRAME_TIME_LOG_MAX)
+            frameTimes.clear();
+        frameTimes.push(deltaTime * 1000.0f);
 
         // Perform camera movement and render the OpenGL scene
-        int display_w, display_h;
-        glfwGetFramebufferSize(window, &display_w, &display_h);
         glViewport(0, 0, display_w, display_h);
 
+        // the scene's fixed state, set every frame because the ImGui renderer
+        // leaves blending and the scissor test on and depth testing off
+        glEnable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
+        glDisable(GL_SCISSOR_TEST);
+
+        glClearColor(bgColor[0], bgColor[1], bgColor[2], 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // one cluster grid serves every draw: they share fov and aspect, and
+        // the grid covers the widest depth range in use
+        clusteredLighting.update(camera.GetViewMatrix(),
+            glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f),
+            0.1f, 1000.0f, g_Lights);
+
+        // ---------- Build/translate the model matrix ----------
+        // 1. Build the base (translation) part:
+        glm::mat4 baseplateModel = glm::mat4(1.0f);
+        baseplateModel = glm::translate(baseplateModel, baseplatePosition);
+
+        // 2. Scale in X and Z by baseplateSize, and the unit heights by terrainHeight
+        glm::vec3 baseplateScale(baseplateSize, terrainHeight, baseplateSize);
+        baseplateModel = glm::scale(baseplateModel, baseplateScale);
+
+        // terrain chunk LODs follow the camera
+        if (showBaseplate)
+        {
+            terrain.update(camera.Position, baseplatePosition, baseplateScale, terrainLodDistance,
+                glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f) * camera.GetViewMatrix());
+        }
+
+        // sun shadows: every caster comes with a bounding sphere so each cascade
+        // only draws the ones that can reach it
+        glm::vec3 sunDirection(cos(glm::radians(sunElevation)) * cos(glm::radians(sunAzimuth)), sin(glm::radians(sunElevation)),
+            cos(glm::radians(sunElevation)) * sin(glm::radians(sunAzimuth)));
+        glm::vec3 sunLight = glm::vec3(sunColor[0], sunColor[1], sunColor[2]) * sunIntensity;
+        if (sunIntensity > 0.0f)
+        {
+            shadowCasters.clear();
+            if (showBaseplate)
+            {
+                shadowCasters.push_back({ baseplatePosition + glm::vec3(0.0f, terrainHeight * 0.5f, 0.0f),
+                    glm::length(baseplateScale * 0.5f), true,
+                    [&](const Shader& shader, const glm::mat4& view, const glm::mat4& projection)
+                    {
+                        // the terrain has its own vertex stage; hand the depth program back after
+                        terrainShadowShader.use();
+                        terrainShadowShader.setMat4("model", baseplateModel);
+                        terrainShadowShader.setMat4("view", view);
+                        terrainShadowShader.setMat4("projection", projection);
+                        int draws = terrain.draw(terrainShadowShader, false);
+                        shader.use();
+                        return draws;
+                    } });
+            }
+            for (unsigned int i = 0; i < sizeof(cubePositions) / sizeof(cubePositions[0]); i++)
+            {
+                shadowCasters.push_back({ cubePositions[i], 3.5f, false, // the mesh reaches 3.5 units from its origin
+                    [&, i](const Shader& shader, const glm::mat4& view, const glm::mat4& projection)
+                    {
+                        shader.setMat4("model", cubeModels[i]);
+                        shader.setMat4("view", view);
+                        shader.setMat4("projection", projection);
+                        glBindVertexArray(VAO);
+                        glDrawArrays(GL_TRIANGLES, 0, 84);
+                        return 1;
+                    } });
+            }
+            for (int i = 0; streamIslands && i < islandStreamer.visibleChunks(); i++)
+            {
+                // streamed chunks come and go, so they don't count as static
+                ShadowCaster caster;
+                islandStreamer.chunkSphere(i, caster.center, caster.radius);
+                caster.isStatic = false;
+                caster.draw = [&islandStreamer, i](const Shader& shader, const glm::mat4& view, const glm::mat4& projection)
+                {
+                    shader.setMat4("model", glm::mat4(1.0f));
+                    shader.setMat4("view", view);
+                    shader.setMat4("projection", projection);
+                    islandStreamer.drawChunk(i);
+                    return 1;
+                };
+                shadowCasters.push_back(caster);
+            }
+            for (BaseShape* shape : g_Shapes)
+            {
+                float scale = std::max(shape->scale.x, std::max(shape->scale.y, shape->scale.z));
+                shadowCasters.push_back({ shape->position, 0.87f * scale, true,
+                    [shape](const Shader& shader, const glm::mat4& view, const glm::mat4& projection)
+                    {
+                        shape->draw(view, projection, shader.ID);
+                        return 1;
+                    } });
+            }
+            cascadedShadows.render(shadowSettings, camera.GetViewMatrix(), glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT,
+                0.1f, sunDirection, staticGeometryVersion, shadowCasters, shadowShader);
+            glBindVertexArray(0);
+        }
+
+        if (showBaseplate)
+        {
+            // Render the baseplate
+            baseplateShader.use();
+
+            // Pass the camera matrices
+            glm::mat4 view = camera.GetViewMatrix();
+            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom),
+                (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f);
+            baseplateShader.setMat4("view", view);
+            baseplateShader.setMat4("projection", projection);
+
+            baseplateShader.setMat4("model", baseplateModel);
+
+
+            // Set the baseplate color from the GUI color palette
+            baseplateShader.setVec3("baseplateColor", glm::vec3(baseplateColor[0], baseplateColor[1], baseplateColor[2]));
+            clusteredLighting.bind(baseplateShader, glm::vec3(ambientLight), display_w, display_h);
+            cascadedShadows.bind(baseplateShader, sunDirection, sunLight);
+
+            // Draw the terrain chunks
+            terrain.draw(baseplateShader);
+        }
 
         // Render your OpenGL scene here...
         // Use camera for movement and scene rendering
@@ -459,21 +1022,13 @@ int main()
 
         glm::mat4 view = camera.GetViewMatrix();
         mainShader.setMat4("view", view);
+        clusteredLighting.bind(mainShader, glm::vec3(ambientLight), display_w, display_h);
+        cascadedShadows.bind(mainShader, sunDirection, sunLight);
 
         glBindVertexArray(VAO);
         for (unsigned int i = 0; i < sizeof(cubePositions) / sizeof(cubePositions[0]); i++)
         {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, cubePositions[i]);
-
-            float angle = 20.0f * i + glfwGetTime() * 12.5f;  // Continuous rotation
-            if (i == 0) {
-                model = glm::rotate(model, glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f)); // Rotate first object on Y-axis
-            }
-            else {
-                model = glm::rotate(model, glm::radians(angle), glm::vec3(10.0f, 20.0f, 5.0f)); // Rotate other objects
-            }
-            mainShader.setMat4("model", model);
+            mainShader.setMat4("model", cubeModels[i]);
 
             glBindTexture(GL_TEXTURE_2D, texture1);
             glDrawArrays(GL_TRIANGLES, 0, 18);
@@ -484,19 +1039,80 @@ int main()
             glBindTexture(GL_TEXTURE_2D, texture4);
             glDrawArrays(GL_TRIANGLES, 66, 18);
         }
+        if (streamIslands)
+        {
+            const unsigned int islandTextures[IslandField::GROUPS] = { texture1, texture2, texture3, texture4 };
+            mainShader.setMat4("model", glm::mat4(1.0f));
+            islandStreamer.draw(islandTextures);
+        }
 
         // Shape-specific shaders go here:
 
-        for (auto shape : g_Shapes)
+        shapeTransforms.resize(g_Shapes.size());
+        for (size_t i = 0; i < g_Shapes.size(); i++)
         {
-            // You might choose to pass the ID of the shader for shapes
-            // or each shape might store its own shader handle
-            shape->draw(view, projection, mainShader.ID);
+            const BaseShape& shape = *g_Shapes[i];
+            shapeTransforms.set(i, shape.position, shape.rotation, shape.scale);
+        }
+        shapeModels.resize(g_Shapes.size());
+        TransformBatch::compose(shapeTransforms, shapeModels.data());
+
+        // the islands and the baseplate are rasterized on the CPU; shapes whose
+        // bounding box is behind them are not drawn
+        shapeOccluded.assign(g_Shapes.size(), 0);
+        if (occlusionCulling && !g_Shapes.empty())
+        {
+            occlusionCuller.begin(projection * view);
+            for (unsigned int i = 0; i < sizeof(cubePositions) / sizeof(cubePositions[0]); i++)
+                occlusionCuller.addOccluder(vertices, 5, 84, nullptr, 0, cubeModels[i]);
+            if (showBaseplate)
+            {
+                occlusionCuller.addOccluder(terrain.occluderPositions().data(), 3, terrain.occluderPositions().size() / 3,
+                    terrain.occluderIndices().data(), terrain.occluderIndices().size(), baseplateModel);
+            }
+            occlusionCuller.rasterize();
+            shapeLocalMin.resize(g_Shapes.size());
+            shapeLocalMax.resize(g_Shapes.size());
+            shapeWorldMin.resize(g_Shapes.size());
+            shapeWorldMax.resize(g_Shapes.size());
+            for (size_t i = 0; i < g_Shapes.size(); i++)
+                meshBounds(*g_Shapes[i], shapeLocalMin[i], shapeLocalMax[i]);
+            TransformBatch::transformBoxes(shapeModels.data(), shapeLocalMin.data(), shapeLocalMax.data(),
+                shapeWorldMin.data(), shapeWorldMax.data(), (int)g_Shapes.size());
+            for (size_t i = 0; i < g_Shapes.size(); i++)
+                shapeOccluded[i] = !occlusionCuller.isVisible(shapeWorldMin[i], shapeWorldMax[i]);
+        }
+
+        if (indirectShader && gpuCullingEnabled)
+        {
+            // culled by a compute shader and drawn with one multi-draw-indirect call
+            gpuCulling.update(g_Shapes, shapeModels, shapeOccluded);
+            gpuCulling.cull(projection * view);
+            indirectShader->use();
+            indirectShader->setMat4("view", view);
+            indirectShader->setMat4("projection", projection);
+            clusteredLighting.bind(*indirectShader, glm::vec3(ambientLight), display_w, display_h);
+            cascadedShadows.bind(*indirectShader, sunDirection, sunLight);
+            gpuCulling.draw();
+            if (verifyGpuCulling)
+                gpuCullingMismatches = gpuCulling.verify(gpuCullingVisible);
+        }
+        else
+        {
+            for (size_t i = 0; i < g_Shapes.size(); i++)
+            {
+                if (shapeOccluded[i])
+                    continue;
+                // You might choose to pass the ID of the shader for shapes
+                // or each shape might store its own shader handle
+                g_Shapes[i]->draw(view, projection, mainShader.ID);
+            }
         }
 
         // Render ImGui UI after OpenGL scene
-        ImGui::Render();
+        double imguiStart = glfwGetTime();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        imguiRenderMs = (float)((glfwGetTime() - imguiStart) * 1000.0);
 
         // glfw: swap buffers
         glfwSwapBuffers(window);
@@ -507,6 +1123,11 @@ int main()
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
+    clusteredLighting.destroy();
+    cascadedShadows.destroy();
+    gpuCulling.destroy();
+    terrain.destroy();
+    islandStreamer.destroy();
 
     // Cleanup ImGui
     ImGui_ImplOpenGL3_Shutdown();
@@ -553,6 +1174,7 @@ void processInput(GLFWwindow* window)
     tabPressedLastFrame = tabPressed;
 
     // Suppose user presses numeric keys to spawn shapes
+    size_t shapeCount = g_Shapes.size();
     bool key1IsPressed = (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS);
     if (key1IsPressed && !key1PressedLastFrame)
     {
@@ -623,6 +1245,10 @@ void processInput(GLFWwindow* window)
     }
     key4PressedLastFrame = key4IsPressed;
 
+    // placed shapes are static shadow casters
+    if (g_Shapes.size() != shapeCount)
+        staticGeometryVersion++;
+
     //else if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
     //{
     //    // create sphere, etc.
@@ -693,25 +1319,90 @@ void loadTexture(unsigned int& textureName, const std::string& path)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     // load image, create texture and generate mipmaps
+    // the image is decoded straight into a mapped pixel unpack buffer, so there is
+    // no intermediate stb_image allocation to convert, flip and free afterwards
+    AssetSpan file = VFS::read(path);
+    const stbi_uc* fileData = (const stbi_uc*)file.data;
     int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-    unsigned char* data = stbi_load(FileSystem::getPath(path).c_str(), &width, &height, &nrChannels, 0);
-    if (data)
+    if (!file.valid() || !stbi_info_from_memory(fileData, (int)file.size, &width, &height, &nrChannels))
+    {
+        std::cout << "Failed to load texture" << std::endl;
+        return;
+    }
+    const int stride = (width * 3 + 3) & ~3; // rows padded to GL_UNPACK_ALIGNMENT (4)
+    const size_t size = (size_t)stride * height;
+
+    unsigned int pbo;
+    glGenBuffers(1, &pbo);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+    unsigned char* data = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    // flip on the y-axis for this call only (no global stbi_set_flip_vertically_on_load state)
+    bool loaded = data && stbi_load_into_from_memory(fileData, (int)file.size, data, size, stride, &width, &height, &nrChannels, 3, true);
+    if (data && glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE)
+        loaded = false; // buffer contents were lost while mapped
+    if (loaded)
     {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, (void*)0);
         glGenerateMipmap(GL_TEXTURE_2D);
     }
     else
     {
         std::cout << "Failed to load texture" << std::endl;
     }
-    stbi_image_free(data);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &pbo);
+    VFS::release(path);
+}
+
+// scatter lightCount point lights over the baseplate area, above the ground; the same seed gives the same lights
+void scatterLights(std::vector<PointLight>& lights, unsigned int seed, const TerrainChunks& ground)
+{
+    unsigned int state = seed * 747796405u + 2891336453u;
+    auto random = [&state]()
+    {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    };
+    lights.resize(lightCount);
+    for (PointLight& light : lights)
+    {
+        float x = random() - 0.5f, z = random() - 0.5f;
+        light.position = baseplatePosition + glm::vec3(x * baseplateSize, ground.heightAt(x, z) * terrainHeight + 0.5f + random() * 4.0f, z * baseplateSize);
+        light.radius = lightRadius;
+        light.color = glm::vec3(0.2f + random() * 0.8f, 0.2f + random() * 0.8f, 0.2f + random() * 0.8f);
+        light.intensity = lightIntensity;
+    }
+}
+
+// object-space box around a shape's mesh, computed once per mesh
+void meshBounds(const BaseShape& shape, glm::vec3& boxMin, glm::vec3& boxMax)
+{
+    static std::map<std::string, std::pair<glm::vec3, glm::vec3>> cache;
+    std::string key = shape.meshKey();
+    auto known = cache.find(key);
+    if (known == cache.end())
+    {
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+        shape.getMesh(vertices, indices);
+        glm::vec3 low(1e30f), high(-1e30f);
+        for (size_t v = 0; v + 2 < vertices.size(); v += 3)
+        {
+            low = glm::min(low, glm::vec3(vertices[v], vertices[v + 1], vertices[v + 2]));
+            high = glm::max(high, glm::vec3(vertices[v], vertices[v + 1], vertices[v + 2]));
+        }
+        known = cache.emplace(key, std::make_pair(low, high)).first;
+    }
+    boxMin = known->second.first;
+    boxMax = known->second.second;
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
 // ---------------------------------------------------------------------------------------------
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
+    inputEvents++;
     // make sure the viewport matches the new window dimensions; note that width and 
     // height will be significantly larger than specified on retina displays.
     glViewport(0, 0, width, height);
@@ -721,6 +1412,7 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 // -------------------------------------------------------
 void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 {
+    inputEvents++;
     if (!guiMode) // Only process mouse input in simulation mode
     {
         float xoffset = xpos - lastX;
@@ -737,5 +1429,26 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 // ----------------------------------------------------------------------
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 {
+    inputEvents++;
     camera.ProcessMouseScroll(static_cast<float>(yoffset));
+}
+
+// glfw: keys and mouse buttons are polled in processInput (and fed to ImGui by
+// its backend); these only count as input for the idle redraw
+// -----------------------------------------------------------------------------
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    inputEvents++;
+}
+
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+    inputEvents++;
+}
+
+// glfw: the window contents were damaged (uncovered, restored) and need drawing
+// -----------------------------------------------------------------------------
+void window_refresh_callback(GLFWwindow* window)
+{
+    inputEvents++;
 }
\ No newline at end of file
@@ -0,0 +1,348 @@
+#ifndef OCCLUSIONCULLER_H
+#define OCCLUSIONCULLER_H
+
+#include <glm/glm.hpp>
+
+#include "cpufeatures.h"
+#include "jobsystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#ifdef CPUFEATURES_X86
+#define OCCLUSIONCULLER_AVX2 1
+#endif
+
+struct OcclusionStats
+{
+    int occluderTriangles = 0;  // after near-plane clipping
+    int tested = 0;
+    int culled = 0;
+    double rasterMs = 0.0;      // rasterization + Hi-Z build
+
+    float culledFraction() const { return tested ? (float)culled / tested : 0.0f; }
+};
+
+// CPU occlusion culling. A handful of big occluders (the islands, the
+// baseplate) are rasterized into a small depth buffer, a hierarchical-Z
+// pyramid is built on top of it, and object AABBs are tested against the
+// pyramid before they are drawn.
+//
+// Depth is stored as 1/w (linear in screen space; larger = nearer). Each Hi-Z
+// texel keeps the farthest (smallest) value below it, so a box is hidden when
+// its nearest point is still behind that. Occluders are only rasterized where
+// they cover pixel centers, at a resolution much lower than the screen, so a
+// sliver of an object peeking past an occluder edge can be culled.
+//
+// Rows are filled 8 pixels at a time with AVX2 when the CPU has it (checked
+// at run time, so the app needs no /arch:AVX2); the
+// buffer is split into tiles rasterized in parallel on the JobSystem. A tile
+// is written by one thread only and the depth test is a max, so the result
+// does not depend on thread timing or triangle order. No GL calls here.
+class OcclusionCuller
+{
+public:
+    static const int TILE_WIDTH = 32;   // a multiple of the SIMD width
+    static const int TILE_HEIGHT = 16;
+
+    OcclusionCuller(int width = 256, int height = 128)
+        : m_Width((width + TILE_WIDTH - 1) / TILE_WIDTH * TILE_WIDTH), m_Height((height + TILE_HEIGHT - 1) / TILE_HEIGHT * TILE_HEIGHT)
+    {
+        int w = m_Width, h = m_Height;
+        for (;;)
+        {
+            m_Levels.push_back(Level{ w, h, std::vector<float>((size_t)w * h, 0.0f) });
+            if (w == 1 && h == 1)
+                break;
+            w = (w + 1) / 2;
+            h = (h + 1) / 2;
+        }
+    }
+
+    int width() const { return m_Width; }
+    int height() const { return m_Height; }
+    int levelCount() const { return (int)m_Levels.size(); }
+    // 1/w per texel; level 0 is the rasterized buffer
+    const std::vector<float>& depth(int level) const { return m_Levels[level].depth; }
+    const OcclusionStats& stats() const { return m_Stats; }
+
+    bool avx2() const { return m_Avx2; }
+    // the AVX2 row fill can be turned off (to compare it with the scalar one),
+    // not on where the CPU lacks it
+    void setAvx2(bool enabled) { m_Avx2 = enabled && CpuFeatures::get().avx2; }
+
+    // start a frame: clear the buffer and the occluder list
+    void begin(const glm::mat4& viewProjection)
+    {
+        m_ViewProjection = viewProjection;
+        m_Triangles.clear();
+        m_Stats = OcclusionStats();
+    }
+
+    // positions are (x, y, z) at the start of every `stride` floats; without
+    // indices, consecutive vertices form triangles
+    void addOccluder(const float* positions, size_t stride, size_t vertexCount, const unsigned int* indices, size_t indexCount, const glm::mat4& model)
+    {
+        glm::mat4 transform = m_ViewProjection * model;
+        m_Clip.resize(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            const float* p = positions + v * stride;
+            m_Clip[v] = transform * glm::vec4(p[0], p[1], p[2], 1.0f);
+        }
+        size_t count = indices ? indexCount : vertexCount;
+        for (size_t i = 0; i + 2 < count; i += 3)
+        {
+            if (indices)
+                addTriangle(m_Clip[indices[i]], m_Clip[indices[i + 1]], m_Clip[indices[i + 2]]);
+            else
+                addTriangle(m_Clip[i], m_Clip[i + 1], m_Clip[i + 2]);
+        }
+    }
+
+    // rasterize every occluder and build the Hi-Z pyramid
+    void rasterize()
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        m_Stats.occluderTriangles = (int)m_Triangles.size();
+        int tilesX = m_Width / TILE_WIDTH;
+        int tilesY = m_Height / TILE_HEIGHT;
+        JobSystem::parallelFor(tilesX * tilesY, 1, [this, tilesX](int begin, int end)
+        {
+            for (int tile = begin; tile < end; tile++)
+                rasterizeTile((tile % tilesX) * TILE_WIDTH, (tile / tilesX) * TILE_HEIGHT);
+        });
+        buildPyramid();
+        m_Stats.rasterMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // false when the world-space box is certainly hidden behind the occluders
+    bool isVisible(const glm::vec3& boxMin, const glm::vec3& boxMax)
+    {
+        m_Stats.tested++;
+        float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, nearest = 0.0f;
+        for (int c = 0; c < 8; c++)
+        {
+            glm::vec4 clip = m_ViewProjection * glm::vec4((c & 1) ? boxMax.x : boxMin.x, (c & 2) ? boxMax.y : boxMin.y, (c & 4) ? boxMax.z : boxMin.z, 1.0f);
+            if (clip.z + clip.w <= 0.0f || clip.w <= 0.0f)
+                return true; // crosses the near plane
+            float invW = 1.0f / clip.w;
+            float x = (clip.x * invW * 0.5f + 0.5f) * m_Width;
+            float y = (clip.y * invW * 0.5f + 0.5f) * m_Height;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            nearest = std::max(nearest, invW);
+        }
+        if (maxX < 0.0f || maxY < 0.0f || minX >= m_Width || minY >= m_Height)
+            return true; // off screen; frustum culling's job
+
+        // every pixel the box touches, then the level where that is at most 2x2 texels
+        int x0 = std::max(0, (int)std::floor(minX)), x1 = std::min(m_Width - 1, (int)std::floor(maxX));
+        int y0 = std::max(0, (int)std::floor(minY)), y1 = std::min(m_Height - 1, (int)std::floor(maxY));
+        int level = 0;
+        while (level + 1 < (int)m_Levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+            level++;
+
+        const Level& hiZ = m_Levels[level];
+        float farthest = 1e30f;
+        for (int y = y0 >> level; y <= y1 >> level; y++)
+        {
+            for (int x = x0 >> level; x <= x1 >> level; x++)
+                farthest = std::min(farthest, hiZ.depth[(size_t)y * hiZ.width + x]);
+        }
+        if (nearest < farthest)
+        {
+            m_Stats.culled++;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    struct Level
+    {
+        int width;
+        int height;
+        std::vector<float> depth;
+    };
+
+    // screen-space triangle set up for rasterization
+    struct Triangle
+    {
+        float edgeA[3], edgeB[3], edgeC[3];  // inside where A*x + B*y + C >= 0 for all three
+        float depthA, depthB, depthC;        // 1/w = A*x + B*y + C
+        int minX, minY, maxX, maxY;          // pixel bounds
+    };
+
+    int m_Width;
+    int m_Height;
+    std::vector<Level> m_Levels;
+    glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+    std::vector<glm::vec4> m_Clip;
+    std::vector<Triangle> m_Triangles;
+    OcclusionStats m_Stats;
+    bool m_Avx2 = CpuFeatures::get().avx2;
+
+    void addTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+    {
+        // clip against the near plane (z > -w); up to one extra triangle
+        const glm::vec4 in[3] = { a, b, c };
+        glm::vec4 polygon[4];
+        int count = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            const glm::vec4& p = in[i];
+            const glm::vec4& q = in[(i + 1) % 3];
+            float dp = p.z + p.w, dq = q.z + q.w;
+            if (dp > 0.0f)
+                polygon[count++] = p;
+            if ((dp > 0.0f) != (dq > 0.0f))
+                polygon[count++] = p + (q - p) * (dp / (dp - dq));
+        }
+        for (int i = 1; i + 1 < count; i++)
+            setupTriangle(polygon[0], polygon[i], polygon[i + 1]);
+    }
+
+    void setupTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+    {
+        float x[3], y[3], z[3];
+        const glm::vec4* v[3] = { &a, &b, &c };
+        for (int i = 0; i < 3; i++)
+        {
+            if (v[i]->w <= 1e-6f)
+                return;
+            z[i] = 1.0f / v[i]->w;
+            x[i] = (v[i]->x * z[i] * 0.5f + 0.5f) * m_Width;
+            y[i] = (v[i]->y * z[i] * 0.5f + 0.5f) * m_Height;
+        }
+        float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (std::fabs(area) < 1e-8f)
+            return;
+
+        Triangle t;
+        t.minX = std::max(0, (int)std::floor(std::min(x[0], std::min(x[1], x[2]))));
+        t.maxX = std::min(m_Width - 1, (int)std::ceil(std::max(x[0], std::max(x[1], x[2]))));
+        t.minY = std::max(0, (int)std::floor(std::min(y[0], std::min(y[1], y[2]))));
+        t.maxY = std::min(m_Height - 1, (int)std::ceil(std::max(y[0], std::max(y[1], y[2]))));
+        if (t.minX > t.maxX || t.minY > t.maxY)
+            return;
+
+        // edge i is opposite vertex i; both windings are occluders (no culling in the scene)
+        float sign = area > 0.0f ? 1.0f : -1.0f;
+        for (int i = 0; i < 3; i++)
+        {
+            int j = (i + 1) % 3, k = (i + 2) % 3;
+            t.edgeA[i] = (y[j] - y[k]) * sign;
+            t.edgeB[i] = (x[k] - x[j]) * sign;
+            t.edgeC[i] = (x[j] * y[k] - x[k] * y[j]) * sign;
+        }
+        float inverseArea = 1.0f / std::fabs(area);
+        t.depthA = (t.edgeA[0] * z[0] + t.edgeA[1] * z[1] + t.edgeA[2] * z[2]) * inverseArea;
+        t.depthB = (t.edgeB[0] * z[0] + t.edgeB[1] * z[1] + t.edgeB[2] * z[2]) * inverseArea;
+        t.depthC = (t.edgeC[0] * z[0] + t.edgeC[1] * z[1] + t.edgeC[2] * z[2]) * inverseArea;
+        m_Triangles.push_back(t);
+    }
+
+    void rasterizeTile(int tileX, int tileY)
+    {
+        std::vector<float>& depth = m_Levels[0].depth;
+        for (int row = tileY; row < tileY + TILE_HEIGHT; row++)
+            std::fill(depth.begin() + (size_t)row * m_Width + tileX, depth.begin() + (size_t)row * m_Width + tileX + TILE_WIDTH, 0.0f);
+
+        for (const Triangle& t : m_Triangles)
+        {
+            int x0 = std::max(t.minX, tileX), x1 = std::min(t.maxX, tileX + TILE_WIDTH - 1);
+            int y0 = std::max(t.minY, tileY), y1 = std::min(t.maxY, tileY + TILE_HEIGHT - 1);
+            if (x0 > x1 || y0 > y1)
+                continue;
+            for (int y = y0; y <= y1; y++)
+            {
+#ifdef OCCLUSIONCULLER_AVX2
+                if (m_Avx2)
+                {
+                    rasterizeRowAvx2(t, x0, x1, y, &depth[(size_t)y * m_Width]);
+                    continue;
+                }
+#endif
+                rasterizeRow(t, x0, x1, y, &depth[(size_t)y * m_Width]);
+            }
+        }
+    }
+
+    // pixels x0..x1 of one row; pixel centers are at +0.5
+    static void rasterizeRow(const Triangle& t, int x0, int x1, int y, float* row)
+    {
+        float py = y + 0.5f;
+        float rowEdge[3];
+        for (int i = 0; i < 3; i++)
+            rowEdge[i] = t.edgeB[i] * py + t.edgeC[i];
+        float rowDepth = t.depthB * py + t.depthC;
+
+        for (int x = x0; x <= x1; x++)
+        {
+            float px = x + 0.5f;
+            if (t.edgeA[0] * px + rowEdge[0] >= 0.0f && t.edgeA[1] * px + rowEdge[1] >= 0.0f && t.edgeA[2] * px + rowEdge[2] >= 0.0f)
+                row[x] = std::max(row[x], t.depthA * px + rowDepth);
+        }
+    }
+
+#ifdef OCCLUSIONCULLER_AVX2
+    // the same, 8 pixels at a time; the scalar one takes what is left over
+    static CPU_TARGET_AVX2 void rasterizeRowAvx2(const Triangle& t, int x0, int x1, int y, float* row)
+    {
+        float py = y + 0.5f;
+        float rowEdge[3];
+        for (int i = 0; i < 3; i++)
+            rowEdge[i] = t.edgeB[i] * py + t.edgeC[i];
+        float rowDepth = t.depthB * py + t.depthC;
+
+        int x = x0;
+        const __m256 lane = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+        const __m256 zero = _mm256_setzero_ps();
+        for (; x + 7 <= x1; x += 8)
+        {
+            __m256 px = _mm256_add_ps(_mm256_set1_ps((float)x), lane);
+            __m256 e0 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(t.edgeA[0]), px), _mm256_set1_ps(rowEdge[0]));
+            __m256 e1 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(t.edgeA[1]), px), _mm256_set1_ps(rowEdge[1]));
+            __m256 e2 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(t.edgeA[2]), px), _mm256_set1_ps(rowEdge[2]));
+            __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ), _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)),
+                _mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+            if (_mm256_movemask_ps(inside) == 0)
+                continue;
+            __m256 z = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(t.depthA), px), _mm256_set1_ps(rowDepth));
+            __m256 old = _mm256_loadu_ps(row + x);
+            _mm256_storeu_ps(row + x, _mm256_blendv_ps(old, _mm256_max_ps(old, z), inside));
+        }
+        if (x <= x1)
+            rasterizeRow(t, x, x1, y, row);
+    }
+#endif
+
+    // each texel keeps the farthest (smallest 1/w) of the texels below it
+    void buildPyramid()
+    {
+        for (size_t l = 1; l < m_Levels.size(); l++)
+        {
+            const Level& below = m_Levels[l - 1];
+            Level& level = m_Levels[l];
+            for (int y = 0; y < level.height; y++)
+            {
+                int y0 = y * 2, y1 = std::min(y * 2 + 1, below.height - 1);
+                for (int x = 0; x < level.width; x++)
+                {
+                    int x0 = x * 2, x1 = std::min(x * 2 + 1, below.width - 1);
+                    level.depth[(size_t)y * level.width + x] = std::min(
+                        std::min(below.depth[(size_t)y0 * below.width + x0], below.depth[(size_t)y0 * below.width + x1]),
+                        std::min(below.depth[(size_t)y1 * below.width + x0], below.depth[(size_t)y1 * below.width + x1]));
+                }
+            }
+        }
+    }
+};
+
+// OCCLUSIONCULLER_H
+#endif
@@ -0,0 +1,286 @@
+#ifndef PLOTLOD_H
+#define PLOTLOD_H
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+// A series of samples (a frame-time log, say) that plots like
+// ImGui::PlotLines() at a cost that depends on the plot's width, not on how
+// many samples it shows.
+//
+// ImGui::PlotLines() draws one segment per pixel, but picks one sample per
+// pixel to do it, so a spike between two picks is not drawn, and it scans
+// every sample each frame when it auto-scales. Here each pixel column is a
+// bucket of samples drawn as a vertical segment from the bucket's minimum to
+// its maximum, joined to the next column from the bucket's last sample to
+// the next one's first: that is what rasterizing every segment of the
+// polyline would cover in the column, in at most two segments. The minima
+// and maxima come from a pyramid built as samples are pushed: the min/max of
+// blocks of LEAF samples, of pairs of those, and so on, so any range is
+// O(log n) blocks and a plot of any view (for pan and zoom) is
+// O(width * log n). Views with fewer samples than columns are drawn as the
+// plain polyline. NaN samples are skipped, like ImGui's.
+// No GL calls here.
+class PlotLod
+{
+public:
+    static const int LEAF = 16;     // samples per block of the lowest pyramid level
+
+    void push(float value)
+    {
+        m_Values.push_back(value);
+        size_t block = (m_Values.size() - 1) / LEAF;
+        for (size_t level = 0; ; level++, block >>= 1)
+        {
+            if (level == m_Levels.size())
+            {
+                // the level below just got its second block
+                m_Levels.emplace_back();
+                if (level > 0)
+                    m_Levels[level].push_back(merge(m_Levels[level - 1][0], m_Levels[level - 1][1]));
+            }
+            std::vector<Bucket>& buckets = m_Levels[level];
+            bool started = block == buckets.size();
+            if (started)
+                buckets.push_back(Bucket());
+            bool widened = buckets[block].add(value);
+            // nothing above changes when this block did not, but a new block
+            // (even one that starts with NaN) may need a new one above it
+            if (buckets.size() == 1 || (!widened && !started))
+                break;
+        }
+    }
+
+    // replaces the series, building the pyramid level by level
+    void assign(const float* values, int count)
+    {
+        m_Values.assign(values, values + count);
+        m_Levels.clear();
+        if (count == 0)
+            return;
+        m_Levels.emplace_back((count + LEAF - 1) / LEAF);
+        for (int i = 0; i < count; i++)
+            m_Levels[0][i / LEAF].add(values[i]);
+        while (m_Levels.back().size() > 1)
+        {
+            const std::vector<Bucket>& below = m_Levels.back();
+            std::vector<Bucket> buckets((below.size() + 1) / 2);
+            for (size_t i = 0; i < below.size(); i++)
+                buckets[i / 2] = merge(buckets[i / 2], below[i]);
+            m_Levels.push_back(buckets);
+        }
+    }
+
+    void clear()
+    {
+        m_Values.clear();
+        m_Levels.clear();
+    }
+
+    int size() const { return (int)m_Values.size(); }
+    const float* data() const { return m_Values.data(); }
+
+    // minimum and maximum of samples [first, first + count), FLT_MAX and
+    // -FLT_MAX when there are none (or all are NaN)
+    void range(int first, int count, float* outMin, float* outMax) const
+    {
+        Bucket bucket;
+        int begin = ImClamp(first, 0, size());
+        int end = ImClamp(first + count, begin, size());
+        // the unaligned ends sample by sample, the rest by whole blocks
+        while (begin < end && begin % LEAF != 0)
+            bucket.add(m_Values[begin++]);
+        while (end > begin && end % LEAF != 0)
+            bucket.add(m_Values[--end]);
+        size_t lo = (size_t)(begin / LEAF), hi = (size_t)(end / LEAF);
+        for (size_t level = 0; lo < hi; level++, lo >>= 1, hi >>= 1)
+        {
+            if (lo & 1)
+                bucket = merge(bucket, m_Levels[level][lo++]);
+            if (hi & 1)
+                bucket = merge(bucket, m_Levels[level][--hi]);
+        }
+        *outMin = bucket.min;
+        *outMax = bucket.max;
+    }
+
+    // ImGui::PlotLines() of samples [first, first + count) (clamped to the
+    // series), auto-scaled to them where the scale is FLT_MAX. Returns the
+    // first sample of the hovered column, or -1.
+    int plotLines(const char* label, int first, int count, const char* overlayText = nullptr, float scaleMin = FLT_MAX,
+        float scaleMax = FLT_MAX, ImVec2 graphSize = ImVec2(0.0f, 0.0f))
+    {
+        ImGuiContext& g = *GImGui;
+        ImGuiWindow* window = ImGui::GetCurrentWindow();
+        m_Segments = 0;
+        if (window->SkipItems)
+            return -1;
+        first = ImClamp(first, 0, size());
+        count = ImClamp(count, 0, size() - first);
+
+        const ImGuiStyle& style = g.Style;
+        const ImGuiID id = window->GetID(label);
+        const ImVec2 labelSize = ImGui::CalcTextSize(label, nullptr, true);
+        const ImVec2 frameSize = ImGui::CalcItemSize(graphSize, ImGui::CalcItemWidth(), labelSize.y + style.FramePadding.y * 2.0f);
+        const ImVec2 pos = window->DC.CursorPos;
+        const ImRect frameBb(pos, ImVec2(pos.x + frameSize.x, pos.y + frameSize.y));
+        const ImRect innerBb(ImVec2(frameBb.Min.x + style.FramePadding.x, frameBb.Min.y + style.FramePadding.y),
+            ImVec2(frameBb.Max.x - style.FramePadding.x, frameBb.Max.y - style.FramePadding.y));
+        const ImRect totalBb(frameBb.Min, ImVec2(frameBb.Max.x + (labelSize.x > 0.0f ? style.ItemInnerSpacing.x + labelSize.x : 0.0f),
+            frameBb.Max.y));
+        ImGui::ItemSize(totalBb, style.FramePadding.y);
+        if (!ImGui::ItemAdd(totalBb, id, &frameBb, ImGuiItemFlags_NoNav))
+            return -1;
+        bool hovered;
+        ImGui::ButtonBehavior(frameBb, id, &hovered, nullptr);
+
+        if (scaleMin == FLT_MAX || scaleMax == FLT_MAX)
+        {
+            float vMin, vMax;
+            range(first, count, &vMin, &vMax);
+            if (scaleMin == FLT_MAX)
+                scaleMin = vMin;
+            if (scaleMax == FLT_MAX)
+                scaleMax = vMax;
+        }
+
+        ImGui::RenderFrame(frameBb.Min, frameBb.Max, ImGui::GetColorU32(ImGuiCol_FrameBg), true, style.FrameRounding);
+
+        int hoveredIndex = -1;
+        if (count >= 2)
+        {
+            const float width = innerBb.GetWidth();
+            const float invScale = (scaleMin == scaleMax) ? 0.0f : (1.0f / (scaleMax - scaleMin));
+            const ImU32 colBase = ImGui::GetColorU32(ImGuiCol_PlotLines);
+            const ImU32 colHovered = ImGui::GetColorU32(ImGuiCol_PlotLinesHovered);
+            // one column per pixel, or per sample when there are fewer
+            const int columns = ImMax(1, ImMin((int)width, count - 1));
+            const bool buckets = count - 1 > columns;
+            const float hoverT = hovered && innerBb.Contains(g.IO.MousePos)
+                ? ImClamp((g.IO.MousePos.x - innerBb.Min.x) / width, 0.0f, 0.9999f) : -1.0f;
+            // the nearest bucket, or the segment under the mouse
+            const int hoveredColumn = hoverT < 0.0f ? -1 : (int)(hoverT * columns + (buckets ? 0.5f : 0.0f));
+
+            ImDrawList* drawList = window->DrawList;
+            ImVec2 previous(0.0f, 0.0f);
+            float previousMin = 0.0f, previousMax = 0.0f;
+            bool hasPrevious = false;
+            for (int column = 0; column <= columns; column++)
+            {
+                // samples [begin, end) of the column, one without buckets
+                int begin = first + (buckets ? (int)((int64_t)column * count / (columns + 1)) : column);
+                int end = first + (buckets ? (int)((int64_t)(column + 1) * count / (columns + 1)) : column + 1);
+                float x = innerBb.Min.x + width * column / columns;
+                ImU32 col = column == hoveredColumn + 1 || (buckets && column == hoveredColumn) ? colHovered : colBase;
+                if (column == hoveredColumn)
+                    hoveredIndex = begin;
+
+                float vMin = m_Values[begin], vMax = vMin;
+                if (end - begin > 1)
+                    range(begin, end - begin, &vMin, &vMax);
+                if (vMin > vMax || vMin != vMin)
+                {
+                    hasPrevious = false;    // a gap, as ImGui draws NaN
+                    continue;
+                }
+                float vFirst = m_Values[begin] == m_Values[begin] ? m_Values[begin] : vMin;
+                float vLast = m_Values[end - 1] == m_Values[end - 1] ? m_Values[end - 1] : vMax;
+
+                ImVec2 firstPos(x, y(innerBb, vFirst, scaleMin, invScale));
+                // a join between overlapping columns a pixel apart is covered
+                // by their vertical segments already
+                bool overlaps = buckets && vMin < vMax && previousMin < previousMax && vMin <= previousMax && vMax >= previousMin;
+                if (hasPrevious && !overlaps)
+                {
+                    drawList->AddLine(previous, firstPos, col);
+                    m_Segments++;
+                }
+                if (vMin != vMax)
+                {
+                    drawList->AddLine(ImVec2(x, y(innerBb, vMax, scaleMin, invScale)), ImVec2(x, y(innerBb, vMin, scaleMin, invScale)), col);
+                    m_Segments++;
+                }
+                previous = ImVec2(x, y(innerBb, vLast, scaleMin, invScale));
+                previousMin = vMin;
+                previousMax = vMax;
+                hasPrevious = true;
+            }
+
+            if (hoveredColumn >= 0)
+            {
+                if (buckets)
+                {
+                    int begin = first + (int)((int64_t)hoveredColumn * count / (columns + 1));
+                    int end = first + (int)((int64_t)(hoveredColumn + 1) * count / (columns + 1));
+                    float vMin, vMax;
+                    range(begin, end - begin, &vMin, &vMax);
+                    ImGui::SetTooltip("%d..%d: %8.4g .. %8.4g", begin, end - 1, vMin, vMax);
+                }
+                else
+                {
+                    ImGui::SetTooltip("%d: %8.4g\n%d: %8.4g", hoveredIndex, m_Values[hoveredIndex], hoveredIndex + 1,
+                        m_Values[hoveredIndex + 1]);
+                }
+            }
+        }
+
+        if (overlayText)
+            ImGui::RenderTextClipped(ImVec2(frameBb.Min.x, frameBb.Min.y + style.FramePadding.y), frameBb.Max, overlayText, nullptr,
+                nullptr, ImVec2(0.5f, 0.0f));
+        if (labelSize.x > 0.0f)
+            ImGui::RenderText(ImVec2(frameBb.Max.x + style.ItemInnerSpacing.x, innerBb.Min.y), label);
+        return hoveredIndex;
+    }
+
+    // lines the last plotLines() drew
+    int segments() const { return m_Segments; }
+
+    // the pyramid's memory, on top of the samples'
+    size_t pyramidBytes() const
+    {
+        size_t bytes = 0;
+        for (const std::vector<Bucket>& buckets : m_Levels)
+            bytes += buckets.size() * sizeof(Bucket);
+        return bytes;
+    }
+
+private:
+    struct Bucket
+    {
+        float min = FLT_MAX;
+        float max = -FLT_MAX;
+
+        // whether the value widened the bucket; NaN never does
+        bool add(float value)
+        {
+            bool changed = false;
+            if (value < min) { min = value; changed = true; }
+            if (value > max) { max = value; changed = true; }
+            return changed;
+        }
+    };
+
+    static Bucket merge(const Bucket& a, const Bucket& b)
+    {
+        Bucket bucket;
+        bucket.min = ImMin(a.min, b.min);
+        bucket.max = ImMax(a.max, b.max);
+        return bucket;
+    }
+
+    static float y(const ImRect& bb, float value, float scaleMin, float invScale)
+    {
+        return ImLerp(bb.Min.y, bb.Max.y, 1.0f - ImSaturate((value - scaleMin) * invScale));
+    }
+
+    std::vector<float> m_Values;
+    std::vector<std::vector<Bucket>> m_Levels;
+    int m_Segments = 0;
+};
+
+// PLOTLOD_H
+#endif
@@ -0,0 +1,240 @@
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+
+#include <glad/glad.h>
+
+#include "assetpack.h"
+#include "filesystem.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Counters for the program binary cache
+struct ProgramCacheStats
+{
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    unsigned int rejected = 0;   // binaries the driver refused (driver update, different GPU, ...)
+    unsigned int stored = 0;
+    double compileMs = 0.0;      // time spent compiling + linking on misses
+    double loadMs = 0.0;         // time spent in glProgramBinary on hits
+    double savedMs = 0.0;        // compile time recorded with each hit binary, minus its load time
+};
+
+// Cache file layout: ProgramCacheHeader followed by `length` bytes of driver binary
+const uint32_t PROGRAM_CACHE_MAGIC = 0x424C474F; // "OGLB"
+const uint32_t PROGRAM_CACHE_VERSION = 1;
+const char* const PROGRAM_CACHE_DIR = "shadercache";
+
+struct ProgramCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t length;
+    float compileMs;
+    uint32_t reserved;
+};
+
+// On-disk cache of linked programs (glGetProgramBinary/glProgramBinary), keyed
+// by the FNV-1a hash of the shader sources and the GL vendor/renderer/version.
+// Binaries are driver specific, so anything unexpected is treated as a miss.
+class ProgramCache
+{
+public:
+    // true when the context exposes program binaries (GL 4.1 / ARB_get_program_binary)
+    static bool supported()
+    {
+        static int formats = -1;
+        if (formats < 0)
+        {
+            formats = 0;
+            if (glGetProgramBinary && glProgramBinary && glProgramParameteri)
+                glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        }
+        return formats > 0;
+    }
+
+    static uint64_t key(const AssetSpan& vertexCode, const AssetSpan& fragmentCode)
+    {
+        std::string identity = driverIdentity();
+        uint64_t hash = AssetPack::hashName(identity.data(), identity.size());
+        hash = combine(hash, vertexCode);
+        hash = combine(hash, fragmentCode);
+        return hash;
+    }
+
+    // fills `program` from the cache; on a miss or rejection returns false and the
+    // program can still be built from source as usual
+    static bool load(uint64_t cacheKey, unsigned int program)
+    {
+        if (!supported())
+            return false;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::vector<char> file;
+        if (!AssetPack::readWholeFile(pathFor(cacheKey), file) || file.size() < sizeof(ProgramCacheHeader))
+        {
+            stats().misses++;
+            return false;
+        }
+
+        ProgramCacheHeader header;
+        memcpy(&header, file.data(), sizeof(header));
+        bool valid = header.magic == PROGRAM_CACHE_MAGIC
+            && header.version == PROGRAM_CACHE_VERSION
+            && header.key == cacheKey
+            && header.length == file.size() - sizeof(header);
+        GLint linked = GL_FALSE;
+        if (valid)
+        {
+            glProgramBinary(program, header.binaryFormat, file.data() + sizeof(header), (GLsizei)header.length);
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        }
+        if (!linked)
+        {
+            stats().rejected++;
+            stats().misses++;
+            remove(pathFor(cacheKey).c_str());
+            return false;
+        }
+
+        double ms = elapsedMs(start);
+        stats().hits++;
+        stats().loadMs += ms;
+        stats().savedMs += header.compileMs - ms;
+        return true;
+    }
+
+    // call before glLinkProgram on a miss so the driver keeps a retrievable binary
+    static void prepare(unsigned int program)
+    {
+        if (supported())
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // writes a freshly linked program; compileMs is what a later hit will have saved
+    static void store(uint64_t cacheKey, unsigned int program, double compileMs)
+    {
+        stats().compileMs += compileMs;
+        GLint linked = GL_FALSE, length = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!supported() || !linked)
+            return;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        std::vector<char> binary((size_t)length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, &length, &format, binary.data());
+
+        ProgramCacheHeader header;
+        header.magic = PROGRAM_CACHE_MAGIC;
+        header.version = PROGRAM_CACHE_VERSION;
+        header.key = cacheKey;
+        header.binaryFormat = format;
+        header.length = (uint32_t)length;
+        header.compileMs = (float)compileMs;
+        header.reserved = 0;
+
+        makeDirectory(FileSystem::getPath(PROGRAM_CACHE_DIR));
+        std::string path = pathFor(cacheKey);
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            std::cout << "ERROR::PROGRAMCACHE::CANNOT_WRITE: " << path << std::endl;
+            return;
+        }
+        fwrite(&header, sizeof(header), 1, file);
+        fwrite(binary.data(), 1, (size_t)length, file);
+        bool ok = ferror(file) == 0;
+        fclose(file);
+        if (ok)
+            stats().stored++;
+        else
+            remove(path.c_str());
+    }
+
+    static ProgramCacheStats& stats()
+    {
+        static ProgramCacheStats cacheStats;
+        return cacheStats;
+    }
+
+    static void printStats()
+    {
+        const ProgramCacheStats& s = stats();
+        unsigned int lookups = s.hits + s.misses;
+        std::cout << "Program cache" << (supported() ? "" : " (unsupported)") << ": "
+            << s.hits << "/" << lookups << " hits, " << s.rejected << " rejected, " << s.stored << " stored, "
+            << s.compileMs << " ms compiling, " << s.loadMs << " ms loading, ~" << s.savedMs << " ms saved" << std::endl;
+    }
+
+    static double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    static std::string driverIdentity()
+    {
+        std::string identity;
+        const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        for (GLenum name : names)
+        {
+            const GLubyte* value = glGetString(name);
+            identity += value ? reinterpret_cast<const char*>(value) : "?";
+            identity += '\n';
+        }
+        return identity;
+    }
+
+    // continues FNV-1a over another block (with a length prefix so "ab"+"c" != "a"+"bc")
+    static uint64_t combine(uint64_t hash, const AssetSpan& span)
+    {
+        uint64_t length = span.size;
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&length);
+        for (size_t i = 0; i < sizeof(length); i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        for (size_t i = 0; i < span.size; i++)
+        {
+            hash ^= (unsigned char)span.data[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static std::string pathFor(uint64_t cacheKey)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)cacheKey);
+        return FileSystem::getPath(std::string(PROGRAM_CACHE_DIR) + "/" + name);
+    }
+
+    static void makeDirectory(const std::string& path)
+    {
+#ifdef _WIN32
+        _mkdir(path.c_str());
+#else
+        mkdir(path.c_str(), 0755);
+#endif
+    }
+};
+
+// PROGRAMCACHE_H
+#endif
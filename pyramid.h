@@ -40,8 +40,7 @@ public:
         // Default transform
         scale = glm::vec3(1.0f);
         position = glm::vec3(0.0f);
-        rotationAxis = glm::vec3(0.0f, 1.0f, 0.0f);
-        rotationAngle = 0.0f;
+        rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
     }
 
     virtual ~Pyramid()
@@ -77,11 +76,7 @@ public:
         glUseProgram(shaderID);
 
         // Build the model matrix from position/rotation/scale
-        glm::mat4 model(1.0f);
-        model = glm::translate(model, position);
-        if (rotationAngle != 0.0f)
-            model = glm::rotate(model, glm::radians(rotationAngle), rotationAxis);
-        model = glm::scale(model, scale);
+        glm::mat4 model = modelMatrix();
 
         // Pass uniforms (assuming your shader has "model", "view", "projection")
         GLint locModel = glGetUniformLocation(shaderID, "model");
@@ -100,5 +95,16 @@ public:
 
         glBindVertexArray(0);
     }
+
+    // Non-indexed triangles, so the index list just counts up
+    virtual void getMesh(std::vector<float>& meshVertices, std::vector<unsigned int>& indices) const override
+    {
+        meshVertices.assign(std::begin(vertices), std::end(vertices));
+        indices.resize(meshVertices.size() / 3);
+        for (size_t i = 0; i < indices.size(); i++)
+            indices[i] = (unsigned int)i;
+    }
+
+    virtual std::string meshKey() const override { return "pyramid"; }
 };
 #pragma once
@@ -0,0 +1,109 @@
+#ifndef REDRAWGATE_H
+#define REDRAWGATE_H
+
+#include "imgui.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Decides per frame whether the scene has to be drawn and swapped, so an idle
+// sandbox sleeps in glfwWaitEventsTimeout() instead of redrawing an unchanged
+// picture. The UI is built first every frame (it is cheap next to the scene)
+// and a frame is drawn when
+// - input arrived (or the window asked to be redrawn), and for SETTLE_FRAMES
+//   after it, since ImGui shows some results of an input a frame or two later;
+// - the scene key changed: a hash of what the scene is drawn from that can
+//   change without input (camera, window size, streamed chunks, geometry), or
+//   the scene is animating;
+// - after an idle wait, the UI's draw data differs from the last one presented
+//   (timings, progress bars). Such UI-only changes count once per wait, or a
+//   frame showing its own timings would keep the loop busy forever, so while
+//   idle they are refreshed every IDLE_TIMEOUT.
+// No GL or GLFW calls here.
+class RedrawGate
+{
+public:
+    static constexpr double IDLE_TIMEOUT = 0.5;    // seconds
+    static const int SETTLE_FRAMES = 3;
+
+    // FNV-1a over the values added, in order
+    struct Key
+    {
+        uint64_t value = 14695981039346656037ull;
+
+        Key& addBytes(const void* data, size_t size)
+        {
+            const unsigned char* bytes = (const unsigned char*)data;
+            for (size_t i = 0; i < size; i++)
+                value = (value ^ bytes[i]) * 1099511628211ull;
+            return *this;
+        }
+
+        template <typename T>
+        Key& add(const T& v) { return addBytes(&v, sizeof(T)); }
+    };
+
+    // everything ImGui_ImplOpenGL3_RenderDrawData() would draw: vertices,
+    // indices, and per command the clip rect, texture, range and callback
+    static uint64_t hashDrawData(const ImDrawData* drawData)
+    {
+        Key key;
+        if (!drawData || !drawData->Valid)
+            return key.value;
+        key.add(drawData->DisplayPos).add(drawData->DisplaySize).add(drawData->FramebufferScale).add(drawData->CmdListsCount);
+        for (int n = 0; n < drawData->CmdListsCount; n++)
+        {
+            const ImDrawList* list = drawData->CmdLists[n];
+            key.addBytes(list->VtxBuffer.Data, (size_t)list->VtxBuffer.Size * sizeof(ImDrawVert));
+            key.addBytes(list->IdxBuffer.Data, (size_t)list->IdxBuffer.Size * sizeof(ImDrawIdx));
+            for (const ImDrawCmd& cmd : list->CmdBuffer)
+            {
+                key.add(cmd.ClipRect).add(cmd.TextureId).add(cmd.VtxOffset).add(cmd.IdxOffset).add(cmd.ElemCount);
+                key.add(cmd.UserCallback).add(cmd.UserCallbackData);
+            }
+        }
+        return key.value;
+    }
+
+    // wait for events instead of polling before the next frame
+    bool idle() const { return m_Settle == 0 && !m_FirstFrame; }
+
+    // after the UI is built: input = events since the last frame; animating =
+    // the scene moves by itself. Returns whether to draw and swap this frame.
+    bool shouldDraw(bool input, uint64_t sceneKey, bool animating, uint64_t drawDataHash)
+    {
+        bool afterWait = idle();
+        bool sceneChanged = animating || sceneKey != m_SceneKey || m_FirstFrame;
+        m_SceneKey = sceneKey;
+        m_FirstFrame = false;
+        if (input || sceneChanged)
+            m_Settle = SETTLE_FRAMES + 1;   // this frame and the settling ones
+        bool draw = m_Settle > 0 || (afterWait && drawDataHash != m_PresentedUi);
+        if (m_Settle > 0)
+            m_Settle--;
+        if (draw)
+        {
+            m_PresentedUi = drawDataHash;
+            m_DrawnFrames++;
+        }
+        else
+        {
+            m_SkippedFrames++;
+        }
+        return draw;
+    }
+
+    int drawnFrames() const { return m_DrawnFrames; }
+    int skippedFrames() const { return m_SkippedFrames; }
+
+private:
+    uint64_t m_SceneKey = 0;
+    uint64_t m_PresentedUi = 0;
+    int m_Settle = 0;
+    bool m_FirstFrame = true;
+    int m_DrawnFrames = 0;
+    int m_SkippedFrames = 0;
+};
+
+// REDRAWGATE_H
+#endif
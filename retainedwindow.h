@@ -0,0 +1,203 @@
+#ifndef RETAINEDWINDOW_H
+#define RETAINEDWINDOW_H
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <cstdint>
+#include <cstring>
+
+// Opt-in retained mode for one top-level ImGui window: when nothing the
+// window's draw list depends on changed since the last frame, the widgets are
+// not submitted at all and the previous frame's vertices, indices and commands
+// (clip rects included) are put back into the window's draw list instead.
+//
+//     if (retained.begin("Stats", contentKey, retain))
+//     {
+//         ... widgets ...
+//     }
+//     retained.end();
+//
+// contentKey stands for everything the widgets show (values, labels, which
+// widgets there are); the caller hashes it, RedrawGate::Key does. The rest is
+// checked here, and any difference rebuilds the window:
+// - the previous frame was built or retained (the cache is from the last frame);
+// - position, size, scroll and collapsed state, the display size, the font,
+//   its texture and the style;
+// - focus (title bar colour) and, in the focused window, the nav cursor;
+// - any interaction: the window (or a window it is the root of) is hovered,
+//   holds the active item or is being moved, or a keyboard / gamepad nav
+//   request is pending in it. The frame the interaction ends is rebuilt too,
+//   since the cache was built in a frame that showed it.
+// Clip rects are absolute screen coordinates, so a cache is only valid at the
+// same position and display size, which the checks above ensure. Child
+// windows and popups have draw lists of their own, which are not retained:
+// only use this for windows without them.
+// No GL calls here.
+class RetainedWindow
+{
+public:
+    // Begins the window with ImGui::Begin(); returns whether its contents
+    // must be submitted (false when collapsed, clipped or retained). end()
+    // must be called either way.
+    bool begin(const char* name, uint64_t contentKey, bool retain, bool* open = nullptr, ImGuiWindowFlags flags = 0)
+    {
+        ImGuiContext& g = *GImGui;
+        bool visible = ImGui::Begin(name, open, flags);
+        m_Window = ImGui::GetCurrentWindow();
+        m_Retain = retain;
+
+        State state = capture(m_Window, contentKey);
+        m_Reused = retain && visible && m_Valid && m_Frame == g.FrameCount - 1 && !state.interacting && !m_State.interacting &&
+            same(state, m_State);
+        m_State = state;
+        m_Visible = visible;
+        if (m_Reused)
+        {
+            // nothing is submitted: keep the content size of the built frame,
+            // which the next Begin() sizes the scrollbars and auto-fit from
+            m_Window->DC.CursorMaxPos = offset(m_Window->DC.CursorStartPos, m_ContentMax, 1.0f);
+            m_Window->DC.IdealMaxPos = offset(m_Window->DC.CursorStartPos, m_IdealMax, 1.0f);
+            m_Window->DC.NavLayersActiveMaskNext = m_NavLayers;
+            return false;
+        }
+        return visible;
+    }
+
+    void end()
+    {
+        ImGuiContext& g = *GImGui;
+        ImGuiWindow* window = m_Window;
+        if (!m_Reused)
+        {
+            m_ContentMax = offset(window->DC.CursorMaxPos, window->DC.CursorStartPos, -1.0f);
+            m_IdealMax = offset(window->DC.IdealMaxPos, window->DC.CursorStartPos, -1.0f);
+            m_NavLayers = window->DC.NavLayersActiveMaskNext;
+        }
+        ImGui::End();
+
+        ImDrawList* list = window->DrawList;
+        if (m_Reused)
+        {
+            // Begin() drew the window's frame again; replace all of it
+            list->CmdBuffer = m_Cmds;
+            list->IdxBuffer = m_Indices;
+            list->VtxBuffer = m_Vertices;
+            list->_CmdHeader = m_Header;
+            list->_VtxCurrentIdx = m_VtxCurrentIdx;
+            list->_VtxWritePtr = list->VtxBuffer.Data + list->VtxBuffer.Size;
+            list->_IdxWritePtr = list->IdxBuffer.Data + list->IdxBuffer.Size;
+            counts()[1]++;
+        }
+        else if (m_Retain && m_Visible && window->ParentWindow == nullptr)
+        {
+            m_Cmds = list->CmdBuffer;
+            m_Indices = list->IdxBuffer;
+            m_Vertices = list->VtxBuffer;
+            m_Header = list->_CmdHeader;
+            m_VtxCurrentIdx = list->_VtxCurrentIdx;
+            m_Valid = true;
+            counts()[0]++;
+        }
+        else
+        {
+            m_Valid = false;
+            counts()[0]++;
+        }
+        m_Frame = g.FrameCount;
+    }
+
+    // whether the last begin() / end() reused the previous frame's draw list
+    bool reused() const { return m_Reused; }
+
+    // windows built and retained since the last call, over all instances
+    static void takeCounts(int* built, int* reused)
+    {
+        *built = counts()[0];
+        *reused = counts()[1];
+        counts()[0] = counts()[1] = 0;
+    }
+
+private:
+    struct State
+    {
+        uint64_t content = 0;
+        ImVec2 pos, size, scroll, displaySize;
+        bool collapsed = false;
+        bool focused = false;
+        bool interacting = false;
+        ImGuiID navId = 0;
+        bool navVisible = false;
+        ImFont* font = nullptr;
+        float fontSize = 0.0f;
+        ImTextureID texture = ImTextureID();
+        unsigned char style[sizeof(ImGuiStyle)];  // the bytes, padding and all
+    };
+
+    static bool isIn(const ImGuiWindow* other, const ImGuiWindow* window)
+    {
+        return other != nullptr && other->RootWindow == window;
+    }
+
+    static State capture(ImGuiWindow* window, uint64_t contentKey)
+    {
+        ImGuiContext& g = *GImGui;
+        State s;
+        s.content = contentKey;
+        s.pos = window->Pos;
+        s.size = window->Size;
+        s.scroll = window->Scroll;
+        s.displaySize = g.IO.DisplaySize;
+        s.collapsed = window->Collapsed;
+        s.focused = isIn(g.NavWindow, window);
+        s.navId = s.focused ? g.NavId : 0;
+        s.navVisible = s.focused && !g.NavDisableHighlight;
+        s.interacting = isIn(g.HoveredWindow, window) || isIn(g.MovingWindow, window) ||
+            (g.ActiveId != 0 && isIn(g.ActiveIdWindow, window)) || g.NavWindowingTarget != nullptr ||
+            (s.focused && (g.NavMoveScoringItems || g.NavInitRequest || g.NavActivateId != 0 || g.NavNextActivateId != 0)) ||
+            window->Appearing || window->HiddenFramesCanSkipItems > 0 || window->HiddenFramesCannotSkipItems > 0;
+        s.font = g.Font;
+        s.fontSize = g.FontSize;
+        s.texture = g.Font->ContainerAtlas->TexID;
+        memcpy(s.style, &g.Style, sizeof(ImGuiStyle));
+        return s;
+    }
+
+    static int* counts()
+    {
+        static int built_reused[2] = { 0, 0 };
+        return built_reused;
+    }
+
+    static ImVec2 offset(const ImVec2& a, const ImVec2& b, float sign) { return ImVec2(a.x + sign * b.x, a.y + sign * b.y); }
+
+    static bool sameVec(const ImVec2& a, const ImVec2& b) { return a.x == b.x && a.y == b.y; }
+
+    static bool same(const State& a, const State& b)
+    {
+        return a.content == b.content && sameVec(a.pos, b.pos) && sameVec(a.size, b.size) && sameVec(a.scroll, b.scroll) &&
+            sameVec(a.displaySize, b.displaySize) && a.collapsed == b.collapsed && a.focused == b.focused &&
+            a.navId == b.navId && a.navVisible == b.navVisible && a.font == b.font && a.fontSize == b.fontSize &&
+            a.texture == b.texture && memcmp(a.style, b.style, sizeof(ImGuiStyle)) == 0;
+    }
+
+    ImGuiWindow* m_Window = nullptr;
+    State m_State;
+    bool m_Retain = false;
+    bool m_Visible = false;
+    bool m_Valid = false;
+    bool m_Reused = false;
+    int m_Frame = -1;
+
+    // the last built frame
+    ImVector<ImDrawCmd> m_Cmds;
+    ImVector<ImDrawIdx> m_Indices;
+    ImVector<ImDrawVert> m_Vertices;
+    ImDrawCmdHeader m_Header = {};
+    unsigned int m_VtxCurrentIdx = 0;
+    ImVec2 m_ContentMax, m_IdealMax;
+    short m_NavLayers = 0;
+};
+
+// RETAINEDWINDOW_H
+#endif
@@ -0,0 +1,259 @@
+#ifndef SDFFONT_H
+#define SDFFONT_H
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include "fontatlascache.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_MODULE_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// What the last SdfFont::build() did
+struct SdfFontStats
+{
+    bool hit = false;
+    double buildMs = 0.0;   // all of it: hashing and loading, or rendering the distance fields, packing and storing
+    size_t fileBytes = 0;
+    int glyphs = 0;
+    int width = 0;
+    int height = 0;
+    float bakeSize = 0.0f;
+};
+
+// Bumped when the glyphs build() renders change for the same font and settings
+const uint32_t SDF_FONT_VERSION = 1;
+
+// A signed distance field font: every glyph is rendered once by FreeType at
+// bakeSize pixels into an ImFontAtlas of its own, where a texel holds the
+// distance to the outline (128 on it, more inside, spread pixels to either
+// end of the range) instead of coverage. Drawn with
+// distance-field sampling (ImGui_ImplOpenGL3_SetSdfFontAtlas()), the same
+// glyphs stay crisp at any size, so changing the UI scale is font->Scale or
+// io.FontGlobalScale and never an atlas rebuild.
+//
+// The glyphs are custom rects of the atlas (ImFont::RenderText() scales
+// their quads like any other glyph); glyphs without an outline (space) are
+// left to ImGui's own builder, which gives them their advance. The white
+// pixel and the baked lines are ImGui's as usual: far inside an outline and
+// a ramp through it, they draw the same sampled either way.
+// The distances come from the glyph's coverage bitmap (FreeType's "bsdf"
+// renderer): unlike the outline renderer it copes with overlapping contours,
+// such as the pixel squares of the default font, and is faster. It is still
+// about a millisecond per glyph, so the baked atlas goes through the font
+// cache (see fontatlascache.h), keyed by the font data and the settings here.
+// No GL calls here.
+class SdfFont
+{
+public:
+    static constexpr float BAKE_SIZE = 32.0f;   // pixels, ascender to descender like ImFontConfig::SizePixels
+    static const int SPREAD = 4;                // pixels of distance on each side of the outline
+
+    // adds the font (TTF/OTF data, only read during the call) to an empty
+    // atlas and builds it, from the font cache when allowed; the font draws
+    // at displaySize pixels. nullptr when FreeType cannot load it.
+    static ImFont* build(ImFontAtlas* atlas, const void* fontData, int fontDataSize, float displaySize,
+        const ImWchar* ranges = nullptr, float bakeSize = BAKE_SIZE, int spread = SPREAD, bool useCache = true)
+    {
+        SdfFontStats& s = stats();
+        s = SdfFontStats();
+        s.bakeSize = bakeSize;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (!ranges)
+            ranges = atlas->GetGlyphRangesDefault();
+
+        ImFontConfig config;
+        config.FontDataOwnedByAtlas = false;
+        config.OversampleH = config.OversampleV = 1;
+        snprintf(config.Name, sizeof(config.Name), "SDF, %.0fpx", bakeSize);
+        atlas->Flags |= ImFontAtlasFlags_NoMouseCursors;
+
+        // the font cache keeps its own stats of the UI atlas
+        FontAtlasCacheStats atlasStats = FontAtlasCache::stats();
+        FontAtlasCache::stats().fileBytes = 0;
+        uint64_t cacheKey = key(fontData, fontDataSize, ranges, bakeSize, spread);
+        std::string path = FontAtlasCache::pathFor(cacheKey);
+        ImFont* font = nullptr;
+        if (useCache)
+        {
+            font = atlas->AddFontFromMemoryTTF((void*)fontData, fontDataSize, bakeSize, &config, ranges);
+            s.hit = FontAtlasCache::load(atlas, cacheKey, path);
+            if (!s.hit)
+            {
+                atlas->Clear();
+                atlas->Flags |= ImFontAtlasFlags_NoMouseCursors;
+            }
+        }
+        if (!s.hit)
+        {
+            font = bake(atlas, fontData, fontDataSize, ranges, bakeSize, spread, config);
+            if (font && useCache)
+            {
+                FontAtlasCache::makeDirectory(FileSystem::getPath(FONT_ATLAS_CACHE_DIR));
+                FontAtlasCache::store(atlas, cacheKey, path);
+            }
+        }
+        s.fileBytes = FontAtlasCache::stats().fileBytes;
+        FontAtlasCache::stats() = atlasStats;
+        if (!font)
+            return nullptr;
+
+        // the font data and the custom rects were only needed to build
+        atlas->ClearInputData();
+        font->Scale = displaySize / bakeSize;
+
+        s.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        s.glyphs = font->Glyphs.Size;
+        s.width = atlas->TexWidth;
+        s.height = atlas->TexHeight;
+        return font;
+    }
+
+    // the font cache key: the font, the ranges and how the glyphs are rendered
+    static uint64_t key(const void* fontData, int fontDataSize, const ImWchar* ranges, float bakeSize, int spread)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        int versions[6] = { (int)SDF_FONT_VERSION, IMGUI_VERSION_NUM, FREETYPE_MAJOR, FREETYPE_MINOR, FREETYPE_PATCH,
+            (int)sizeof(ImFontGlyph) };
+        hash = FontAtlasCache::combine(hash, versions, sizeof(versions));
+        hash = FontAtlasCache::combine(hash, fontData, (size_t)fontDataSize);
+        size_t rangeCount = 0;
+        while (ranges[rangeCount] != 0)
+            rangeCount++;
+        hash = FontAtlasCache::combine(hash, ranges, rangeCount * sizeof(ImWchar));
+        hash = FontAtlasCache::combine(hash, &bakeSize, sizeof(bakeSize));
+        hash = FontAtlasCache::combine(hash, &spread, sizeof(spread));
+        return hash;
+    }
+
+    static SdfFontStats& stats()
+    {
+        static SdfFontStats fontStats;
+        return fontStats;
+    }
+
+    static void printStats()
+    {
+        const SdfFontStats& s = stats();
+        std::cout << "SDF font: " << s.width << "x" << s.height << ", " << s.glyphs << " glyphs at " << s.bakeSize << " px, "
+            << (s.hit ? "cached: " : "baked: ") << s.buildMs << " ms, " << s.fileBytes / 1024 << " KB file" << std::endl;
+    }
+
+private:
+    struct Glyph
+    {
+        ImWchar codepoint = 0;
+        int width = 0;
+        int height = 0;
+        ImVec2 offset;
+        float advance = 0.0f;
+        int rect = -1;
+        std::vector<unsigned char> pixels;
+    };
+
+    // renders the glyphs with FreeType and builds the atlas around them
+    static ImFont* bake(ImFontAtlas* atlas, const void* fontData, int fontDataSize, const ImWchar* ranges, float bakeSize,
+        int spread, ImFontConfig config)
+    {
+        FT_Library library;
+        if (FT_Init_FreeType(&library) != 0)
+        {
+            std::cout << "ERROR::SDF_FONT::FREETYPE_NOT_INITIALIZED" << std::endl;
+            return nullptr;
+        }
+        FT_Int ftSpread = spread;
+        FT_Property_Set(library, "bsdf", "spread", &ftSpread);
+        FT_Face face;
+        if (FT_New_Memory_Face(library, (const FT_Byte*)fontData, fontDataSize, 0, &face) != 0)
+        {
+            std::cout << "ERROR::SDF_FONT::FACE_NOT_LOADED" << std::endl;
+            FT_Done_FreeType(library);
+            return nullptr;
+        }
+        // the pixel size stb_truetype (and so ImGui) means: ascender to descender
+        FT_Size_RequestRec request = {};
+        request.type = FT_SIZE_REQUEST_TYPE_REAL_DIM;
+        request.height = (FT_Long)(bakeSize * 64.0f);
+        FT_Request_Size(face, &request);
+        float ascent = face->size->metrics.ascender / 64.0f;
+        float descent = face->size->metrics.descender / 64.0f;
+
+        std::vector<Glyph> glyphs;
+        ImFontGlyphRangesBuilder blank;
+        for (const ImWchar* range = ranges; range[0] && range[1]; range += 2)
+        {
+            for (unsigned int c = range[0]; c <= range[1]; c++)
+            {
+                FT_UInt index = FT_Get_Char_Index(face, c);
+                if (index == 0 || FT_Load_Glyph(face, index, FT_LOAD_NO_HINTING | FT_LOAD_NO_BITMAP) != 0)
+                    continue;
+                FT_GlyphSlot slot = face->glyph;
+                if (slot->format != FT_GLYPH_FORMAT_OUTLINE || slot->outline.n_points == 0)
+                {
+                    blank.AddChar((ImWchar)c);
+                    continue;
+                }
+                // coverage first, then its distance field
+                if (FT_Render_Glyph(slot, FT_RENDER_MODE_NORMAL) != 0 || FT_Render_Glyph(slot, FT_RENDER_MODE_SDF) != 0 ||
+                    slot->bitmap.width == 0 || slot->bitmap.rows == 0)
+                    continue;
+
+                Glyph glyph;
+                glyph.codepoint = (ImWchar)c;
+                glyph.width = (int)slot->bitmap.width;
+                glyph.height = (int)slot->bitmap.rows;
+                glyph.offset = ImVec2((float)slot->bitmap_left, ascent - (float)slot->bitmap_top);
+                glyph.advance = slot->linearHoriAdvance / 65536.0f;
+                glyph.pixels.resize((size_t)glyph.width * glyph.height);
+                for (int y = 0; y < glyph.height; y++)
+                {
+                    const unsigned char* row = slot->bitmap.pitch >= 0 ? slot->bitmap.buffer + y * slot->bitmap.pitch
+                        : slot->bitmap.buffer + (glyph.height - 1 - y) * -slot->bitmap.pitch;
+                    memcpy(&glyph.pixels[(size_t)y * glyph.width], row, (size_t)glyph.width);
+                }
+                glyphs.push_back(glyph);
+            }
+        }
+        FT_Done_Face(face);
+        FT_Done_FreeType(library);
+
+        // ImGui's builder only sees the blank glyphs; the rest are custom rects
+        ImVector<ImWchar> blankRanges;
+        blank.BuildRanges(&blankRanges);
+        ImFont* font = atlas->AddFontFromMemoryTTF((void*)fontData, fontDataSize, bakeSize, &config, blankRanges.Data);
+        for (Glyph& glyph : glyphs)
+            glyph.rect = atlas->AddCustomRectFontGlyph(font, glyph.codepoint, glyph.width, glyph.height, glyph.advance, glyph.offset);
+        bool built = atlas->Build();
+        atlas->ConfigData.back().GlyphRanges = nullptr;    // blankRanges goes out of scope
+        if (!built)
+        {
+            std::cout << "ERROR::SDF_FONT::ATLAS_NOT_BUILT" << std::endl;
+            return nullptr;
+        }
+
+        unsigned char* pixels = nullptr;
+        int width = 0, height = 0;
+        atlas->GetTexDataAsAlpha8(&pixels, &width, &height);
+        for (const Glyph& glyph : glyphs)
+        {
+            const ImFontAtlasCustomRect* rect = atlas->GetCustomRectByIndex(glyph.rect);
+            for (int y = 0; y < glyph.height; y++)
+                memcpy(pixels + (size_t)(rect->Y + y) * width + rect->X, &glyph.pixels[(size_t)y * glyph.width], (size_t)glyph.width);
+        }
+        font->Ascent = ascent;
+        font->Descent = descent;
+        return font;
+    }
+};
+
+// SDFFONT_H
+#endif
@@ -4,10 +4,30 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "programcache.h"
+#include "shaderpreprocessor.h"
+#include "vfs.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// Counters shared by every Shader (variants, shared stages, time spent compiling)
+struct ShaderCompileStats
+{
+    unsigned int programsLinked = 0;
+    unsigned int stagesCompiled = 0;
+    unsigned int stagesShared = 0;   // stage compiles avoided because an identical source was already compiled
+    double compileMs = 0.0;
+};
 
 class Shader
 {
@@ -15,61 +35,130 @@ public:
     unsigned int ID;
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath)
-    {
-        // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
+    Shader(const char* vertexPath, const char* fragmentPath, const ShaderDefines& defines = ShaderDefines())
+        : m_VertexPath(vertexPath), m_FragmentPath(fragmentPath), m_Defines(defines)
+    {
+        // 1. retrieve the vertex/fragment source code with #includes expanded and defines injected
+        std::string vertexCode, fragmentCode;
+        preprocess(m_VertexPath, m_FragmentPath, m_Defines, vertexCode, fragmentCode, m_Files);
+        build(vertexCode, fragmentCode);
+    }
+    // from sources the caller already expanded with preprocess(); files are
+    // the ones they were read from, watched for hot reload
+    Shader(const char* vertexPath, const char* fragmentPath, const ShaderDefines& defines, const std::string& vertexCode,
+        const std::string& fragmentCode, const std::vector<std::string>& files)
+        : m_VertexPath(vertexPath), m_FragmentPath(fragmentPath), m_Defines(defines), m_Files(files)
+    {
+        build(vertexCode, fragmentCode);
+    }
+    ~Shader()
+    {
+        discardReload();
+    }
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+    // expands both stages and lists the files they were read from; sources of
+    // a stage that can't be read are left empty so compilation reports the
+    // failure. Returns false if either stage failed.
+    static bool preprocess(const std::string& vertexPath, const std::string& fragmentPath, const ShaderDefines& defines,
+        std::string& vertexCode, std::string& fragmentCode, std::vector<std::string>& files)
+    {
+        std::vector<std::string> vertexFiles, fragmentFiles;
+        bool ok = ShaderPreprocessor::process(vertexPath, defines, vertexCode, vertexFiles);
+        if (!ok)
+            vertexCode.clear();
+        if (!ShaderPreprocessor::process(fragmentPath, defines, fragmentCode, fragmentFiles))
         {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
+            fragmentCode.clear();
+            ok = false;
         }
-        catch (std::ifstream::failure& e)
+        files = vertexFiles;
+        for (const std::string& file : fragmentFiles)
+            if (std::find(files.begin(), files.end(), file) == files.end())
+                files.push_back(file);
+        return ok;
+    }
+
+    const std::string& vertexPath() const { return m_VertexPath; }
+    const std::string& fragmentPath() const { return m_FragmentPath; }
+    const ShaderDefines& defines() const { return m_Defines; }
+    // every source file the program was built from, including #included ones
+    const std::vector<std::string>& files() const { return m_Files; }
+
+    static ShaderCompileStats& compileStats()
+    {
+        static ShaderCompileStats stats;
+        return stats;
+    }
+
+    // hot reload: rereads the loose source files and submits compile + link, but
+    // doesn't wait for them. The current program stays live in the meantime.
+    // ------------------------------------------------------------------------
+    void beginReload()
+    {
+        discardReload();
+        std::string vertexCode, fragmentCode;
+        if (!preprocess(m_VertexPath, m_FragmentPath, m_Defines, vertexCode, fragmentCode, m_Files))
         {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+            std::cout << "ERROR::SHADER::RELOAD_READ_FAILED: " << m_VertexPath << ", " << m_FragmentPath << std::endl;
+            return;
         }
+        m_PendingKey = ProgramCache::key(spanOf(vertexCode), spanOf(fragmentCode));
+        m_PendingStart = std::chrono::steady_clock::now();
+
         const char* vShaderCode = vertexCode.c_str();
         const char* fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        m_PendingVertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(m_PendingVertex, 1, &vShaderCode, NULL);
+        glCompileShader(m_PendingVertex);
+        m_PendingFragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(m_PendingFragment, 1, &fShaderCode, NULL);
+        glCompileShader(m_PendingFragment);
+        m_PendingProgram = glCreateProgram();
+        glAttachShader(m_PendingProgram, m_PendingVertex);
+        glAttachShader(m_PendingProgram, m_PendingFragment);
+        ProgramCache::prepare(m_PendingProgram);
+        glLinkProgram(m_PendingProgram);
+    }
+    // polls a pending reload; returns true on the frame the new program replaces ID.
+    // A program that fails to compile or link is dropped and the old one kept.
+    // ------------------------------------------------------------------------
+    bool updateReload()
+    {
+        if (!m_PendingProgram)
+            return false;
+        // with KHR_parallel_shader_compile this query never blocks; without it the
+        // link status is only asked for a frame after submission, which lets
+        // threaded drivers finish in the background
+        if (parallelCompile())
+        {
+            GLint done = GL_FALSE;
+            glGetProgramiv(m_PendingProgram, GL_COMPLETION_STATUS_KHR, &done);
+            if (!done)
+                return false;
+        }
 
+        GLint linked = GL_FALSE;
+        glGetProgramiv(m_PendingProgram, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            checkCompileErrors(m_PendingVertex, "VERTEX");
+            checkCompileErrors(m_PendingFragment, "FRAGMENT");
+            checkCompileErrors(m_PendingProgram, "PROGRAM");
+            std::cout << "Shader reload failed, keeping the previous program: " << m_VertexPath << ", " << m_FragmentPath << std::endl;
+            discardReload();
+            return false;
+        }
+
+        ProgramCache::store(m_PendingKey, m_PendingProgram, ProgramCache::elapsedMs(m_PendingStart));
+        glDeleteProgram(ID);
+        ID = m_PendingProgram;
+        m_PendingProgram = 0;
+        discardReload();
+        return true;
     }
+    bool reloadPending() const { return m_PendingProgram != 0; }
     // activate the shader
     // ------------------------------------------------------------------------
     void use() const
@@ -136,6 +225,110 @@ public:
     }
 
 private:
+    std::string m_VertexPath;
+    std::string m_FragmentPath;
+    ShaderDefines m_Defines;
+    std::vector<std::string> m_Files;
+    unsigned int m_PendingProgram = 0;
+    unsigned int m_PendingVertex = 0;
+    unsigned int m_PendingFragment = 0;
+    uint64_t m_PendingKey = 0;
+    std::chrono::steady_clock::time_point m_PendingStart;
+
+    static AssetSpan spanOf(const std::string& text)
+    {
+        AssetSpan span;
+        span.data = text.data();
+        span.size = text.size();
+        return span;
+    }
+
+    // 2. reuse the driver binary from an earlier run if the sources haven't
+    // changed, otherwise compile and link them
+    void build(const std::string& vertexCode, const std::string& fragmentCode)
+    {
+        ID = glCreateProgram();
+        uint64_t cacheKey = ProgramCache::key(spanOf(vertexCode), spanOf(fragmentCode));
+        if (!ProgramCache::load(cacheKey, ID))
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            // 3. compile shaders; a stage whose final source was compiled before
+            // (the same vertex shader in several programs) reuses that shader object
+            bool vertexFailed, fragmentFailed;
+            unsigned int vertex = sharedStage(GL_VERTEX_SHADER, vertexCode, "VERTEX", vertexFailed);
+            unsigned int fragment = sharedStage(GL_FRAGMENT_SHADER, fragmentCode, "FRAGMENT", fragmentFailed);
+            // shader Program
+            glAttachShader(ID, vertex);
+            glAttachShader(ID, fragment);
+            ProgramCache::prepare(ID);
+            glLinkProgram(ID);
+            checkCompileErrors(ID, "PROGRAM");
+            // compiled stages stay alive in the shared cache for later programs
+            glDetachShader(ID, vertex);
+            glDetachShader(ID, fragment);
+            if (vertexFailed) glDeleteShader(vertex);
+            if (fragmentFailed) glDeleteShader(fragment);
+            double ms = ProgramCache::elapsedMs(start);
+            compileStats().programsLinked++;
+            compileStats().compileMs += ms;
+            ProgramCache::store(cacheKey, ID, ms);
+        }
+    }
+
+    // compiles `source` once per unique text; the objects live until exit.
+    // Stages that fail to compile aren't cached and must be deleted by the caller.
+    unsigned int sharedStage(GLenum type, const std::string& source, const char* typeName, bool& failed)
+    {
+        static std::unordered_map<uint64_t, unsigned int> stages;
+        uint64_t hash = AssetPack::hashName(source.data(), source.size()) * 31 + type;
+        auto found = stages.find(hash);
+        failed = false;
+        if (found != stages.end())
+        {
+            compileStats().stagesShared++;
+            return found->second;
+        }
+
+        const char* code = source.c_str();
+        unsigned int stage = glCreateShader(type);
+        glShaderSource(stage, 1, &code, NULL);
+        glCompileShader(stage);
+        checkCompileErrors(stage, typeName);
+        compileStats().stagesCompiled++;
+        GLint success = GL_FALSE;
+        glGetShaderiv(stage, GL_COMPILE_STATUS, &success);
+        failed = !success;
+        if (success)
+            stages.emplace(hash, stage);
+        return stage;
+    }
+
+    void discardReload()
+    {
+        if (m_PendingProgram) glDeleteProgram(m_PendingProgram);
+        if (m_PendingVertex) glDeleteShader(m_PendingVertex);
+        if (m_PendingFragment) glDeleteShader(m_PendingFragment);
+        m_PendingProgram = m_PendingVertex = m_PendingFragment = 0;
+    }
+
+    static bool parallelCompile()
+    {
+        static int supported = -1;
+        if (supported < 0)
+        {
+            supported = 0;
+            GLint count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for (GLint i = 0; i < count; i++)
+            {
+                const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+                if (name && (strcmp(name, "GL_KHR_parallel_shader_compile") == 0 || strcmp(name, "GL_ARB_parallel_shader_compile") == 0))
+                    supported = 1;
+            }
+        }
+        return supported != 0;
+    }
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
@@ -0,0 +1,99 @@
+#ifndef SHADERLIBRARY_H
+#define SHADERLIBRARY_H
+
+#include "shader_m.h"
+#include "shaderpreprocessor.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Owns every shader program. A program is identified by its two stage files
+// plus a permutation (a set of injected defines) and is compiled the first
+// time a material asks for it. Requests that expand to the same final source
+// (e.g. byte-identical copies of a stage file) share one Shader, and identical
+// stages are compiled once across programs (see Shader::sharedStage).
+class ShaderLibrary
+{
+public:
+    static Shader& get(const std::string& vertexPath, const std::string& fragmentPath, const ShaderDefines& defines = ShaderDefines())
+    {
+        Library& library = instance();
+        library.requests++;
+        std::string key = vertexPath + "|" + fragmentPath + "|" + ShaderPreprocessor::permutationKey(defines);
+        auto known = library.byKey.find(key);
+        if (known != library.byKey.end())
+            return *known->second;
+
+        // expand once up front so that equivalent permutations can be detected
+        // before anything is compiled; the Shader is built from the same text
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::string vertexCode, fragmentCode;
+        std::vector<std::string> files;
+        bool expanded = Shader::preprocess(vertexPath, fragmentPath, defines, vertexCode, fragmentCode, files);
+        uint64_t sourceHash = AssetPack::hashName(vertexCode.data(), vertexCode.size())
+            ^ (AssetPack::hashName(fragmentCode.data(), fragmentCode.size()) * 1099511628211ull);
+        library.preprocessMs += ProgramCache::elapsedMs(start);
+
+        // a stage that failed to expand is empty, so its text says nothing
+        // about the program: such a Shader is never shared (hot reload may
+        // still fix it in place)
+        if (expanded)
+        {
+            auto same = library.bySource.find(sourceHash);
+            if (same != library.bySource.end())
+            {
+                library.byKey.emplace(key, same->second);
+                return *same->second;
+            }
+        }
+
+        library.shaders.emplace_back(new Shader(vertexPath.c_str(), fragmentPath.c_str(), defines, vertexCode, fragmentCode, files));
+        Shader* shader = library.shaders.back().get();
+        library.byKey.emplace(key, shader);
+        if (expanded)
+            library.bySource.emplace(sourceHash, shader);
+        return *shader;
+    }
+
+    // every distinct program built so far (for hot reload registration, etc.)
+    static std::vector<Shader*> programs()
+    {
+        std::vector<Shader*> all;
+        for (const std::unique_ptr<Shader>& shader : instance().shaders)
+            all.push_back(shader.get());
+        return all;
+    }
+
+    static void printStats()
+    {
+        const Library& library = instance();
+        const ShaderCompileStats& compile = Shader::compileStats();
+        std::cout << "Shader library: " << library.byKey.size() << " permutations -> " << library.shaders.size() << " programs ("
+            << library.requests << " requests), " << compile.programsLinked << " linked from source, "
+            << compile.stagesCompiled << " stages compiled, " << compile.stagesShared << " shared, "
+            << compile.compileMs << " ms compiling, " << library.preprocessMs << " ms preprocessing" << std::endl;
+    }
+
+private:
+    struct Library
+    {
+        std::vector<std::unique_ptr<Shader>> shaders;
+        std::unordered_map<std::string, Shader*> byKey;
+        std::unordered_map<uint64_t, Shader*> bySource;
+        unsigned int requests = 0;
+        double preprocessMs = 0.0;
+    };
+
+    static Library& instance()
+    {
+        static Library library;
+        return library;
+    }
+};
+
+// SHADERLIBRARY_H
+#endif
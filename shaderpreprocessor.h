@@ -0,0 +1,164 @@
+#ifndef SHADERPREPROCESSOR_H
+#define SHADERPREPROCESSOR_H
+
+#include "vfs.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// name/value pairs injected as `#define name value` after the #version line
+typedef std::vector<std::pair<std::string, std::string>> ShaderDefines;
+
+// Expands GLSL sources before they reach the driver:
+//   #include "file"   pasted in place, resolved relative to the including file
+//   #pragma once      skips a file that was already included
+//   defines           injected right after #version (GLSL requires it first)
+// #line directives keep driver error messages pointing at the right file/line;
+// the source-string number is the file's index in the returned `files` list.
+class ShaderPreprocessor
+{
+public:
+    static bool process(const std::string& path, const ShaderDefines& defines, std::string& source, std::vector<std::string>& files)
+    {
+        source.clear();
+        files.clear();
+        std::vector<std::string> onceFiles;
+        return expand(path, defines, source, files, onceFiles, 0);
+    }
+
+    // canonical text for a define set, independent of the order they were given in
+    static std::string permutationKey(ShaderDefines defines)
+    {
+        std::sort(defines.begin(), defines.end());
+        std::string key;
+        for (const std::pair<std::string, std::string>& define : defines)
+        {
+            key += define.first;
+            if (!define.second.empty())
+                key += "=" + define.second;
+            key += ";";
+        }
+        return key;
+    }
+
+private:
+    static const int MAX_INCLUDE_DEPTH = 16;
+
+    static bool expand(const std::string& path, const ShaderDefines& defines, std::string& out,
+        std::vector<std::string>& files, std::vector<std::string>& onceFiles, int depth)
+    {
+        if (depth > MAX_INCLUDE_DEPTH)
+        {
+            std::cout << "ERROR::SHADER::INCLUDE_TOO_DEEP (recursive include?): " << path << std::endl;
+            return false;
+        }
+        if (std::find(onceFiles.begin(), onceFiles.end(), path) != onceFiles.end())
+            return true;
+
+        AssetSpan span = VFS::read(path);
+        if (!span.valid())
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+            return false;
+        }
+        std::string text(span.data, span.size);
+        VFS::release(path);
+
+        size_t fileIndex = indexOf(files, path);
+
+        int lineNumber = 0;
+        size_t position = 0;
+        while (position < text.size())
+        {
+            size_t end = text.find('\n', position);
+            if (end == std::string::npos)
+                end = text.size();
+            std::string line = text.substr(position, end - position);
+            position = end + 1;
+            lineNumber++;
+
+            std::string directive = directiveOf(line);
+            if (directive == "version")
+            {
+                // only the top-level file keeps its #version; defines must follow it
+                if (depth > 0)
+                    continue;
+                out += line + "\n";
+                for (const std::pair<std::string, std::string>& define : defines)
+                    out += "#define " + define.first + (define.second.empty() ? "" : " " + define.second) + "\n";
+                out += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+            }
+            else if (directive == "pragma" && line.find("once") != std::string::npos)
+            {
+                onceFiles.push_back(path);
+            }
+            else if (directive == "include")
+            {
+                std::string name;
+                if (!includeName(line, name))
+                {
+                    std::cout << "ERROR::SHADER::BAD_INCLUDE: " << path << ":" << lineNumber << std::endl;
+                    return false;
+                }
+                std::string resolved = resolve(path, name);
+                out += "#line 1 " + std::to_string(indexOf(files, resolved)) + "\n";
+                if (!expand(resolved, defines, out, files, onceFiles, depth + 1))
+                    return false;
+                out += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+            }
+            else
+            {
+                out += line + "\n";
+            }
+        }
+        return true;
+    }
+
+    // "  #  include ..." -> "include"; empty for ordinary lines
+    static std::string directiveOf(const std::string& line)
+    {
+        size_t i = line.find_first_not_of(" \t");
+        if (i == std::string::npos || line[i] != '#')
+            return std::string();
+        i = line.find_first_not_of(" \t", i + 1);
+        if (i == std::string::npos)
+            return std::string();
+        size_t end = i;
+        while (end < line.size() && isalpha((unsigned char)line[end]))
+            end++;
+        return line.substr(i, end - i);
+    }
+
+    static bool includeName(const std::string& line, std::string& name)
+    {
+        size_t open = line.find_first_of("\"<");
+        if (open == std::string::npos)
+            return false;
+        size_t close = line.find(line[open] == '"' ? '"' : '>', open + 1);
+        if (close == std::string::npos || close == open + 1)
+            return false;
+        name = line.substr(open + 1, close - open - 1);
+        return true;
+    }
+
+    static std::string resolve(const std::string& includer, const std::string& name)
+    {
+        size_t slash = includer.find_last_of("/\\");
+        return slash == std::string::npos ? name : includer.substr(0, slash + 1) + name;
+    }
+
+    static size_t indexOf(std::vector<std::string>& files, const std::string& path)
+    {
+        size_t index = std::find(files.begin(), files.end(), path) - files.begin();
+        if (index == files.size())
+            files.push_back(path);
+        return index;
+    }
+};
+
+// SHADERPREPROCESSOR_H
+#endif
@@ -0,0 +1,125 @@
+#ifndef SHADERRELOAD_H
+#define SHADERRELOAD_H
+
+#include "filewatcher.h"
+#include "filesystem.h"
+#include "shader_m.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Watches the loose source files (including #includes) of a set of Shaders and hot reloads them.
+// All work is spread over update() calls (one per frame), so a reload never
+// stalls rendering; the frame cost of each reload is measured and reported.
+class ShaderReloader
+{
+public:
+    void watch(Shader& shader)
+    {
+        for (const Watched& watched : m_Shaders)
+            if (watched.shader == &shader)
+                return;
+        Watched watched;
+        watched.shader = &shader;
+        m_Shaders.push_back(watched);
+        watchFiles(m_Shaders.back());
+    }
+
+    // returns the shaders whose program (ID) was replaced during this call, so
+    // the caller can restore uniforms that were only set once
+    std::vector<Shader*> update()
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::vector<Shader*> swapped;
+
+        m_Changed.clear();
+        if (m_Watcher.poll(m_Changed))
+        {
+            for (Watched& watched : m_Shaders)
+            {
+                for (const std::string& path : m_Changed)
+                {
+                    if (std::find(watched.files.begin(), watched.files.end(), path) != watched.files.end())
+                    {
+                        watched.shader->beginReload();
+                        watched.active = watched.shader->reloadPending();
+                        watched.submitted = true;
+                        watched.frames = 0;
+                        watched.worstFrameMs = 0.0;
+                        break;
+                    }
+                }
+            }
+        }
+
+        std::vector<Watched*> finished;
+        for (Watched& watched : m_Shaders)
+        {
+            // results are never asked for in the frame that submitted the work
+            if (!watched.active || watched.submitted)
+            {
+                watched.submitted = false;
+                continue;
+            }
+            watched.replaced = watched.shader->updateReload();
+            if (watched.replaced)
+            {
+                swapped.push_back(watched.shader);
+                watchFiles(watched); // the new version may #include different files
+            }
+            if (!watched.shader->reloadPending())
+                finished.push_back(&watched);
+        }
+
+        // charge this frame's time to every reload that was in flight during it
+        double ms = ProgramCache::elapsedMs(start);
+        for (Watched& watched : m_Shaders)
+        {
+            if (!watched.active)
+                continue;
+            watched.frames++;
+            if (ms > watched.worstFrameMs)
+                watched.worstFrameMs = ms;
+        }
+        for (Watched* watched : finished)
+        {
+            std::cout << "Shader reload " << (watched->replaced ? "done" : "failed") << ": "
+                << watched->shader->vertexPath() << ", " << watched->shader->fragmentPath()
+                << " over " << watched->frames << " frames, worst frame " << watched->worstFrameMs << " ms" << std::endl;
+            watched->active = false;
+        }
+        return swapped;
+    }
+
+private:
+    struct Watched
+    {
+        Shader* shader = nullptr;
+        std::vector<std::string> files;  // full paths of every source the program was built from
+        bool active = false;        // a reload is in flight
+        bool submitted = false;     // compile + link were issued during the current update()
+        bool replaced = false;
+        int frames = 0;
+        double worstFrameMs = 0.0;  // time spent inside update() on the worst frame of the current reload
+    };
+
+    FileWatcher m_Watcher;
+    std::vector<Watched> m_Shaders;
+    std::vector<std::string> m_Changed;
+
+    void watchFiles(Watched& watched)
+    {
+        watched.files.clear();
+        for (const std::string& file : watched.shader->files())
+        {
+            watched.files.push_back(FileSystem::getPath(file));
+            m_Watcher.watch(watched.files.back());
+        }
+    }
+};
+
+// SHADERRELOAD_H
+#endif
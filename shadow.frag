@@ -0,0 +1,6 @@
+#version 330 core
+
+// depth-only pass for the shadow maps; vertex.vert does the transform
+void main()
+{
+}
@@ -0,0 +1,176 @@
+#ifndef SHADOWCASCADES_H
+#define SHADOWCASCADES_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "affine.h"
+#include "lightclusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+struct ShadowSettings
+{
+    int cascades = 4;
+    float distance = 150.0f;      // shadows end this far from the camera
+    float splitLambda = 0.75f;    // 0 = uniform splits, 1 = logarithmic
+    int cachedCascades = 2;       // the farthest N cascades keep their static casters between frames
+    float cacheMargin = 1.5f;     // cached cascades cover this much more than they need, so they move rarely
+    float casterReach = 200.0f;   // how far towards the sun casters outside a cascade are still rendered
+
+    bool operator==(const ShadowSettings& other) const
+    {
+        return cascades == other.cascades && distance == other.distance && splitLambda == other.splitLambda
+            && cachedCascades == other.cachedCascades && cacheMargin == other.cacheMargin && casterReach == other.casterReach;
+    }
+    bool operator!=(const ShadowSettings& other) const { return !(*this == other); }
+};
+
+struct ShadowCascade
+{
+    glm::mat4 view;             // light view, shared by all cascades
+    glm::mat4 projection;
+    glm::vec3 boundsMin;        // light-view box that casters are tested against
+    glm::vec3 boundsMax;
+    float splitFar = 0.0f;      // view-space distance where this cascade ends
+    float texelSize = 0.0f;     // world units covered by one shadow map texel
+    bool cached = false;        // static casters are kept from an earlier frame...
+    bool staticDirty = true;    // ...unless they have to be rendered again this frame
+};
+
+// Cascade layout for a directional light. The shadow range in front of the
+// camera is split with the practical split scheme (a blend of logarithmic and
+// uniform splits); each cascade is an orthographic box around the bounding
+// sphere of its frustum slice. Spheres don't change size as the camera turns,
+// and the box is moved in whole texels, so shadow edges don't shimmer.
+//
+// The farthest cascades are cached: they are fit around a larger sphere and
+// stay put until the camera leaves it, the sun moves, or the static geometry
+// changes (staticVersion), so their static casters are rendered only then.
+// No GL calls here.
+class ShadowCascades
+{
+public:
+    static const int MAX_CASCADES = 4;
+
+    void update(const ShadowSettings& settings, int resolution, const glm::mat4& cameraView, float fovY, float aspect, float zNear,
+        const glm::vec3& sunDirection, uint64_t staticVersion)
+    {
+        int count = std::max(1, std::min(settings.cascades, (int)MAX_CASCADES));
+        bool invalidate = settings != m_Settings || resolution != m_Resolution || sunDirection != m_SunDirection
+            || staticVersion != m_StaticVersion || count != m_Count;
+        m_Settings = settings;
+        m_Resolution = resolution;
+        m_SunDirection = sunDirection;
+        m_StaticVersion = staticVersion;
+        m_Count = count;
+
+        glm::vec3 up = std::fabs(sunDirection.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), -sunDirection, up);
+
+        Affine cameraWorld = Affine(cameraView).inverse();
+        glm::vec3 position = cameraWorld.translation();
+        glm::vec3 right = cameraWorld.column(0);
+        glm::vec3 cameraUp = cameraWorld.column(1);
+        glm::vec3 forward = -cameraWorld.column(2);
+        float tanY = std::tan(fovY * 0.5f);
+        float tanX = tanY * aspect;
+
+        float zFar = std::max(settings.distance, zNear * 2.0f);
+        float splitNear = zNear;
+        for (int i = 0; i < count; i++)
+        {
+            float t = (float)(i + 1) / count;
+            float logSplit = zNear * std::pow(zFar / zNear, t);
+            float uniformSplit = zNear + (zFar - zNear) * t;
+            float splitFar = settings.splitLambda * logSplit + (1.0f - settings.splitLambda) * uniformSplit;
+
+            // bounding sphere of the slice; the frustum is symmetric, so the
+            // corner average lies on the view axis and only depends on the depths
+            glm::vec3 center(0.0f);
+            glm::vec3 corners[8];
+            for (int c = 0; c < 8; c++)
+            {
+                float depth = (c & 4) ? splitFar : splitNear;
+                float x = (c & 1) ? 1.0f : -1.0f;
+                float y = (c & 2) ? 1.0f : -1.0f;
+                corners[c] = position + forward * depth + right * (x * depth * tanX) + cameraUp * (y * depth * tanY);
+                center += corners[c] * 0.125f;
+            }
+            float radius = 0.0f;
+            for (const glm::vec3& corner : corners)
+                radius = std::max(radius, glm::length(corner - center));
+            radius = std::ceil(radius * 16.0f) / 16.0f; // no size jitter from rounding
+
+            ShadowCascade& cascade = m_Cascades[i];
+            cascade.cached = i >= count - settings.cachedCascades;
+            if (cascade.cached)
+            {
+                CachedFit& fit = m_CachedFits[i];
+                bool inside = fit.radius > 0.0f && glm::length(center - fit.center) + radius <= fit.radius;
+                cascade.staticDirty = invalidate || !inside;
+                if (cascade.staticDirty)
+                {
+                    fit.center = center;
+                    fit.radius = radius * std::max(1.0f, settings.cacheMargin);
+                }
+                center = fit.center;
+                radius = fit.radius;
+            }
+            else
+            {
+                m_CachedFits[i] = CachedFit();
+                cascade.staticDirty = true;
+            }
+
+            // snap the light-space center to whole texels
+            glm::vec3 lightCenter(lightView * glm::vec4(center, 1.0f));
+            float texel = 2.0f * radius / resolution;
+            lightCenter.x = std::floor(lightCenter.x / texel + 0.5f) * texel;
+            lightCenter.y = std::floor(lightCenter.y / texel + 0.5f) * texel;
+
+            // light view looks down -z: the near plane is pulled towards the sun
+            // so casters between the sun and the cascade still land in the map
+            cascade.view = lightView;
+            cascade.boundsMin = lightCenter - glm::vec3(radius);
+            cascade.boundsMax = lightCenter + glm::vec3(radius, radius, radius + settings.casterReach);
+            cascade.projection = glm::ortho(cascade.boundsMin.x, cascade.boundsMax.x, cascade.boundsMin.y, cascade.boundsMax.y,
+                -cascade.boundsMax.z, -cascade.boundsMin.z);
+            cascade.splitFar = splitFar;
+            cascade.texelSize = texel;
+
+            splitNear = splitFar;
+        }
+    }
+
+    int count() const { return m_Count; }
+    const ShadowCascade& cascade(int i) const { return m_Cascades[i]; }
+
+    // bounding-sphere test of a caster against a cascade's light-space box
+    bool touches(int i, const glm::vec3& center, float radius) const
+    {
+        const ShadowCascade& cascade = m_Cascades[i];
+        glm::vec3 lightCenter(cascade.view * glm::vec4(center, 1.0f));
+        return LightClusterGrid::sphereTouchesBox(lightCenter, radius, cascade.boundsMin, cascade.boundsMax);
+    }
+
+private:
+    struct CachedFit
+    {
+        glm::vec3 center = glm::vec3(0.0f);
+        float radius = 0.0f;
+    };
+
+    ShadowCascade m_Cascades[MAX_CASCADES];
+    CachedFit m_CachedFits[MAX_CASCADES];
+    ShadowSettings m_Settings;
+    int m_Count = 0;
+    int m_Resolution = 0;
+    glm::vec3 m_SunDirection = glm::vec3(0.0f);
+    uint64_t m_StaticVersion = ~(uint64_t)0;
+};
+
+// SHADOWCASCADES_H
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+// Directional light shadows from the cascaded shadow maps (see cascadedshadows.h).
+
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 shadowMatrices[4];         // world -> shadow map texture space, per cascade
+uniform vec4 cascadeSplits;             // view-space distance where each cascade ends
+uniform vec4 cascadeTexelSize;          // world size of one shadow map texel, per cascade
+uniform int cascadeCount;
+
+// 1 = lit, 0 = in shadow; depth is the fragment's view-space distance
+float sunShadow(vec3 worldPos, vec3 normal, float depth)
+{
+    int cascade = 0;
+    while (cascade < cascadeCount && depth > cascadeSplits[cascade])
+        cascade++;
+    if (cascade == cascadeCount)
+        return 1.0;
+
+    // look up a little off the surface, scaled to the cascade's texels, against acne
+    vec3 offsetPos = worldPos + normal * (cascadeTexelSize[cascade] * 1.5);
+    vec4 coord = shadowMatrices[cascade] * vec4(offsetPos, 1.0);
+    float reference = min(coord.z, 1.0);
+
+    // four bilinear compares cover a 3x3 texel footprint
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    lit += texture(shadowMap, vec4(coord.xy + vec2(-0.5, -0.5) * texel, float(cascade), reference));
+    lit += texture(shadowMap, vec4(coord.xy + vec2( 0.5, -0.5) * texel, float(cascade), reference));
+    lit += texture(shadowMap, vec4(coord.xy + vec2(-0.5,  0.5) * texel, float(cascade), reference));
+    lit += texture(shadowMap, vec4(coord.xy + vec2( 0.5,  0.5) * texel, float(cascade), reference));
+    return lit * 0.25;
+}
@@ -436,6 +436,48 @@ STBIDEF stbi_uc *stbi_load_gif_from_memory(stbi_uc const *buffer, int len, int *
 STBIDEF int stbi_convert_wchar_to_utf8(char *buffer, size_t bufferlen, const wchar_t* input);
 #endif
 
+////////////////////////////////////
+//
+// 8-bits-per-channel reduced-size interface
+//
+// For previews, streaming stand-ins and low mip levels. scale_denom of 1, 2,
+// 4 or 8 returns an image of ceil(x/scale_denom) by ceil(y/scale_denom).
+// JPEGs are decoded at that size directly by truncating the IDCT to the
+// low-frequency coefficients (as libjpeg's scaled decoding does), so the
+// IDCT, upsampling and color conversion only touch the reduced pixel count.
+// Other formats are decoded at full size and box-filtered down.
+
+STBIDEF stbi_uc *stbi_load_scaled_from_memory   (stbi_uc           const *buffer, int len   , int *x, int *y, int *channels_in_file, int desired_channels, int scale_denom);
+STBIDEF stbi_uc *stbi_load_scaled_from_callbacks(stbi_io_callbacks const *clbk  , void *user, int *x, int *y, int *channels_in_file, int desired_channels, int scale_denom);
+
+#ifndef STBI_NO_STDIO
+STBIDEF stbi_uc *stbi_load_scaled          (char const *filename, int *x, int *y, int *channels_in_file, int desired_channels, int scale_denom);
+STBIDEF stbi_uc *stbi_load_scaled_from_file(FILE *f,              int *x, int *y, int *channels_in_file, int desired_channels, int scale_denom);
+#endif
+
+////////////////////////////////////
+//
+// 8-bits-per-channel decode-into-buffer interface
+//
+// Decodes straight into caller-owned memory (e.g. a mapped pixel buffer or an
+// arena) instead of returning a malloc'd image. desired_channels must be 1..4,
+// out_stride is the byte distance between rows (0 means x*desired_channels),
+// and the buffer must hold out_stride*(y-1) + x*desired_channels bytes; use
+// stbi_info to size it. Channel conversion and flipping happen during the
+// final write, so there is no separate conversion buffer or row-swap pass.
+// flip_vertically applies to this call only and ignores the value set by
+// stbi_set_flip_vertically_on_load, so it is safe to use from several threads.
+// Returns 1 on success, 0 on failure (see stbi_failure_reason).
+
+STBIDEF int stbi_load_into_from_memory   (stbi_uc           const *buffer, int len   , stbi_uc *out, size_t out_size, int out_stride, int *x, int *y, int *channels_in_file, int desired_channels, int flip_vertically);
+STBIDEF int stbi_load_into_from_callbacks(stbi_io_callbacks const *clbk  , void *user, stbi_uc *out, size_t out_size, int out_stride, int *x, int *y, int *channels_in_file, int desired_channels, int flip_vertically);
+
+#ifndef STBI_NO_STDIO
+STBIDEF int stbi_load_into          (char const *filename, stbi_uc *out, size_t out_size, int out_stride, int *x, int *y, int *channels_in_file, int desired_channels, int flip_vertically);
+STBIDEF int stbi_load_into_from_file(FILE *f,              stbi_uc *out, size_t out_size, int out_stride, int *x, int *y, int *channels_in_file, int desired_channels, int flip_vertically);
+// for stbi_load_into_from_file, file pointer is left pointing immediately after image
+#endif
+
 ////////////////////////////////////
 //
 // 16-bits-per-channel interface
@@ -816,6 +858,14 @@ typedef struct
 
    stbi_uc *img_buffer, *img_buffer_end;
    stbi_uc *img_buffer_original, *img_buffer_original_end;
+
+   // caller-provided output for the stbi_load_into_* family; NULL otherwise
+   stbi_uc *into_buffer;
+   size_t into_size, into_stride;
+   int into_comp, into_flip;
+
+   // log2 of the stbi_load_scaled_* denominator; 0 for full size
+   int scale_shift;
 } stbi__context;
 
 
@@ -829,6 +879,8 @@ static void stbi__start_mem(stbi__context *s, stbi_uc const *buffer, int len)
    s->callback_already_read = 0;
    s->img_buffer = s->img_buffer_original = (stbi_uc *) buffer;
    s->img_buffer_end = s->img_buffer_original_end = (stbi_uc *) buffer+len;
+   s->into_buffer = NULL;
+   s->scale_shift = 0;
 }
 
 // initialize a callback-based context
@@ -842,6 +894,8 @@ static void stbi__start_callbacks(stbi__context *s, stbi_io_callbacks *c, void *
    s->img_buffer = s->img_buffer_original = s->buffer_start;
    stbi__refill_buffer(s);
    s->img_buffer_original_end = s->img_buffer_end;
+   s->into_buffer = NULL;
+   s->scale_shift = 0;
 }
 
 #ifndef STBI_NO_STDIO
@@ -902,6 +956,7 @@ typedef struct
    int bits_per_channel;
    int num_channels;
    int channel_order;
+   int scaled;          // loader already applied s->scale_shift
 } stbi__result_info;
 
 #ifndef STBI_NO_JPEG
@@ -1256,6 +1311,44 @@ static void stbi__vertical_flip_slices(void *image, int w, int h, int z, int byt
 }
 #endif
 
+// box-filters an image down by 2^shift for formats without a native reduced
+// decode; edge cells average only the pixels they actually cover
+static stbi_uc *stbi__downsample_box(stbi_uc *data, int *x, int *y, int comp, int shift)
+{
+   int i,j,k,u,v;
+   int d = 1 << shift;
+   int w = (*x + d-1) >> shift;
+   int h = (*y + d-1) >> shift;
+   stbi_uc *small;
+
+   if (data == NULL) return NULL;
+   small = (stbi_uc *) stbi__malloc_mad3(w, h, comp, 0);
+   if (small == NULL) {
+      STBI_FREE(data);
+      return stbi__errpuc("outofmem", "Out of memory");
+   }
+
+   for (j=0; j < h; ++j) {
+      int y0 = j << shift, y1 = y0 + d < *y ? y0 + d : *y;
+      for (i=0; i < w; ++i) {
+         int x0 = i << shift, x1 = x0 + d < *x ? x0 + d : *x;
+         int count = (y1-y0) * (x1-x0);
+         for (k=0; k < comp; ++k) {
+            int sum = count >> 1;
+            for (v=y0; v < y1; ++v)
+               for (u=x0; u < x1; ++u)
+                  sum += data[((size_t) v * *x + u) * comp + k];
+            small[((size_t) j * w + i) * comp + k] = (stbi_uc) (sum / count);
+         }
+      }
+   }
+
+   STBI_FREE(data);
+   *x = w;
+   *y = h;
+   return small;
+}
+
 static unsigned char *stbi__load_and_postprocess_8bit(stbi__context *s, int *x, int *y, int *comp, int req_comp)
 {
    stbi__result_info ri;
@@ -1272,6 +1365,11 @@ static unsigned char *stbi__load_and_postprocess_8bit(stbi__context *s, int *x,
       ri.bits_per_channel = 8;
    }
 
+   if (s->scale_shift && !ri.scaled) {
+      result = stbi__downsample_box((stbi_uc *) result, x, y, req_comp ? req_comp : *comp, s->scale_shift);
+      if (result == NULL) return NULL;
+   }
+
    // @TODO: move stbi__convert_format to here
 
    if (stbi__vertically_flip_on_load) {
@@ -1319,6 +1417,20 @@ static void stbi__float_postprocess(float *result, int *x, int *y, int *comp, in
 }
 #endif
 
+static int stbi__load_into(stbi__context *s, stbi_uc *out, size_t out_size, int out_stride, int *x, int *y, int *comp, int req_comp, int flip);
+
+static unsigned char *stbi__load_scaled(stbi__context *s, int *x, int *y, int *comp, int req_comp, int scale_denom)
+{
+   switch (scale_denom) {
+      case 1: s->scale_shift = 0; break;
+      case 2: s->scale_shift = 1; break;
+      case 4: s->scale_shift = 2; break;
+      case 8: s->scale_shift = 3; break;
+      default: return stbi__errpuc("bad scale", "Scale must be 1, 2, 4 or 8");
+   }
+   return stbi__load_and_postprocess_8bit(s,x,y,comp,req_comp);
+}
+
 #ifndef STBI_NO_STDIO
 
 #if defined(_WIN32) && defined(STBI_WINDOWS_UTF8)
@@ -1385,6 +1497,52 @@ STBIDEF stbi_uc *stbi_load_from_file(FILE *f, int *x, int *y, int *comp, int req
    return result;
 }
 
+STBIDEF stbi_uc *stbi_load_scaled(char const *filename, int *x, int *y, int *comp, int req_comp, int scale_denom)
+{
+   FILE *f = stbi__fopen(filename, "rb");
+   unsigned char *result;
+   if (!f) return stbi__errpuc("can't fopen", "Unable to open file");
+   result = stbi_load_scaled_from_file(f,x,y,comp,req_comp,scale_denom);
+   fclose(f);
+   return result;
+}
+
+STBIDEF stbi_uc *stbi_load_scaled_from_file(FILE *f, int *x, int *y, int *comp, int req_comp, int scale_denom)
+{
+   unsigned char *result;
+   stbi__context s;
+   stbi__start_file(&s,f);
+   result = stbi__load_scaled(&s,x,y,comp,req_comp,scale_denom);
+   if (result) {
+      // need to 'unget' all the characters in the IO buffer
+      fseek(f, - (int) (s.img_buffer_end - s.img_buffer), SEEK_CUR);
+   }
+   return result;
+}
+
+STBIDEF int stbi_load_into(char const *filename, stbi_uc *out, size_t out_size, int out_stride, int *x, int *y, int *comp, int req_comp, int flip_vertically)
+{
+   FILE *f = stbi__fopen(filename, "rb");
+   int result;
+   if (!f) return stbi__err("can't fopen", "Unable to open file");
+   result = stbi_load_into_from_file(f,out,out_size,out_stride,x,y,comp,req_comp,flip_vertically);
+   fclose(f);
+   return result;
+}
+
+STBIDEF int stbi_load_into_from_file(FILE *f, stbi_uc *out, size_t out_size, int out_stride, int *x, int *y, int *comp, int req_comp, int flip_vertically)
+{
+   int result;
+   stbi__context s;
+   stbi__start_file(&s,f);
+   result = stbi__load_into(&s,out,out_size,out_stride,x,y,comp,req_comp,flip_vertically);
+   if (result) {
+      // need to 'unget' all the characters in the IO buffer
+      fseek(f, - (int) (s.img_buffer_end - s.img_buffer), SEEK_CUR);
+   }
+   return result;
+}
+
 STBIDEF stbi__uint16 *stbi_load_from_file_16(FILE *f, int *x, int *y, int *comp, int req_comp)
 {
    stbi__uint16 *result;
@@ -1439,6 +1597,34 @@ STBIDEF stbi_uc *stbi_load_from_callbacks(stbi_io_callbacks const *clbk, void *u
    return stbi__load_and_postprocess_8bit(&s,x,y,comp,req_comp);
 }
 
+STBIDEF stbi_uc *stbi_load_scaled_from_memory(stbi_uc const *buffer, int len, int *x, int *y, int *comp, int req_comp, int scale_denom)
+{
+   stbi__context s;
+   stbi__start_mem(&s,buffer,len);
+   return stbi__load_scaled(&s,x,y,comp,req_comp,scale_denom);
+}
+
+STBIDEF stbi_uc *stbi_load_scaled_from_callbacks(stbi_io_callbacks const *clbk, void *user, int *x, int *y, int *comp, int req_comp, int scale_denom)
+{
+   stbi__context s;
+   stbi__start_callbacks(&s, (stbi_io_callbacks *) clbk, user);
+   return stbi__load_scaled(&s,x,y,comp,req_comp,scale_denom);
+}
+
+STBIDEF int stbi_load_into_from_memory(stbi_uc const *buffer, int len, stbi_uc *out, size_t out_size, int out_stride, int *x, int *y, int *comp, int req_comp, int flip_vertically)
+{
+   stbi__context s;
+   stbi__start_mem(&s,buffer,len);
+   return stbi__load_into(&s,out,out_size,out_stride,x,y,comp,req_comp,flip_vertically);
+}
+
+STBIDEF int stbi_load_into_from_callbacks(stbi_io_callbacks const *clbk, void *user, stbi_uc *out, size_t out_size, int out_stride, int *x, int *y, int *comp, int req_comp, int flip_vertically)
+{
+   stbi__context s;
+   stbi__start_callbacks(&s, (stbi_io_callbacks *) clbk, user);
+   return stbi__load_into(&s,out,out_size,out_stride,x,y,comp,req_comp,flip_vertically);
+}
+
 #ifndef STBI_NO_GIF
 STBIDEF stbi_uc *stbi_load_gif_from_memory(stbi_uc const *buffer, int len, int **delays, int *x, int *y, int *z, int *comp, int req_comp)
 {
@@ -1796,6 +1982,106 @@ static unsigned char *stbi__convert_format(unsigned char *data, int img_n, int r
 }
 #endif
 
+//////////////////////////////////////////////////////////////////////////////
+//
+//  decode-into-buffer support
+//    converts img_n to req_comp and applies the vertical flip in the same
+//    pass that writes the caller's buffer. jpeg writes its rows there
+//    directly (see load_jpeg_image), everything else decodes natively and
+//    goes through stbi__convert_into once.
+
+#define STBI__INTO_Y(r,g,b)  ((stbi_uc) ((((r)*77) + ((g)*150) + (29*(b))) >> 8))
+
+static int stbi__into_fits(stbi__context *s, int w, int h, int req_comp)
+{
+   size_t row = (size_t) w * req_comp;
+   if (s->into_stride == 0) s->into_stride = row;
+   if (s->into_stride < row) return stbi__err("bad stride", "Output stride smaller than a row");
+   if (h > 0 && s->into_stride * (h-1) + row > s->into_size) return stbi__err("buffer too small", "Output buffer too small for image");
+   return 1;
+}
+
+static stbi_uc *stbi__into_row(stbi__context *s, int j, int h)
+{
+   return s->into_buffer + s->into_stride * (size_t) (s->into_flip ? h - 1 - j : j);
+}
+
+static void stbi__convert_into(stbi__context *s, stbi_uc const *data, int img_n, int req_comp, int x, int y)
+{
+   int i,j;
+   for (j=0; j < y; ++j) {
+      stbi_uc const *src = data + (size_t) j * x * img_n;
+      stbi_uc *dest = stbi__into_row(s, j, y);
+
+      if (img_n == req_comp) {
+         memcpy(dest, src, (size_t) x * img_n);
+         continue;
+      }
+
+      #define STBI__COMBO(a,b)  ((a)*8+(b))
+      #define STBI__CASE(a,b)   case STBI__COMBO(a,b): for(i=x-1; i >= 0; --i, src += a, dest += b)
+      switch (STBI__COMBO(img_n, req_comp)) {
+         STBI__CASE(1,2) { dest[0]=src[0]; dest[1]=255;                                   } break;
+         STBI__CASE(1,3) { dest[0]=dest[1]=dest[2]=src[0];                                } break;
+         STBI__CASE(1,4) { dest[0]=dest[1]=dest[2]=src[0]; dest[3]=255;                   } break;
+         STBI__CASE(2,1) { dest[0]=src[0];                                                } break;
+         STBI__CASE(2,3) { dest[0]=dest[1]=dest[2]=src[0];                                } break;
+         STBI__CASE(2,4) { dest[0]=dest[1]=dest[2]=src[0]; dest[3]=src[1];                } break;
+         STBI__CASE(3,4) { dest[0]=src[0];dest[1]=src[1];dest[2]=src[2];dest[3]=255;      } break;
+         STBI__CASE(3,1) { dest[0]=STBI__INTO_Y(src[0],src[1],src[2]);                    } break;
+         STBI__CASE(3,2) { dest[0]=STBI__INTO_Y(src[0],src[1],src[2]); dest[1] = 255;     } break;
+         STBI__CASE(4,1) { dest[0]=STBI__INTO_Y(src[0],src[1],src[2]);                    } break;
+         STBI__CASE(4,2) { dest[0]=STBI__INTO_Y(src[0],src[1],src[2]); dest[1] = src[3];  } break;
+         STBI__CASE(4,3) { dest[0]=src[0];dest[1]=src[1];dest[2]=src[2];                  } break;
+         default: STBI_ASSERT(0); return;
+      }
+      #undef STBI__CASE
+   }
+}
+
+static int stbi__load_into(stbi__context *s, stbi_uc *out, size_t out_size, int out_stride, int *x, int *y, int *comp, int req_comp, int flip)
+{
+   stbi__result_info ri;
+   void *result;
+   int img_n;
+
+   if (out == NULL) return stbi__err("bad out", "Internal error");
+   if (req_comp < 1 || req_comp > 4) return stbi__err("bad req_comp", "Internal error");
+   if (out_stride < 0) return stbi__err("bad stride", "Internal error");
+
+   s->into_buffer = out;
+   s->into_size   = out_size;
+   s->into_stride = (size_t) out_stride;
+   s->into_comp   = req_comp;
+   s->into_flip   = flip;
+
+   // decode in the file's own layout; loaders that understand into_buffer
+   // write there themselves and hand back the caller's pointer. comp may be
+   // NULL, so the channel count goes through img_n
+   result = stbi__load_main(s, x, y, &img_n, 0, &ri, 8);
+   if (result == NULL)
+      return 0;
+   if (comp) *comp = img_n;
+   if (result == out)
+      return 1;
+
+   STBI_ASSERT(ri.bits_per_channel == 8 || ri.bits_per_channel == 16);
+
+   if (ri.bits_per_channel != 8) {
+      result = stbi__convert_16_to_8((stbi__uint16 *) result, *x, *y, img_n);
+      if (result == NULL) return 0;
+   }
+
+   if (!stbi__into_fits(s, *x, *y, req_comp)) {
+      STBI_FREE(result);
+      return 0;
+   }
+
+   stbi__convert_into(s, (stbi_uc *) result, img_n, req_comp, *x, *y);
+   STBI_FREE(result);
+   return 1;
+}
+
 #if defined(STBI_NO_PNG) && defined(STBI_NO_PSD)
 // nothing
 #else
@@ -1993,6 +2279,8 @@ typedef struct
    int scan_n, order[4];
    int restart_interval, todo;
 
+   int idct_size;  // 8, or 4/2/1 when decoding at reduced scale
+
 // kernels
    void (*idct_block_kernel)(stbi_uc *out, int out_stride, short data[64]);
    void (*YCbCr_to_RGB_kernel)(stbi_uc *out, const stbi_uc *y, const stbi_uc *pcb, const stbi_uc *pcr, int count, int step);
@@ -2522,6 +2810,63 @@ static void stbi__idct_block(stbi_uc *out, int out_stride, short data[64])
    }
 }
 
+// reduced-size IDCTs for scaled decoding: an NxN output block is the 8x8
+// reconstruction sampled at the centers of its (8/N)x(8/N) pixel groups,
+// which only needs the NxN lowest-frequency coefficients. that is an N-point
+// IDCT with C(u) * cos((2x+1)*u*pi/(2N)) / 2 as its basis, so two passes give
+// the usual 1/4 factor; 4x4 is one even/odd butterfly, 2x2 sums and differences.
+static void stbi__idct_4x4(stbi_uc *out, int out_stride, short data[64])
+{
+   int i,val[16],*v=val;
+   short *d = data;
+
+   // rows: horizontal frequencies -> horizontal positions
+   for (i=0; i < 4; ++i, d += 8, v += 4) {
+      int e0 = (d[0]+d[2]) * stbi__f2f(0.353553391f);
+      int e1 = (d[0]-d[2]) * stbi__f2f(0.353553391f);
+      int o0 = d[1]*stbi__f2f(0.461939766f) + d[3]*stbi__f2f(0.191341716f);
+      int o1 = d[1]*stbi__f2f(0.191341716f) - d[3]*stbi__f2f(0.461939766f);
+      // constants scaled things up by 1<<12; keep 2 extra bits of precision
+      v[0] = (e0+o0 + 512) >> 10;
+      v[3] = (e0-o0 + 512) >> 10;
+      v[1] = (e1+o1 + 512) >> 10;
+      v[2] = (e1-o1 + 512) >> 10;
+   }
+
+   // columns: vertical frequencies -> vertical positions
+   for (i=0, v=val; i < 4; ++i, ++v) {
+      int e0 = (v[0]+v[8]) * stbi__f2f(0.353553391f);
+      int e1 = (v[0]-v[8]) * stbi__f2f(0.353553391f);
+      int o0 = v[4]*stbi__f2f(0.461939766f) + v[12]*stbi__f2f(0.191341716f);
+      int o1 = v[4]*stbi__f2f(0.191341716f) - v[12]*stbi__f2f(0.461939766f);
+      // 1<<12 from the constants and 1<<2 from the first pass: round, and
+      // level shift to 0..255 before the shift
+      e0 += 8192 + (128<<14);
+      e1 += 8192 + (128<<14);
+      out[i]              = stbi__clamp((e0+o0) >> 14);
+      out[i+3*out_stride] = stbi__clamp((e0-o0) >> 14);
+      out[i+  out_stride] = stbi__clamp((e1+o1) >> 14);
+      out[i+2*out_stride] = stbi__clamp((e1-o1) >> 14);
+   }
+}
+
+static void stbi__idct_2x2(stbi_uc *out, int out_stride, short data[64])
+{
+   // each output is (d00 +- d01 +- d10 +- d11) / 8
+   int a = data[0]+data[1], b = data[0]-data[1];
+   int c = data[8]+data[9], e = data[8]-data[9];
+   out[0]            = stbi__clamp(((a+c + 4) >> 3) + 128);
+   out[1]            = stbi__clamp(((b+e + 4) >> 3) + 128);
+   out[out_stride]   = stbi__clamp(((a-c + 4) >> 3) + 128);
+   out[out_stride+1] = stbi__clamp(((b-e + 4) >> 3) + 128);
+}
+
+static void stbi__idct_1x1(stbi_uc *out, int out_stride, short data[64])
+{
+   STBI_NOTUSED(out_stride);
+   out[0] = stbi__clamp(((data[0] + 4) >> 3) + 128);
+}
+
 #ifdef STBI_SSE2
 // sse2 integer IDCT. not the fastest possible implementation but it
 // produces bit-identical results to the generic C version so it's
@@ -2963,7 +3308,7 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
             for (i=0; i < w; ++i) {
                int ha = z->img_comp[n].ha;
                if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
+               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*z->idct_size+i*z->idct_size, z->img_comp[n].w2, data);
                // every data block is an MCU, so countdown the restart interval
                if (--z->todo <= 0) {
                   if (z->code_bits < 24) stbi__grow_buffer_unsafe(z);
@@ -2987,8 +3332,8 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
                   // by the basic H and V specified for the component
                   for (y=0; y < z->img_comp[n].v; ++y) {
                      for (x=0; x < z->img_comp[n].h; ++x) {
-                        int x2 = (i*z->img_comp[n].h + x)*8;
-                        int y2 = (j*z->img_comp[n].v + y)*8;
+                        int x2 = (i*z->img_comp[n].h + x)*z->idct_size;
+                        int y2 = (j*z->img_comp[n].v + y)*z->idct_size;
                         int ha = z->img_comp[n].ha;
                         if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
                         z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, data);
@@ -3088,7 +3433,7 @@ static void stbi__jpeg_finish(stbi__jpeg *z)
             for (i=0; i < w; ++i) {
                short *data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
                stbi__jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
+               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*z->idct_size+i*z->idct_size, z->img_comp[n].w2, data);
             }
          }
       }
@@ -3328,8 +3673,8 @@ static int stbi__process_frame_header(stbi__jpeg *z, int scan)
       //
       // img_mcu_x, img_mcu_y: <=17 bits; comp[i].h and .v are <=4 (checked earlier)
       // so these muls can't overflow with 32-bit ints (which we require)
-      z->img_comp[i].w2 = z->img_mcu_x * z->img_comp[i].h * 8;
-      z->img_comp[i].h2 = z->img_mcu_y * z->img_comp[i].v * 8;
+      z->img_comp[i].w2 = z->img_mcu_x * z->img_comp[i].h * z->idct_size;
+      z->img_comp[i].h2 = z->img_mcu_y * z->img_comp[i].v * z->idct_size;
       z->img_comp[i].coeff = 0;
       z->img_comp[i].raw_coeff = 0;
       z->img_comp[i].linebuf = NULL;
@@ -3339,10 +3684,10 @@ static int stbi__process_frame_header(stbi__jpeg *z, int scan)
       // align blocks for idct using mmx/sse
       z->img_comp[i].data = (stbi_uc*) (((size_t) z->img_comp[i].raw_data + 15) & ~15);
       if (z->progressive) {
-         // w2, h2 are multiples of 8 (see above)
-         z->img_comp[i].coeff_w = z->img_comp[i].w2 / 8;
-         z->img_comp[i].coeff_h = z->img_comp[i].h2 / 8;
-         z->img_comp[i].raw_coeff = stbi__malloc_mad3(z->img_comp[i].w2, z->img_comp[i].h2, sizeof(short), 15);
+         // one 8x8 coefficient block per data block, whatever idct_size is
+         z->img_comp[i].coeff_w = z->img_mcu_x * z->img_comp[i].h;
+         z->img_comp[i].coeff_h = z->img_mcu_y * z->img_comp[i].v;
+         z->img_comp[i].raw_coeff = stbi__malloc_mad3(z->img_comp[i].coeff_w * 64, z->img_comp[i].coeff_h, sizeof(short), 15);
          if (z->img_comp[i].raw_coeff == NULL)
             return stbi__free_jpeg_components(z, i+1, stbi__err("outofmem", "Out of memory"));
          z->img_comp[i].coeff = (short*) (((size_t) z->img_comp[i].raw_coeff + 15) & ~15);
@@ -3819,6 +4164,7 @@ static void stbi__YCbCr_to_RGB_simd(stbi_uc *out, stbi_uc const *y, stbi_uc cons
 // set up the kernels
 static void stbi__setup_jpeg(stbi__jpeg *j)
 {
+   j->idct_size = 8;
    j->idct_block_kernel = stbi__idct_block;
    j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_row;
    j->resample_row_hv_2_kernel = stbi__resample_row_hv_2;
@@ -3866,12 +4212,26 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
    int n, decode_n, is_rgb;
    z->s->img_n = 0; // make stbi__cleanup_jpeg safe
 
+   // writing into a caller buffer: color-convert straight to its layout
+   if (z->s->into_buffer) req_comp = z->s->into_comp;
+
    // validate req_comp
    if (req_comp < 0 || req_comp > 4) return stbi__errpuc("bad req_comp", "Internal error");
 
    // load a jpeg image from whichever source, but leave in YCbCr format
    if (!stbi__decode_jpeg_image(z)) { stbi__cleanup_jpeg(z); return NULL; }
 
+   // the planes were reconstructed at reduced size; from here on work in those units
+   if (z->idct_size != 8) {
+      int k, shift = z->s->scale_shift, d = 1 << shift;
+      z->s->img_x = (z->s->img_x + d-1) >> shift;
+      z->s->img_y = (z->s->img_y + d-1) >> shift;
+      for (k=0; k < z->s->img_n; ++k) {
+         z->img_comp[k].x = (z->img_comp[k].x + d-1) >> shift;
+         z->img_comp[k].y = (z->img_comp[k].y + d-1) >> shift;
+      }
+   }
+
    // determine actual number of components to generate
    n = req_comp ? req_comp : z->s->img_n >= 3 ? 3 : 1;
 
@@ -3891,6 +4251,7 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
       int k;
       unsigned int i,j;
       stbi_uc *output;
+      stbi_uc *rowbuf = NULL;
       stbi_uc *coutput[4] = { NULL, NULL, NULL, NULL };
 
       stbi__resample res_comp[4];
@@ -3917,13 +4278,22 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
          else                               r->resample = stbi__resample_row_generic;
       }
 
-      // can't error after this so, this is safe
-      output = (stbi_uc *) stbi__malloc_mad3(n, z->s->img_x, z->s->img_y, 1);
-      if (!output) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
+      if (z->s->into_buffer) {
+         // the color converters may store one byte past the end of a row,
+         // so build each row in a scratch line and copy it into place
+         if (!stbi__into_fits(z->s, z->s->img_x, z->s->img_y, n)) { stbi__cleanup_jpeg(z); return NULL; }
+         rowbuf = (stbi_uc *) stbi__malloc_mad2(n, z->s->img_x, 1);
+         if (!rowbuf) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
+         output = z->s->into_buffer;
+      } else {
+         // can't error after this so, this is safe
+         output = (stbi_uc *) stbi__malloc_mad3(n, z->s->img_x, z->s->img_y, 1);
+         if (!output) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
+      }
 
       // now go ahead and resample
       for (j=0; j < z->s->img_y; ++j) {
-         stbi_uc *out = output + n * z->s->img_x * j;
+         stbi_uc *out = rowbuf ? rowbuf : output + n * z->s->img_x * j;
          for (k=0; k < decode_n; ++k) {
             stbi__resample *r = &res_comp[k];
             int y_bot = r->ystep >= (r->vs >> 1);
@@ -4015,7 +4385,10 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
                   for (i=0; i < z->s->img_x; ++i) { *out++ = y[i]; *out++ = 255; }
             }
          }
+         if (rowbuf)
+            memcpy(stbi__into_row(z->s, j, z->s->img_y), rowbuf, (size_t) n * z->s->img_x);
       }
+      STBI_FREE(rowbuf);
       stbi__cleanup_jpeg(z);
       *out_x = z->s->img_x;
       *out_y = z->s->img_y;
@@ -4030,9 +4403,14 @@ static void *stbi__jpeg_load(stbi__context *s, int *x, int *y, int *comp, int re
    stbi__jpeg* j = (stbi__jpeg*) stbi__malloc(sizeof(stbi__jpeg));
    if (!j) return stbi__errpuc("outofmem", "Out of memory");
    memset(j, 0, sizeof(stbi__jpeg));
-   STBI_NOTUSED(ri);
    j->s = s;
    stbi__setup_jpeg(j);
+   if (s->scale_shift) {
+      static void (*const reduced[4])(stbi_uc *out, int out_stride, short data[64]) = { NULL, stbi__idct_4x4, stbi__idct_2x2, stbi__idct_1x1 };
+      j->idct_size = 8 >> s->scale_shift;
+      j->idct_block_kernel = reduced[s->scale_shift];
+      ri->scaled = 1;
+   }
    result = load_jpeg_image(j, x,y,comp,req_comp);
    STBI_FREE(j);
    return result;
@@ -0,0 +1,155 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "terrainchunks.h"
+#include "shader_m.h"
+
+#include <vector>
+
+// GPU side of the heightmap terrain (layout and LOD selection in
+// TerrainChunks). The heights are an R16 texture that terrain.vert fetches
+// from; all chunks share one small grid vertex buffer and one index buffer
+// holding every LOD/stitch pattern, so a chunk is one glDrawElements with its
+// origin in a uniform.
+class Terrain
+{
+public:
+    static const int HEIGHT_UNIT = 9;   // after the shadow maps
+
+    void init()
+    {
+        std::vector<float> grid;
+        for (int z = 0; z < TerrainChunks::GRID; z++)
+        {
+            for (int x = 0; x < TerrainChunks::GRID; x++)
+            {
+                grid.push_back((float)x);
+                grid.push_back((float)z);
+            }
+        }
+
+        std::vector<uint32_t> indices;
+        for (int lod = 0; lod < TerrainChunks::LODS; lod++)
+        {
+            // the coarsest LOD never has a coarser neighbour
+            int patterns = lod + 1 < TerrainChunks::LODS ? TerrainChunks::STITCH_PATTERNS : 1;
+            for (int stitch = 0; stitch < TerrainChunks::STITCH_PATTERNS; stitch++)
+            {
+                Pattern& pattern = m_Patterns[lod][stitch];
+                pattern.first = (unsigned int)indices.size();
+                if (stitch < patterns)
+                    TerrainChunks::buildIndices(lod, stitch, indices);
+                pattern.count = (int)(indices.size() - pattern.first);
+            }
+        }
+
+        glGenVertexArrays(1, &m_VAO);
+        glGenBuffers(2, m_Buffers);
+        glBindVertexArray(m_VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_Buffers[0]);
+        glBufferData(GL_ARRAY_BUFFER, grid.size() * sizeof(float), grid.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_Buffers[1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glGenTextures(1, &m_HeightMap);
+        glBindTexture(GL_TEXTURE_2D, m_HeightMap);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, TerrainChunks::SAMPLES, TerrainChunks::SAMPLES, 0, GL_RED, GL_UNSIGNED_SHORT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void destroy()
+    {
+        glDeleteTextures(1, &m_HeightMap);
+        glDeleteBuffers(2, m_Buffers);
+        glDeleteVertexArrays(1, &m_VAO);
+    }
+
+    // new heights from the seed; `features` is roughly the number of hills across
+    void generate(unsigned int seed, float features)
+    {
+        m_Chunks.generate(seed, features);
+        glBindTexture(GL_TEXTURE_2D, m_HeightMap);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 2); // rows of 513 shorts
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TerrainChunks::SAMPLES, TerrainChunks::SAMPLES, GL_RED, GL_UNSIGNED_SHORT,
+            m_Chunks.heights().data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        m_Chunks.occluderMesh(OCCLUDER_QUADS, m_OccluderPositions, m_OccluderIndices);
+    }
+
+    // choose LODs for this camera; model is translate(position) * scale(size)
+    void update(const glm::vec3& camera, const glm::vec3& position, const glm::vec3& size, float lodDistance, const glm::mat4& viewProjection)
+    {
+        // frustum planes (Gribb/Hartmann), inward facing
+        glm::mat4 m = glm::transpose(viewProjection);
+        glm::vec4 planes[6] = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+        m_Chunks.select(camera, position, size, lodDistance, planes);
+    }
+
+    // draw the chunks with a terrain.vert program; model/view/projection are
+    // already set. culled = false also draws chunks outside the camera frustum
+    // (for the shadow maps). Returns the draw calls issued.
+    int draw(const Shader& shader, bool culled = true) const
+    {
+        glActiveTexture(GL_TEXTURE0 + HEIGHT_UNIT);
+        glBindTexture(GL_TEXTURE_2D, m_HeightMap);
+        glActiveTexture(GL_TEXTURE0);
+        shader.setInt("heightMap", HEIGHT_UNIT);
+        shader.setFloat("gridScale", 1.0f / (TerrainChunks::SAMPLES - 1));
+        GLint origin = glGetUniformLocation(shader.ID, "chunkOrigin");
+
+        glBindVertexArray(m_VAO);
+        int draws = 0;
+        for (int cz = 0; cz < TerrainChunks::CHUNKS; cz++)
+        {
+            for (int cx = 0; cx < TerrainChunks::CHUNKS; cx++)
+            {
+                const TerrainChunks::Chunk& chunk = m_Chunks.chunk(cx, cz);
+                if (culled && !chunk.visible)
+                    continue;
+                const Pattern& pattern = m_Patterns[chunk.lod][chunk.stitch];
+                glUniform2f(origin, (float)(cx * TerrainChunks::CHUNK_QUADS), (float)(cz * TerrainChunks::CHUNK_QUADS));
+                glDrawElements(GL_TRIANGLES, pattern.count, GL_UNSIGNED_INT, (void*)(pattern.first * sizeof(uint32_t)));
+                draws++;
+            }
+        }
+        glBindVertexArray(0);
+        return draws;
+    }
+
+    const TerrainChunks& chunks() const { return m_Chunks; }
+    // coarse local-space mesh for the CPU occlusion culler
+    const std::vector<float>& occluderPositions() const { return m_OccluderPositions; }
+    const std::vector<unsigned int>& occluderIndices() const { return m_OccluderIndices; }
+
+private:
+    static const int OCCLUDER_QUADS = 32;   // per side
+
+    struct Pattern
+    {
+        unsigned int first = 0;
+        int count = 0;
+    };
+
+    TerrainChunks m_Chunks;
+    Pattern m_Patterns[TerrainChunks::LODS][TerrainChunks::STITCH_PATTERNS];
+    unsigned int m_VAO = 0;
+    unsigned int m_Buffers[2] = { 0, 0 };
+    unsigned int m_HeightMap = 0;
+    std::vector<float> m_OccluderPositions;
+    std::vector<unsigned int> m_OccluderIndices;
+};
+
+// TERRAIN_H
+#endif
@@ -0,0 +1,24 @@
+#version 330 core
+// vertex.vert for the heightmap terrain: every chunk draws the same grid,
+// offset to its place in the heightmap and raised by the 16-bit height texture
+layout (location = 0) in vec2 aGrid;   // vertex within the chunk, in heightmap samples
+
+out vec2 TexCoord;
+out vec3 FragPos;
+
+uniform mat4 model;     // the unit square (x, z in [-0.5, 0.5], y in [0, 1]) to world
+uniform mat4 view;
+uniform mat4 projection;
+uniform sampler2D heightMap;
+uniform vec2 chunkOrigin;
+uniform float gridScale; // 1 / (heightmap samples - 1)
+
+void main()
+{
+    vec2 heightSample = chunkOrigin + aGrid;
+    float height = texelFetch(heightMap, ivec2(heightSample), 0).r;
+    vec3 position = vec3(heightSample.x * gridScale - 0.5, height, heightSample.y * gridScale - 0.5);
+    gl_Position = projection * view * model * vec4(position, 1.0);
+    FragPos = vec3(model * vec4(position, 1.0));
+    TexCoord = heightSample * gridScale;
+}
@@ -0,0 +1,287 @@
+#ifndef TERRAINCHUNKS_H
+#define TERRAINCHUNKS_H
+
+#include <glm/glm.hpp>
+
+#include "batchnoise.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Heightmap terrain split into a fixed grid of chunks with geomipmapped LODs.
+//
+// The heightmap has SAMPLES x SAMPLES heights stored as 16-bit unsigned values
+// (0 = lowest, 65535 = highest). The terrain lives in a unit square in local
+// space, x and z in [-0.5, 0.5] and y in [0, 1], so one model matrix places,
+// sizes and raises it.
+//
+// Every chunk is drawn from the same (CHUNK_QUADS + 1)^2 vertex grid; LOD l
+// only uses every 2^l-th vertex. Neighbouring chunks differ by at most one
+// LOD, and the finer side of such an edge skips its odd vertices (the stitch
+// mask), so there are no cracks. The index list depends only on LOD and
+// stitch mask, so buildIndices() patterns are shared by all chunks.
+//
+// The chunk count is fixed and LOD distances are measured in chunk widths,
+// so the triangle count does not grow with the terrain size. No GL calls here.
+class TerrainChunks
+{
+public:
+    static const int CHUNKS = 16;           // per side
+    static const int CHUNK_QUADS = 32;      // per side at LOD 0
+    static const int LODS = 6;              // LOD 5 is a single quad
+    static const int SAMPLES = CHUNKS * CHUNK_QUADS + 1;
+    static const int GRID = CHUNK_QUADS + 1; // vertices per side of the shared chunk grid
+
+    // stitch mask bits: that edge's neighbour is one LOD coarser
+    enum { STITCH_LEFT = 1, STITCH_RIGHT = 2, STITCH_BACK = 4, STITCH_FRONT = 8 }; // -x, +x, -z, +z
+    static const int STITCH_PATTERNS = 16;
+
+    struct Chunk
+    {
+        uint16_t minHeight = 0;
+        uint16_t maxHeight = 0;
+        int lod = 0;
+        int stitch = 0;
+        bool visible = true;
+    };
+
+    TerrainChunks()
+        : m_Heights((size_t)SAMPLES * SAMPLES, 0), m_Chunks(CHUNKS * CHUNKS)
+    {
+    }
+
+    // fBm of glm::perlin; `features` is roughly the number of hills across the terrain
+    void generate(unsigned int seed, float features)
+    {
+        glm::vec2 offset((seed % 1000u) * 17.31f, (seed / 1000u % 1000u) * 23.17f + seed * 0.013f);
+        std::vector<float> heights((size_t)SAMPLES * SAMPLES);
+        FbmSettings fbm;
+        fbm.octaves = OCTAVES;
+        BatchNoise::fbmGrid(fbm, offset, glm::vec2(features / (SAMPLES - 1)), SAMPLES, SAMPLES, heights.data());
+
+        // stretch to the full 16-bit range
+        float low = *std::min_element(heights.begin(), heights.end());
+        float high = *std::max_element(heights.begin(), heights.end());
+        float scale = high > low ? 65535.0f / (high - low) : 0.0f;
+        for (size_t i = 0; i < heights.size(); i++)
+            m_Heights[i] = (uint16_t)((heights[i] - low) * scale + 0.5f);
+
+        for (int cz = 0; cz < CHUNKS; cz++)
+        {
+            for (int cx = 0; cx < CHUNKS; cx++)
+            {
+                Chunk& chunk = m_Chunks[cz * CHUNKS + cx];
+                chunk.minHeight = 65535;
+                chunk.maxHeight = 0;
+                for (int z = 0; z < GRID; z++)
+                {
+                    for (int x = 0; x < GRID; x++)
+                    {
+                        uint16_t h = sample(cx * CHUNK_QUADS + x, cz * CHUNK_QUADS + z);
+                        chunk.minHeight = std::min(chunk.minHeight, h);
+                        chunk.maxHeight = std::max(chunk.maxHeight, h);
+                    }
+                }
+            }
+        }
+    }
+
+    const std::vector<uint16_t>& heights() const { return m_Heights; }
+    uint16_t sample(int x, int z) const { return m_Heights[(size_t)z * SAMPLES + x]; }
+    const Chunk& chunk(int cx, int cz) const { return m_Chunks[cz * CHUNKS + cx]; }
+
+    // local height in [0, 1] at local x, z in [-0.5, 0.5] (bilinear)
+    float heightAt(float x, float z) const
+    {
+        float fx = glm::clamp(x + 0.5f, 0.0f, 1.0f) * (SAMPLES - 1);
+        float fz = glm::clamp(z + 0.5f, 0.0f, 1.0f) * (SAMPLES - 1);
+        int x0 = std::min((int)fx, SAMPLES - 2), z0 = std::min((int)fz, SAMPLES - 2);
+        float tx = fx - x0, tz = fz - z0;
+        float top = sample(x0, z0) * (1.0f - tx) + sample(x0 + 1, z0) * tx;
+        float bottom = sample(x0, z0 + 1) * (1.0f - tx) + sample(x0 + 1, z0 + 1) * tx;
+        return (top * (1.0f - tz) + bottom * tz) / 65535.0f;
+    }
+
+    // world-space box of a chunk under the terrain's model matrix (translate + scale only)
+    void chunkBounds(int cx, int cz, const glm::vec3& position, const glm::vec3& size, glm::vec3& boxMin, glm::vec3& boxMax) const
+    {
+        const Chunk& c = chunk(cx, cz);
+        boxMin = position + size * glm::vec3((float)cx / CHUNKS - 0.5f, c.minHeight / 65535.0f, (float)cz / CHUNKS - 0.5f);
+        boxMax = position + size * glm::vec3((float)(cx + 1) / CHUNKS - 0.5f, c.maxHeight / 65535.0f, (float)(cz + 1) / CHUNKS - 0.5f);
+    }
+
+    // pick every chunk's LOD from its distance to the camera: LOD 0 up to
+    // lodDistance chunk widths, one LOD coarser each time the distance doubles.
+    // planes (optional, inward xyz + w) mark chunks outside the frustum invisible.
+    void select(const glm::vec3& camera, const glm::vec3& position, const glm::vec3& size, float lodDistance, const glm::vec4* planes)
+    {
+        float chunkWidth = std::max(size.x, size.z) / CHUNKS;
+        float base = std::max(lodDistance * chunkWidth, 1e-3f);
+        for (int cz = 0; cz < CHUNKS; cz++)
+        {
+            for (int cx = 0; cx < CHUNKS; cx++)
+            {
+                glm::vec3 boxMin, boxMax;
+                chunkBounds(cx, cz, position, size, boxMin, boxMax);
+                float distance = glm::length(camera - glm::clamp(camera, boxMin, boxMax));
+                Chunk& c = m_Chunks[cz * CHUNKS + cx];
+                c.lod = distance < base ? 0 : std::min(LODS - 1, 1 + (int)std::floor(std::log2(distance / base)));
+                c.visible = !planes || boxInFrustum(boxMin, boxMax, planes);
+            }
+        }
+
+        // neighbours may differ by one LOD at most; only ever refine, so this settles
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (int cz = 0; cz < CHUNKS; cz++)
+            {
+                for (int cx = 0; cx < CHUNKS; cx++)
+                {
+                    int& lod = m_Chunks[cz * CHUNKS + cx].lod;
+                    int limit = LODS - 1;
+                    if (cx > 0) limit = std::min(limit, chunk(cx - 1, cz).lod + 1);
+                    if (cx + 1 < CHUNKS) limit = std::min(limit, chunk(cx + 1, cz).lod + 1);
+                    if (cz > 0) limit = std::min(limit, chunk(cx, cz - 1).lod + 1);
+                    if (cz + 1 < CHUNKS) limit = std::min(limit, chunk(cx, cz + 1).lod + 1);
+                    if (lod > limit)
+                    {
+                        lod = limit;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        m_Triangles = 0;
+        for (int cz = 0; cz < CHUNKS; cz++)
+        {
+            for (int cx = 0; cx < CHUNKS; cx++)
+            {
+                Chunk& c = m_Chunks[cz * CHUNKS + cx];
+                c.stitch = 0;
+                if (cx > 0 && chunk(cx - 1, cz).lod > c.lod) c.stitch |= STITCH_LEFT;
+                if (cx + 1 < CHUNKS && chunk(cx + 1, cz).lod > c.lod) c.stitch |= STITCH_RIGHT;
+                if (cz > 0 && chunk(cx, cz - 1).lod > c.lod) c.stitch |= STITCH_BACK;
+                if (cz + 1 < CHUNKS && chunk(cx, cz + 1).lod > c.lod) c.stitch |= STITCH_FRONT;
+                if (c.visible)
+                    m_Triangles += 2 * (CHUNK_QUADS >> c.lod) * (CHUNK_QUADS >> c.lod);
+            }
+        }
+    }
+
+    // triangles in the visible chunks after the last select() (stitching drops a few)
+    int triangles() const { return m_Triangles; }
+
+    // triangle list into the GRID x GRID chunk vertices (index = z * GRID + x).
+    // A stitched edge drops its odd vertices onto the even vertex before them,
+    // which matches the coarser neighbour's edge exactly.
+    static void buildIndices(int lod, int stitch, std::vector<uint32_t>& indices)
+    {
+        int step = 1 << lod;
+        auto vertex = [&](int x, int z) -> uint32_t
+        {
+            if ((stitch & STITCH_BACK) && z == 0 && (x / step) % 2 == 1)
+                x -= step;
+            else if ((stitch & STITCH_FRONT) && z == CHUNK_QUADS && (x / step) % 2 == 1)
+                x -= step;
+            else if ((stitch & STITCH_LEFT) && x == 0 && (z / step) % 2 == 1)
+                z -= step;
+            else if ((stitch & STITCH_RIGHT) && x == CHUNK_QUADS && (z / step) % 2 == 1)
+                z -= step;
+            return (uint32_t)(z * GRID + x);
+        };
+        auto triangle = [&](uint32_t a, uint32_t b, uint32_t c)
+        {
+            if (a != b && b != c && a != c)
+            {
+                indices.push_back(a);
+                indices.push_back(b);
+                indices.push_back(c);
+            }
+        };
+        for (int z = 0; z < CHUNK_QUADS; z += step)
+        {
+            for (int x = 0; x < CHUNK_QUADS; x += step)
+            {
+                uint32_t a = vertex(x, z), b = vertex(x + step, z), c = vertex(x + step, z + step), d = vertex(x, z + step);
+                triangle(a, d, c);
+                triangle(a, c, b);
+            }
+        }
+    }
+
+    // a coarse triangle list of the whole terrain in local space, for the CPU
+    // occlusion culler. It must never be above the drawn terrain, at any LOD:
+    // every drawn triangle of a chunk lies between the chunk's lowest and
+    // highest sample, so each occluder cell is kept at the lowest minHeight of
+    // the chunks it overlaps, and each vertex at the lowest of its cells.
+    void occluderMesh(int quads, std::vector<float>& positions, std::vector<unsigned int>& indices) const
+    {
+        positions.clear();
+        indices.clear();
+        std::vector<uint16_t> cellMin((size_t)quads * quads);
+        for (int z = 0; z < quads; z++)
+        {
+            for (int x = 0; x < quads; x++)
+            {
+                // the chunks overlapping [x, x + 1) / quads, and likewise along z
+                int cx0 = x * CHUNKS / quads, cx1 = ((x + 1) * CHUNKS + quads - 1) / quads - 1;
+                int cz0 = z * CHUNKS / quads, cz1 = ((z + 1) * CHUNKS + quads - 1) / quads - 1;
+                uint16_t lowest = 65535;
+                for (int cz = cz0; cz <= cz1; cz++)
+                    for (int cx = cx0; cx <= cx1; cx++)
+                        lowest = std::min(lowest, chunk(cx, cz).minHeight);
+                cellMin[(size_t)z * quads + x] = lowest;
+            }
+        }
+        for (int z = 0; z <= quads; z++)
+        {
+            for (int x = 0; x <= quads; x++)
+            {
+                uint16_t lowest = 65535;
+                for (int cz = std::max(z - 1, 0); cz <= std::min(z, quads - 1); cz++)
+                    for (int cx = std::max(x - 1, 0); cx <= std::min(x, quads - 1); cx++)
+                        lowest = std::min(lowest, cellMin[(size_t)cz * quads + cx]);
+                positions.push_back((float)x / quads - 0.5f);
+                positions.push_back(lowest / 65535.0f);
+                positions.push_back((float)z / quads - 0.5f);
+            }
+        }
+        for (int z = 0; z < quads; z++)
+        {
+            for (int x = 0; x < quads; x++)
+            {
+                unsigned int a = z * (quads + 1) + x, b = a + 1, d = a + quads + 1, c = d + 1;
+                unsigned int quad[6] = { a, d, c, a, c, b };
+                indices.insert(indices.end(), quad, quad + 6);
+            }
+        }
+    }
+
+private:
+    static const int OCTAVES = 5;
+
+    std::vector<uint16_t> m_Heights;
+    std::vector<Chunk> m_Chunks;
+    int m_Triangles = 0;
+
+    static bool boxInFrustum(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec4* planes)
+    {
+        for (int p = 0; p < 6; p++)
+        {
+            // the box corner furthest along the plane normal
+            glm::vec3 corner(planes[p].x >= 0.0f ? boxMax.x : boxMin.x, planes[p].y >= 0.0f ? boxMax.y : boxMin.y,
+                planes[p].z >= 0.0f ? boxMax.z : boxMin.z);
+            if (glm::dot(glm::vec3(planes[p]), corner) + planes[p].w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+};
+
+// TERRAINCHUNKS_H
+#endif
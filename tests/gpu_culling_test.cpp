@@ -0,0 +1,110 @@
+// CPU-only test for the CPU mirror of the GPU culling pass (gpuculling.h).
+//
+// Usage: gpu-culling-test
+//
+// GpuCulling::verify() checks the compute shader against cullOnCpu(), so
+// the mirror has to be right on its own: frustumPlanes() against clip-space
+// containment, then the draw command of every object in a scene with known
+// answers (inside, behind, past the far plane, off to a side, straddling a
+// plane, scaled up, occluded).
+
+#include "gpuculling.h"
+#include "test_common.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstdint>
+#include <vector>
+
+static bool insidePlanes(const glm::vec4 planes[6], const glm::vec3& point)
+{
+    for (int p = 0; p < 6; p++)
+        if (glm::dot(glm::vec3(planes[p]), point) + planes[p].w < 0.0f)
+            return false;
+    return true;
+}
+
+static CullObject object(const glm::vec3& position, float scale, bool occluded, uint32_t mesh)
+{
+    CullObject object = {};
+    object.model = Affine(glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(scale)));
+    object.mesh = mesh;
+    object.occluded = occluded ? 1u : 0u;
+    return object;
+}
+
+int main()
+{
+    // the camera at (0, 0, 10) looking down -z: 90 degrees wide, so at 10
+    // units in front of it the frustum is 10 units to either side
+    glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 viewProjection = projection * view;
+    glm::vec4 planes[6];
+    GpuCulling::frustumPlanes(viewProjection, planes);
+
+    // the planes are normalized and agree with clip space on a grid of points
+    for (int p = 0; p < 6; p++)
+        CHECK(glm::abs(glm::length(glm::vec3(planes[p])) - 1.0f) < 1e-5f);
+    int disagreements = 0;
+    for (int x = -12; x <= 12; x++)
+        for (int y = -12; y <= 12; y++)
+            for (int z = -100; z <= 20; z += 3)
+            {
+                glm::vec3 point(x * 1.7f + 0.3f, y * 1.3f - 0.2f, (float)z + 0.4f);
+                glm::vec4 clip = viewProjection * glm::vec4(point, 1.0f);
+                bool inClip = clip.w > 0.0f && glm::abs(clip.x) <= clip.w && glm::abs(clip.y) <= clip.w && glm::abs(clip.z) <= clip.w;
+                // points right on a plane can go either way
+                float margin = 1e-3f * glm::max(1.0f, clip.w);
+                bool onEdge = glm::abs(glm::abs(clip.x) - clip.w) < margin || glm::abs(glm::abs(clip.y) - clip.w) < margin
+                    || glm::abs(glm::abs(clip.z) - clip.w) < margin;
+                if (!onEdge && inClip != insidePlanes(planes, point))
+                    disagreements++;
+            }
+    CHECK(disagreements == 0);
+
+    std::vector<CullMesh> meshes = {
+        { 36, 0, 0, 1.0f },        // a unit-radius mesh
+        { 120, 36, 24, 0.5f },     // a smaller one further into the merged buffers
+    };
+    struct Case { CullObject object; bool visible; };
+    std::vector<Case> cases = {
+        { object(glm::vec3(0.0f, 0.0f, 0.0f), 1.0f, false, 0), true },        // in front of the camera
+        { object(glm::vec3(0.0f, 0.0f, 20.0f), 1.0f, false, 0), false },      // behind it
+        { object(glm::vec3(0.0f, 0.0f, -200.0f), 1.0f, false, 0), false },    // past the far plane
+        { object(glm::vec3(0.0f, 0.0f, -90.5f), 1.0f, false, 0), true },      // reaching over the far plane
+        { object(glm::vec3(50.0f, 0.0f, 0.0f), 1.0f, false, 0), false },      // far to the right
+        { object(glm::vec3(0.0f, -50.0f, 0.0f), 1.0f, false, 1), false },     // far below
+        // the left plane is x = -10 at z = 0; a sphere's reach across it is
+        // its radius over cos(45 degrees) along x
+        { object(glm::vec3(-11.0f, 0.0f, 0.0f), 1.0f, false, 0), true },      // straddles it
+        { object(glm::vec3(-11.6f, 0.0f, 0.0f), 1.0f, false, 0), false },     // just clear of it
+        { object(glm::vec3(-11.6f, 0.0f, 0.0f), 2.0f, false, 0), true },      // the same, scaled up
+        { object(glm::vec3(-10.8f, 0.0f, 0.0f), 1.0f, false, 1), false },     // a smaller mesh just clear of it
+        { object(glm::vec3(0.0f, 0.0f, 0.0f), 1.0f, true, 0), false },        // hidden by the occlusion culler
+    };
+    std::vector<CullObject> objects;
+    for (const Case& c : cases)
+        objects.push_back(c.object);
+
+    std::vector<DrawElementsIndirectCommand> commands;
+    GpuCulling::cullOnCpu(objects, meshes, planes, commands);
+    CHECK(commands.size() == objects.size());
+    for (size_t i = 0; i < cases.size() && i < commands.size(); i++)
+    {
+        const CullMesh& mesh = meshes[objects[i].mesh];
+        if (!CHECK(commands[i].instanceCount == (cases[i].visible ? 1u : 0u)))
+            printf("  object %d\n", (int)i);
+        CHECK(commands[i].count == mesh.indexCount);
+        CHECK(commands[i].firstIndex == mesh.firstIndex);
+        CHECK(commands[i].baseVertex == mesh.baseVertex);
+        CHECK(commands[i].baseInstance == (uint32_t)i);
+    }
+
+    // the commands buffer is reused: a smaller scene shrinks it
+    objects.resize(3);
+    GpuCulling::cullOnCpu(objects, meshes, planes, commands);
+    CHECK(commands.size() == 3);
+
+    return testSummary("gpu-culling-test");
+}
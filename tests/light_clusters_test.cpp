@@ -0,0 +1,215 @@
+// CPU-only test for the light cluster grid (lightclusters.h).
+//
+// Usage: light-clusters-test
+//
+// Bins lights placed at known spots of a 16x9x24 grid and checks where they
+// land: a small light in the middle of one froxel, lights straddling a depth
+// slice and a screen tile boundary, and 1000 lights in a single cluster. The
+// ranges have to be a running sum ending at indexCount, and on a cloud of
+// random lights the SIMD binning has to give exactly the clusters the scalar
+// sphereTouchesBox() does. Depths at or behind the camera must not reach the
+// log in sliceForDepth().
+
+#include "lightclusters.h"
+#include "test_common.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+static const float zNear = 0.1f, zFar = 100.0f;
+
+static PointLight makeLight(const glm::vec3& position, float radius)
+{
+    PointLight light;
+    light.position = position;
+    light.radius = radius;
+    light.color = glm::vec3(1.0f);
+    light.intensity = 1.0f;
+    return light;
+}
+
+static float sliceDepth(const LightClusterGrid& grid, float slice)
+{
+    return zNear * std::pow(zFar / zNear, slice / grid.slices());
+}
+
+// the view-space point at NDC (ndcX, ndcY) and `depth` in front of the camera
+static glm::vec3 viewPoint(const glm::mat4& projection, float ndcX, float ndcY, float depth)
+{
+    return glm::vec3(ndcX * depth / projection[0][0], ndcY * depth / projection[1][1], -depth);
+}
+
+static int clusterIndex(const LightClusterGrid& grid, int tileX, int tileY, int slice)
+{
+    return (slice * grid.tilesY() + tileY) * grid.tilesX() + tileX;
+}
+
+static bool clusterHas(const LightClusterGrid& grid, int cluster, uint32_t light)
+{
+    const std::vector<uint32_t>& ranges = grid.clusterRanges();
+    const std::vector<uint32_t>& indices = grid.lightIndices();
+    for (uint32_t i = 0; i < ranges[cluster * 2 + 1]; i++)
+        if (indices[ranges[cluster * 2] + i] == light)
+            return true;
+    return false;
+}
+
+// the froxel AABBs are conservative and overlap their neighbours a little, so
+// a light may also land next door, but never farther than one tile or slice
+static bool onlyAround(const LightClusterGrid& grid, uint32_t light, int tileX, int tileY, int slice)
+{
+    for (int c = 0; c < grid.clusterCount(); c++)
+    {
+        int x = c % grid.tilesX(), y = (c / grid.tilesX()) % grid.tilesY();
+        int s = c / (grid.tilesX() * grid.tilesY());
+        bool near = std::abs(x - tileX) <= 1 && std::abs(y - tileY) <= 1 && std::abs(s - slice) <= 1;
+        if (!near && clusterHas(grid, c, light))
+            return false;
+    }
+    return true;
+}
+
+// first entries are the running sum of the counts, ending at indexCount
+static bool rangesArePrefixSums(const LightClusterGrid& grid)
+{
+    const std::vector<uint32_t>& ranges = grid.clusterRanges();
+    if (ranges.size() != (size_t)grid.clusterCount() * 2)
+        return false;
+    uint32_t sum = 0;
+    for (int c = 0; c < grid.clusterCount(); c++)
+    {
+        if (ranges[c * 2] != sum)
+            return false;
+        sum += ranges[c * 2 + 1];
+    }
+    return sum == (uint32_t)grid.stats().indexCount && sum == grid.lightIndices().size();
+}
+
+int main()
+{
+    // the camera at the origin looking down -z, so view space is world space
+    glm::mat4 view(1.0f);
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, zNear, zFar);
+    LightClusterGrid grid(16, 9, 24);
+
+    // before any build sliceForDepth has no depth range, but must not take the
+    // log of zero or a negative depth either
+    CHECK(grid.sliceForDepth(0.0f) == 0);
+    CHECK(grid.sliceForDepth(-1.0f) == 0);
+
+    // one small light in the middle of froxel (3, 2, 10)
+    {
+        float depth = sliceDepth(grid, 10.5f);
+        float ndcX = -1.0f + 2.0f * 3.5f / 16.0f, ndcY = -1.0f + 2.0f * 2.5f / 9.0f;
+        std::vector<PointLight> lights = { makeLight(viewPoint(projection, ndcX, ndcY, depth), depth * 0.001f) };
+        grid.build(view, projection, zNear, zFar, lights);
+        int cluster = clusterIndex(grid, 3, 2, 10);
+        CHECK(grid.stats().clusters == 16 * 9 * 24);
+        CHECK(grid.stats().lights == 1);
+        CHECK(grid.stats().maxPerCluster == 1);
+        CHECK(grid.clusterRanges()[cluster * 2 + 1] == 1);
+        CHECK(clusterHas(grid, cluster, 0));
+        CHECK(onlyAround(grid, 0, 3, 2, 10));
+        CHECK(rangesArePrefixSums(grid));
+        CHECK(grid.sliceForDepth(depth) == 10);
+    }
+
+    // sliceForDepth clamps what lies outside [zNear, zFar], NaN included
+    CHECK(grid.sliceForDepth(zNear) == 0);
+    CHECK(grid.sliceForDepth(zFar * 0.999f) == 23);
+    CHECK(grid.sliceForDepth(0.0f) == 0);
+    CHECK(grid.sliceForDepth(-5.0f) == 0);
+    CHECK(grid.sliceForDepth(zNear * 0.5f) == 0);
+    CHECK(grid.sliceForDepth(zFar * 10.0f) == 23);
+    CHECK(grid.sliceForDepth(std::numeric_limits<float>::infinity()) == 23);
+    CHECK(grid.sliceForDepth(std::numeric_limits<float>::quiet_NaN()) == 0);
+
+    // straddling the boundary between slices 7 and 8, inside tile (5, 6)
+    {
+        float depth = sliceDepth(grid, 8.0f);
+        float ndcX = -1.0f + 2.0f * 5.5f / 16.0f, ndcY = -1.0f + 2.0f * 6.5f / 9.0f;
+        std::vector<PointLight> lights = { makeLight(viewPoint(projection, ndcX, ndcY, depth), depth * 0.005f) };
+        grid.build(view, projection, zNear, zFar, lights);
+        CHECK(clusterHas(grid, clusterIndex(grid, 5, 6, 7), 0));
+        CHECK(clusterHas(grid, clusterIndex(grid, 5, 6, 8), 0));
+        CHECK(onlyAround(grid, 0, 5, 6, 7) || onlyAround(grid, 0, 5, 6, 8));
+        CHECK(rangesArePrefixSums(grid));
+    }
+
+    // straddling the boundary between tiles 7 and 8 (the middle of the
+    // screen), inside slice 12
+    {
+        float depth = sliceDepth(grid, 12.5f);
+        float ndcY = -1.0f + 2.0f * 4.5f / 9.0f;
+        std::vector<PointLight> lights = { makeLight(viewPoint(projection, 0.0f, ndcY, depth), depth * 0.005f) };
+        grid.build(view, projection, zNear, zFar, lights);
+        CHECK(clusterHas(grid, clusterIndex(grid, 7, 4, 12), 0));
+        CHECK(clusterHas(grid, clusterIndex(grid, 8, 4, 12), 0));
+        CHECK(onlyAround(grid, 0, 7, 4, 12) || onlyAround(grid, 0, 8, 4, 12));
+        CHECK(rangesArePrefixSums(grid));
+    }
+
+    // 1000 lights in one cluster: none dropped, none capped
+    {
+        float depth = sliceDepth(grid, 6.5f);
+        float ndcX = -1.0f + 2.0f * 12.5f / 16.0f, ndcY = -1.0f + 2.0f * 1.5f / 9.0f;
+        glm::vec3 center = viewPoint(projection, ndcX, ndcY, depth);
+        std::vector<PointLight> lights;
+        for (int i = 0; i < 1000; i++)
+            lights.push_back(makeLight(center + glm::vec3(0.0f, 0.0f, (i % 10) * depth * 1e-5f), depth * 1e-4f));
+        grid.build(view, projection, zNear, zFar, lights);
+        int cluster = clusterIndex(grid, 12, 1, 6);
+        CHECK(grid.clusterRanges()[cluster * 2 + 1] == 1000);
+        CHECK(grid.stats().maxPerCluster == 1000);
+        CHECK(grid.stats().indexCount % 1000 == 0);
+        bool allThere = true;
+        for (uint32_t i = 0; i < 1000; i++)
+            allThere = allThere && clusterHas(grid, cluster, i);
+        CHECK(allThere);
+        CHECK(rangesArePrefixSums(grid));
+    }
+
+    // a random cloud seen from a turned camera: the SIMD binning against the
+    // scalar sphereTouchesBox() over every cluster's bounds
+    {
+        glm::mat4 turned = glm::lookAt(glm::vec3(3.0f, 2.0f, 5.0f), glm::vec3(-4.0f, 0.0f, -30.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> spread(-60.0f, 60.0f), radius(0.05f, 6.0f);
+        std::vector<PointLight> lights;
+        for (int i = 0; i < 1023; i++)     // not a multiple of four, so the padding is used
+            lights.push_back(makeLight(glm::vec3(spread(random), spread(random) * 0.3f, spread(random) - 40.0f), radius(random)));
+        grid.build(turned, projection, zNear, zFar, lights);
+        CHECK(rangesArePrefixSums(grid));
+
+        int mismatched = 0, expectedCount = 0;
+        for (int c = 0; c < grid.clusterCount(); c++)
+        {
+            glm::vec3 boundsMin, boundsMax;
+            grid.clusterBounds(c, boundsMin, boundsMax);
+            std::vector<uint32_t> expected;
+            for (uint32_t i = 0; i < lights.size(); i++)
+            {
+                glm::vec3 center = glm::vec3(turned * glm::vec4(lights[i].position, 1.0f));
+                if (LightClusterGrid::sphereTouchesBox(center, lights[i].radius, boundsMin, boundsMax))
+                    expected.push_back(i);
+            }
+            expectedCount += (int)expected.size();
+            const uint32_t* first = grid.lightIndices().data() + grid.clusterRanges()[c * 2];
+            std::vector<uint32_t> got(first, first + grid.clusterRanges()[c * 2 + 1]);
+            std::sort(got.begin(), got.end());
+            if (got != expected)
+                mismatched++;
+        }
+        CHECK(mismatched == 0);
+        CHECK(grid.stats().indexCount == expectedCount);
+        CHECK(expectedCount > 1023);
+    }
+
+    return testSummary("light-clusters-test");
+}
@@ -0,0 +1,144 @@
+// CPU-only test for the occlusion culler (occlusionculler.h).
+//
+// Usage: occlusion-culler-test
+//
+// Rasterizes one known occluder, a 10x10 wall 10 units in front of the
+// camera, and checks the depth it leaves (1/w = 0.1 on the wall, 0 around
+// it), the Hi-Z pyramid built on it, and which boxes are hidden: behind the
+// wall, in front of it, beside it, peeking past its edge, off screen,
+// crossing the near plane. Where the CPU has AVX2, the AVX2 row fill has to
+// leave exactly the depth the scalar one does.
+
+#include "occlusionculler.h"
+#include "test_common.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <vector>
+
+// the wall, two triangles, and the camera looking at it down -z
+static void drawWall(OcclusionCuller& culler, const glm::mat4& viewProjection)
+{
+    const float wall[] = {
+        -5.0f, -5.0f, -10.0f,
+         5.0f, -5.0f, -10.0f,
+         5.0f,  5.0f, -10.0f,
+        -5.0f,  5.0f, -10.0f,
+    };
+    const unsigned int indices[] = { 0, 1, 2, 0, 2, 3 };
+    culler.begin(viewProjection);
+    culler.addOccluder(wall, 3, 4, indices, 6, glm::mat4(1.0f));
+    culler.rasterize();
+}
+
+static bool visible(OcclusionCuller& culler, const glm::vec3& center, float halfSize)
+{
+    return culler.isVisible(center - glm::vec3(halfSize), center + glm::vec3(halfSize));
+}
+
+int main()
+{
+    // 90 degrees wide: at 10 units the screen is 20 units across, so the
+    // wall covers the middle half of it both ways
+    glm::mat4 projection = glm::perspective(glm::radians(90.0f), 2.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 viewProjection = projection * view;
+
+    OcclusionCuller culler(256, 128);
+    CHECK(culler.width() == 256 && culler.height() == 128);
+    drawWall(culler, viewProjection);
+    CHECK(culler.stats().occluderTriangles == 2);
+
+    // the wall spans x in [96, 160) and y in [32, 96) of the 256x128 buffer
+    const std::vector<float>& depth = culler.depth(0);
+    int covered = 0, wrong = 0;
+    for (int y = 0; y < culler.height(); y++)
+        for (int x = 0; x < culler.width(); x++)
+        {
+            float z = depth[(size_t)y * culler.width() + x];
+            bool inside = x >= 96 && x < 160 && y >= 32 && y < 96;
+            bool edge = x == 95 || x == 160 || y == 31 || y == 96;
+            if (inside)
+                covered++;
+            if (inside ? std::fabs(z - 0.1f) > 1e-5f : (!edge && z != 0.0f))
+                wrong++;
+        }
+    CHECK(covered == 64 * 64);
+    CHECK(wrong == 0);
+
+    // each Hi-Z texel keeps the farthest depth below it: 0.1 inside the wall,
+    // 0 where any of it is open
+    CHECK(culler.levelCount() == 9);
+    const std::vector<float>& level2 = culler.depth(2);
+    CHECK(std::fabs(level2[(size_t)16 * 64 + 32] - 0.1f) < 1e-5f);
+    CHECK(level2[(size_t)16 * 64 + 2] == 0.0f);
+    CHECK(culler.depth(culler.levelCount() - 1)[0] == 0.0f);
+
+    struct Case { glm::vec3 center; float halfSize; bool visible; const char* what; };
+    const Case cases[] = {
+        { glm::vec3(0.0f, 0.0f, -20.0f), 1.0f, false, "behind the wall" },
+        { glm::vec3(2.0f, -3.0f, -50.0f), 4.0f, false, "big, far behind the wall" },
+        { glm::vec3(0.0f, 0.0f, -5.0f), 1.0f, true, "in front of the wall" },
+        { glm::vec3(0.0f, 0.0f, -10.5f), 1.0f, true, "through the wall" },
+        { glm::vec3(15.0f, 0.0f, -20.0f), 1.0f, true, "beside the wall" },
+        { glm::vec3(10.0f, 0.0f, -20.0f), 1.0f, true, "peeking past its edge" },
+        { glm::vec3(0.0f, 0.0f, 20.0f), 1.0f, true, "behind the camera" },
+        { glm::vec3(0.0f, 0.0f, 0.0f), 1.0f, true, "crossing the near plane" },
+        { glm::vec3(0.0f, 80.0f, -20.0f), 1.0f, true, "off screen" },
+    };
+    int hidden = 0;
+    for (const Case& c : cases)
+    {
+        if (!CHECK(visible(culler, c.center, c.halfSize) == c.visible))
+            printf("  %s\n", c.what);
+        hidden += c.visible ? 0 : 1;
+    }
+    CHECK(culler.stats().tested == (int)(sizeof(cases) / sizeof(cases[0])));
+    CHECK(culler.stats().culled == hidden);
+
+    // without occluders nothing is hidden
+    culler.begin(viewProjection);
+    culler.rasterize();
+    CHECK(visible(culler, glm::vec3(0.0f, 0.0f, -20.0f), 1.0f));
+
+    // the AVX2 row fill against the scalar one, on triangles at odd angles
+    // and with edges inside the 8-pixel groups
+    if (CpuFeatures::get().avx2)
+    {
+        std::vector<float> mesh;
+        std::vector<unsigned int> indices;
+        for (int i = 0; i < 40; i++)
+        {
+            float a = i * 0.7f, r = 2.0f + (i % 7);
+            float z = -8.0f - (i % 11) * 3.0f;
+            glm::vec3 p[3] = {
+                glm::vec3(std::cos(a) * r, std::sin(a) * r, z),
+                glm::vec3(std::cos(a + 2.1f) * r * 0.6f, std::sin(a + 2.1f) * r * 0.6f, z - 2.0f),
+                glm::vec3(std::cos(a + 4.3f) * r * 0.9f, std::sin(a + 4.3f) * r * 0.9f, z + 1.5f),
+            };
+            for (const glm::vec3& v : p)
+            {
+                indices.push_back((unsigned int)(mesh.size() / 3));
+                mesh.insert(mesh.end(), { v.x, v.y, v.z });
+            }
+        }
+        std::vector<float> depths[2];
+        for (int avx2 = 0; avx2 < 2; avx2++)
+        {
+            culler.setAvx2(avx2 != 0);
+            CHECK(culler.avx2() == (avx2 != 0));
+            culler.begin(viewProjection);
+            culler.addOccluder(mesh.data(), 3, mesh.size() / 3, indices.data(), indices.size(), glm::mat4(1.0f));
+            culler.rasterize();
+            depths[avx2] = culler.depth(0);
+        }
+        CHECK(depths[0] == depths[1]);
+    }
+    else
+    {
+        printf("no AVX2 on this CPU; only the scalar row fill was tested\n");
+    }
+
+    return testSummary("occlusion-culler-test");
+}
@@ -0,0 +1,109 @@
+// CPU-only test for the min/max pyramid of PlotLod (plotlod.h).
+//
+// Usage: plot-lod-test
+//
+// Builds series with runs of NaN samples (which never widen a bucket) both
+// sample by sample with push() and at once with assign(), and checks that
+// both give the same pyramid and that range() matches a plain scan for
+// every range: a run at the start of a block, one covering whole blocks and
+// levels, NaN first and last, nothing but NaN, and random runs.
+
+#include "plotlod.h"
+#include "test_common.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+// every range of the series against a running scan that skips NaN
+static bool rangesMatchScan(const PlotLod& series, const std::vector<float>& values)
+{
+    int n = (int)values.size();
+    for (int first = 0; first <= n; first++)
+    {
+        float sMin = FLT_MAX, sMax = -FLT_MAX;
+        for (int count = 0; first + count <= n; count++)
+        {
+            if (count > 0 && values[first + count - 1] == values[first + count - 1])
+            {
+                sMin = std::fmin(sMin, values[first + count - 1]);
+                sMax = std::fmax(sMax, values[first + count - 1]);
+            }
+            float vMin, vMax;
+            series.range(first, count, &vMin, &vMax);
+            if (vMin != sMin || vMax != sMax)
+            {
+                printf("  range(%d, %d) of %d: %g..%g, the scan says %g..%g\n", first, count, n, vMin, vMax, sMin, sMax);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// the series pushed sample by sample and assigned at once, both against the scan
+static void checkSeries(const char* what, const std::vector<float>& values)
+{
+    PlotLod pushed, assigned;
+    for (float value : values)
+        pushed.push(value);
+    assigned.assign(values.data(), (int)values.size());
+    bool ok = CHECK(pushed.size() == (int)values.size());
+    ok = CHECK(pushed.pyramidBytes() == assigned.pyramidBytes()) && ok;
+    ok = CHECK(rangesMatchScan(pushed, values)) && ok;
+    ok = CHECK(rangesMatchScan(assigned, values)) && ok;
+    if (!ok)
+        printf("  %s\n", what);
+}
+
+static std::vector<float> runs(std::initializer_list<std::pair<int, float>> parts)
+{
+    std::vector<float> values;
+    for (const std::pair<int, float>& part : parts)
+        values.insert(values.end(), part.first, part.second);
+    return values;
+}
+
+int main()
+{
+    const float nan = NAN;
+    const int leaf = PlotLod::LEAF;
+
+    checkSeries("1.0, then NaN from a block start, then 3.0", runs({ { 32, 1.0f }, { 32, nan }, { 64, 3.0f } }));
+    checkSeries("NaN first", runs({ { 5, nan }, { 100, 2.0f } }));
+    checkSeries("NaN last", runs({ { 40, 2.0f }, { 77, nan } }));
+    checkSeries("only NaN", runs({ { 300, nan } }));
+    checkSeries("NaN over whole levels", runs({ { 1, 4.0f }, { leaf * 8, nan }, { 3, -1.0f }, { leaf * 16 + 5, nan }, { 1, 9.0f } }));
+    checkSeries("NaN inside blocks", runs({ { leaf / 2, 1.0f }, { leaf, nan }, { leaf / 2 + 3, -2.0f }, { 1, nan }, { leaf * 3, 0.5f } }));
+
+    // a value equal to the bucket so far never widens it either
+    checkSeries("constant", runs({ { leaf * 5 + 1, 7.0f } }));
+
+    // random runs of NaN and random values
+    uint32_t state = 7u;
+    auto next = [&state]() { state = state * 1664525u + 1013904223u; return state >> 8; };
+    for (int series = 0; series < 20; series++)
+    {
+        std::vector<float> values;
+        int size = 1 + (int)(next() % 700);
+        while ((int)values.size() < size)
+        {
+            int run = 1 + (int)(next() % (series % 2 ? 80 : 12));
+            bool gap = next() % 3 == 0;
+            for (int i = 0; i < run && (int)values.size() < size; i++)
+                values.push_back(gap ? nan : (float)(next() % 1000) * 0.01f - 5.0f);
+        }
+        checkSeries("random", values);
+    }
+
+    // an empty series has no range
+    PlotLod empty;
+    float vMin, vMax;
+    empty.range(0, 10, &vMin, &vMax);
+    CHECK(vMin == FLT_MAX && vMax == -FLT_MAX);
+
+    return testSummary("plot-lod-test");
+}
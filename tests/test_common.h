@@ -0,0 +1,36 @@
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <cstdio>
+
+// Shared helpers for the standalone test programs in this folder. Each one
+// runs its checks without a window or a GL context, prints every failed
+// check and returns testSummary(), nonzero when anything failed.
+
+#define CHECK(condition) testCheck((condition), #condition, __FILE__, __LINE__)
+
+inline int& testCounts(int which)
+{
+    static int counts[2] = { 0, 0 };    // checks run, checks failed
+    return counts[which];
+}
+
+inline bool testCheck(bool ok, const char* condition, const char* file, int line)
+{
+    testCounts(0)++;
+    if (!ok)
+    {
+        testCounts(1)++;
+        printf("%s:%d: CHECK(%s) failed\n", file, line, condition);
+    }
+    return ok;
+}
+
+inline int testSummary(const char* name)
+{
+    printf("%s: %d checks, %d failed\n", name, testCounts(0), testCounts(1));
+    return testCounts(1) == 0 ? 0 : 1;
+}
+
+// TEST_COMMON_H
+#endif
@@ -0,0 +1,564 @@
+#ifndef TRANSFORMBATCH_H
+#define TRANSFORMBATCH_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "cpufeatures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// the wide paths are built everywhere on x86 and picked at run time
+#ifdef CPUFEATURES_X86
+#define TRANSFORMBATCH_AVX2 1
+#define TRANSFORMBATCH_AVX512 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#define TRANSFORMBATCH_SSE 1
+#endif
+
+// Translation/rotation/scale of many objects, one array per component
+// (structure of arrays), so that eight objects' x positions are one load.
+struct TransformArrays
+{
+    std::vector<float> px, py, pz;      // position
+    std::vector<float> qx, qy, qz, qw;  // rotation, unit quaternion
+    std::vector<float> sx, sy, sz;      // scale
+
+    size_t size() const { return px.size(); }
+
+    void resize(size_t count)
+    {
+        std::vector<float>* arrays[] = { &px, &py, &pz, &qx, &qy, &qz, &qw, &sx, &sy, &sz };
+        for (std::vector<float>* array : arrays)
+            array->resize(count);
+    }
+
+    void set(size_t i, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        px[i] = position.x; py[i] = position.y; pz[i] = position.z;
+        qx[i] = rotation.x; qy[i] = rotation.y; qz[i] = rotation.z; qw[i] = rotation.w;
+        sx[i] = scale.x; sy[i] = scale.y; sz[i] = scale.z;
+    }
+};
+
+// Matrix work for many objects at once: model matrices from TransformArrays,
+// rotations advanced by angular velocities, products against one shared
+// matrix (projection * view * model) or pairwise, points and bounding boxes
+// through a matrix.
+//
+// Products run one matrix at a time with all four result columns in flight
+// (one AVX-512 register, two AVX registers or four SSE ones) and add in glm's
+// order, so they match glm's operator* exactly (unless the compiler contracts
+// glm's code into FMAs). The rest works across objects instead, one object
+// per lane (up to 16; 8 for compose(), which transposes its lanes into
+// column-major matrices on the way out). SSE2 is compiled in where the
+// compiler targets it; AVX2 and AVX-512 are picked at run time from
+// CpuFeatures, so the app runs them without /arch:AVX2 or /arch:AVX512 and
+// still starts on CPUs without them. The scalar code is the fallback and
+// handles leftovers.
+class TransformBatch
+{
+public:
+    enum SimdPath { SCALAR, SSE2, AVX2, AVX512 };
+
+    // the widest path this build and CPU can run
+    static SimdPath supportedPath()
+    {
+#if defined(TRANSFORMBATCH_AVX512)
+        if (CpuFeatures::get().avx512)
+            return AVX512;
+#endif
+#if defined(TRANSFORMBATCH_AVX2)
+        if (CpuFeatures::get().avx2)
+            return AVX2;
+#endif
+#if defined(TRANSFORMBATCH_SSE)
+        return SSE2;
+#else
+        return SCALAR;
+#endif
+    }
+
+    // the path in use: the supported one, unless limited to a narrower one
+    // (to compare the paths)
+    static SimdPath path() { return activePath(); }
+    static void setMaxPath(SimdPath path) { activePath() = std::min(path, supportedPath()); }
+
+    static const char* pathName(SimdPath path)
+    {
+        static const char* names[] = { "scalar", "SSE2", "AVX2", "AVX-512" };
+        return names[path];
+    }
+    static const char* simdPath() { return pathName(path()); }
+
+    // out[i] = left * right[i]
+    static void multiply(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, int count)
+    {
+        multiplyStrided(&left, 0, right, out, count);
+    }
+
+    // out[i] = left[i] * right[i]
+    static void multiply(const glm::mat4* left, const glm::mat4* right, glm::mat4* out, int count)
+    {
+        multiplyStrided(left, 1, right, out, count);
+    }
+
+    // out[i] = translate(p[i]) * mat4_cast(q[i]) * scale(s[i])
+    static void compose(const TransformArrays& transforms, glm::mat4* out)
+    {
+        int count = (int)transforms.size();
+        int i = 0;
+        SimdPath simd = path();
+#if defined(TRANSFORMBATCH_AVX2)
+        if (simd >= AVX2)
+            i = composeAvx2(transforms, out, i, count);
+#endif
+#if defined(TRANSFORMBATCH_SSE)
+        if (simd >= SSE2)
+        {
+            for (; i + 4 <= count; i += 4)
+            {
+                Sse e[16];
+                composeLanes(transforms, i, e);
+                storeMatrices(e, out + i);
+            }
+        }
+#endif
+        for (; i < count; i++)
+        {
+            Scalar e[16];
+            composeLanes(transforms, i, e);
+            for (int k = 0; k < 16; k++)
+                (&out[i][0][0])[k] = e[k].v;
+        }
+    }
+
+    // turn every rotation by its angular velocity (world space, radians per
+    // second) for dt seconds: q += h * (w, 0) * q, then renormalize. With
+    // h = dt / 2 a step of angle a would come out as 2 * atan(a / 2), which
+    // adds up to visible drift over minutes; h is stretched by the series of
+    // tan(a / 2) / (a / 2) instead, so no trig is needed per step.
+    static void integrateRotations(TransformArrays& transforms, const float* wx, const float* wy, const float* wz, float dt)
+    {
+        int count = (int)transforms.size();
+        int i = 0;
+        SimdPath simd = path();
+#if defined(TRANSFORMBATCH_AVX512)
+        if (simd >= AVX512)
+            i = integrateAvx512(transforms, wx, wy, wz, dt, i, count);
+#endif
+#if defined(TRANSFORMBATCH_AVX2)
+        if (simd >= AVX2)
+            i = integrateAvx2(transforms, wx, wy, wz, dt, i, count);
+#endif
+#if defined(TRANSFORMBATCH_SSE)
+        if (simd >= SSE2)
+        {
+            for (; i + 4 <= count; i += 4)
+                integrateLanes<Sse>(transforms, wx, wy, wz, dt, i);
+        }
+#endif
+        for (; i < count; i++)
+            integrateLanes<Scalar>(transforms, wx, wy, wz, dt, i);
+    }
+
+    // (outX, outY, outZ)[i] = (m * vec4(x[i], y[i], z[i], 1)).xyz; out may alias in
+    static void transformPoints(const glm::mat4& m, const float* x, const float* y, const float* z,
+        float* outX, float* outY, float* outZ, int count)
+    {
+        int i = 0;
+        SimdPath simd = path();
+#if defined(TRANSFORMBATCH_AVX512)
+        if (simd >= AVX512)
+            i = pointsAvx512(m, x, y, z, outX, outY, outZ, i, count);
+#endif
+#if defined(TRANSFORMBATCH_AVX2)
+        if (simd >= AVX2)
+            i = pointsAvx2(m, x, y, z, outX, outY, outZ, i, count);
+#endif
+#if defined(TRANSFORMBATCH_SSE)
+        if (simd >= SSE2)
+        {
+            for (; i + 4 <= count; i += 4)
+                pointLanes<Sse>(m, x, y, z, outX, outY, outZ, i);
+        }
+#endif
+        for (; i < count; i++)
+            pointLanes<Scalar>(m, x, y, z, outX, outY, outZ, i);
+    }
+
+    // world-space boxes around local boxes under their models: the centre
+    // goes through the matrix, the half extent through its absolute value
+    // (the same box as transforming all eight corners, without the corners)
+    static void transformBoxes(const glm::mat4* models, const glm::vec3* localMin, const glm::vec3* localMax,
+        glm::vec3* worldMin, glm::vec3* worldMax, int count)
+    {
+#if defined(TRANSFORMBATCH_SSE)
+        bool sse = path() >= SSE2;
+#endif
+        for (int i = 0; i < count; i++)
+        {
+            glm::vec3 center = (localMin[i] + localMax[i]) * 0.5f;
+            glm::vec3 extent = (localMax[i] - localMin[i]) * 0.5f;
+            const glm::mat4& m = models[i];
+#if defined(TRANSFORMBATCH_SSE)
+            if (sse)
+            {
+                __m128 sign = _mm_set1_ps(-0.0f);
+                __m128 c0 = _mm_loadu_ps(&m[0][0]), c1 = _mm_loadu_ps(&m[1][0]), c2 = _mm_loadu_ps(&m[2][0]), c3 = _mm_loadu_ps(&m[3][0]);
+                __m128 worldCenter = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(center.x)), _mm_mul_ps(c1, _mm_set1_ps(center.y))),
+                    _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(center.z)), c3));
+                __m128 worldExtent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(sign, c0), _mm_set1_ps(extent.x)),
+                    _mm_mul_ps(_mm_andnot_ps(sign, c1), _mm_set1_ps(extent.y))), _mm_mul_ps(_mm_andnot_ps(sign, c2), _mm_set1_ps(extent.z)));
+                float low[4], high[4];
+                _mm_storeu_ps(low, _mm_sub_ps(worldCenter, worldExtent));
+                _mm_storeu_ps(high, _mm_add_ps(worldCenter, worldExtent));
+                worldMin[i] = glm::vec3(low[0], low[1], low[2]);
+                worldMax[i] = glm::vec3(high[0], high[1], high[2]);
+                continue;
+            }
+#endif
+            glm::vec3 worldCenter(m * glm::vec4(center, 1.0f));
+            glm::vec3 worldExtent = glm::abs(glm::vec3(m[0])) * extent.x + glm::abs(glm::vec3(m[1])) * extent.y
+                + glm::abs(glm::vec3(m[2])) * extent.z;
+            worldMin[i] = worldCenter - worldExtent;
+            worldMax[i] = worldCenter + worldExtent;
+        }
+    }
+
+private:
+    static SimdPath& activePath()
+    {
+        static SimdPath path = supportedPath();
+        return path;
+    }
+
+    // ---- lane types: float-like values, one object per lane ----
+
+    struct Scalar
+    {
+        float v;
+        Scalar(float value = 0.0f) : v(value) {}
+        static Scalar load(const float* p) { return *p; }
+        void store(float* p) const { *p = v; }
+        friend Scalar operator+(Scalar a, Scalar b) { return a.v + b.v; }
+        friend Scalar operator-(Scalar a, Scalar b) { return a.v - b.v; }
+        friend Scalar operator*(Scalar a, Scalar b) { return a.v * b.v; }
+        friend Scalar operator/(Scalar a, Scalar b) { return a.v / b.v; }
+        friend Scalar sqrt(Scalar a) { return std::sqrt(a.v); }
+    };
+
+#if defined(TRANSFORMBATCH_SSE)
+    struct Sse
+    {
+        __m128 v;
+        Sse(float value = 0.0f) : v(_mm_set1_ps(value)) {}
+        Sse(__m128 value) : v(value) {}
+        static Sse load(const float* p) { return _mm_loadu_ps(p); }
+        void store(float* p) const { _mm_storeu_ps(p, v); }
+        friend Sse operator+(Sse a, Sse b) { return _mm_add_ps(a.v, b.v); }
+        friend Sse operator-(Sse a, Sse b) { return _mm_sub_ps(a.v, b.v); }
+        friend Sse operator*(Sse a, Sse b) { return _mm_mul_ps(a.v, b.v); }
+        friend Sse operator/(Sse a, Sse b) { return _mm_div_ps(a.v, b.v); }
+        friend Sse sqrt(Sse a) { return _mm_sqrt_ps(a.v); }
+    };
+#endif
+
+#if defined(TRANSFORMBATCH_AVX2)
+    struct Avx
+    {
+        __m256 v;
+        CPU_TARGET_AVX2 Avx(float value = 0.0f) : v(_mm256_set1_ps(value)) {}
+        CPU_TARGET_AVX2 Avx(__m256 value) : v(value) {}
+        static CPU_TARGET_AVX2 Avx load(const float* p) { return _mm256_loadu_ps(p); }
+        CPU_TARGET_AVX2 void store(float* p) const { _mm256_storeu_ps(p, v); }
+        friend CPU_TARGET_AVX2 Avx operator+(Avx a, Avx b) { return _mm256_add_ps(a.v, b.v); }
+        friend CPU_TARGET_AVX2 Avx operator-(Avx a, Avx b) { return _mm256_sub_ps(a.v, b.v); }
+        friend CPU_TARGET_AVX2 Avx operator*(Avx a, Avx b) { return _mm256_mul_ps(a.v, b.v); }
+        friend CPU_TARGET_AVX2 Avx operator/(Avx a, Avx b) { return _mm256_div_ps(a.v, b.v); }
+        friend CPU_TARGET_AVX2 Avx sqrt(Avx a) { return _mm256_sqrt_ps(a.v); }
+    };
+#endif
+
+#if defined(TRANSFORMBATCH_AVX512)
+    struct Avx512
+    {
+        __m512 v;
+        CPU_TARGET_AVX512 Avx512(float value = 0.0f) : v(_mm512_set1_ps(value)) {}
+        CPU_TARGET_AVX512 Avx512(__m512 value) : v(value) {}
+        static CPU_TARGET_AVX512 Avx512 load(const float* p) { return _mm512_loadu_ps(p); }
+        CPU_TARGET_AVX512 void store(float* p) const { _mm512_storeu_ps(p, v); }
+        friend CPU_TARGET_AVX512 Avx512 operator+(Avx512 a, Avx512 b) { return _mm512_add_ps(a.v, b.v); }
+        friend CPU_TARGET_AVX512 Avx512 operator-(Avx512 a, Avx512 b) { return _mm512_sub_ps(a.v, b.v); }
+        friend CPU_TARGET_AVX512 Avx512 operator*(Avx512 a, Avx512 b) { return _mm512_mul_ps(a.v, b.v); }
+        friend CPU_TARGET_AVX512 Avx512 operator/(Avx512 a, Avx512 b) { return _mm512_div_ps(a.v, b.v); }
+        friend CPU_TARGET_AVX512 Avx512 sqrt(Avx512 a) { return _mm512_sqrt_ps(a.v); }
+    };
+#endif
+
+    // ---- products ----
+
+    // left advances by leftStep matrices per product (0: one shared left)
+    static void multiplyStrided(const glm::mat4* left, int leftStep, const glm::mat4* right, glm::mat4* out, int count)
+    {
+        SimdPath simd = path();
+#if defined(TRANSFORMBATCH_AVX512)
+        if (simd >= AVX512)
+        {
+            multiplyAvx512(left, leftStep, right, out, count);
+            return;
+        }
+#endif
+#if defined(TRANSFORMBATCH_AVX2)
+        if (simd >= AVX2)
+        {
+            multiplyAvx2(left, leftStep, right, out, count);
+            return;
+        }
+#endif
+#if defined(TRANSFORMBATCH_SSE)
+        if (simd >= SSE2)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                const float* a = &left[i * leftStep][0][0];
+                const float* b = &right[i][0][0];
+                float* r = &out[i][0][0];
+                __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+                __m128 results[4];
+                for (int j = 0; j < 4; j++)
+                {
+                    __m128 column = _mm_loadu_ps(b + j * 4);
+                    __m128 sum = _mm_add_ps(_mm_mul_ps(a0, _mm_shuffle_ps(column, column, 0x00)), _mm_mul_ps(a1, _mm_shuffle_ps(column, column, 0x55)));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_shuffle_ps(column, column, 0xAA)));
+                    results[j] = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_shuffle_ps(column, column, 0xFF)));
+                }
+                for (int j = 0; j < 4; j++) // after all loads, so out may alias right
+                    _mm_storeu_ps(r + j * 4, results[j]);
+            }
+            return;
+        }
+#endif
+        for (int i = 0; i < count; i++)
+            out[i] = left[i * leftStep] * right[i];
+        (void)simd;
+    }
+
+#if defined(TRANSFORMBATCH_AVX512)
+    static CPU_TARGET_AVX512 void multiplyAvx512(const glm::mat4* left, int leftStep, const glm::mat4* right, glm::mat4* out, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            const float* a = &left[i * leftStep][0][0];
+            const float* b = &right[i][0][0];
+            float* r = &out[i][0][0];
+            // every 128-bit quarter holds a copy of a's column k times one entry of b's matching column
+            __m512 a0 = _mm512_broadcast_f32x4(_mm_loadu_ps(a)), a1 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 4));
+            __m512 a2 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 8)), a3 = _mm512_broadcast_f32x4(_mm_loadu_ps(a + 12));
+            __m512 columns = _mm512_loadu_ps(b);
+            __m512 sum = _mm512_add_ps(_mm512_mul_ps(a0, _mm512_permute_ps(columns, 0x00)), _mm512_mul_ps(a1, _mm512_permute_ps(columns, 0x55)));
+            sum = _mm512_add_ps(sum, _mm512_mul_ps(a2, _mm512_permute_ps(columns, 0xAA)));
+            sum = _mm512_add_ps(sum, _mm512_mul_ps(a3, _mm512_permute_ps(columns, 0xFF)));
+            _mm512_storeu_ps(r, sum);
+        }
+    }
+#endif
+
+#if defined(TRANSFORMBATCH_AVX2)
+    static CPU_TARGET_AVX2 void multiplyAvx2(const glm::mat4* left, int leftStep, const glm::mat4* right, glm::mat4* out, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            const float* a = &left[i * leftStep][0][0];
+            const float* b = &right[i][0][0];
+            float* r = &out[i][0][0];
+            __m256 a0 = _mm256_broadcast_ps((const __m128*)a), a1 = _mm256_broadcast_ps((const __m128*)(a + 4));
+            __m256 a2 = _mm256_broadcast_ps((const __m128*)(a + 8)), a3 = _mm256_broadcast_ps((const __m128*)(a + 12));
+            for (int half = 0; half < 2; half++)
+            {
+                __m256 columns = _mm256_loadu_ps(b + half * 8);
+                __m256 sum = _mm256_add_ps(_mm256_mul_ps(a0, _mm256_permute_ps(columns, 0x00)), _mm256_mul_ps(a1, _mm256_permute_ps(columns, 0x55)));
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(a2, _mm256_permute_ps(columns, 0xAA)));
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(a3, _mm256_permute_ps(columns, 0xFF)));
+                _mm256_storeu_ps(r + half * 8, sum);
+            }
+        }
+    }
+#endif
+
+    // ---- compose ----
+
+    // the 16 column-major entries of lanes i.. (glm::mat4_cast, scaled columns, translation)
+    template <typename L>
+    static CPU_FORCE_INLINE void composeLanes(const TransformArrays& t, int i, L e[16])
+    {
+        L x = L::load(&t.qx[i]), y = L::load(&t.qy[i]), z = L::load(&t.qz[i]), w = L::load(&t.qw[i]);
+        L sx = L::load(&t.sx[i]), sy = L::load(&t.sy[i]), sz = L::load(&t.sz[i]);
+        L xx = x * x, yy = y * y, zz = z * z;
+        L xy = x * y, xz = x * z, yz = y * z;
+        L wx = w * x, wy = w * y, wz = w * z;
+        L one(1.0f), two(2.0f), zero(0.0f);
+
+        e[0] = (one - two * (yy + zz)) * sx;
+        e[1] = two * (xy + wz) * sx;
+        e[2] = two * (xz - wy) * sx;
+        e[3] = zero;
+        e[4] = two * (xy - wz) * sy;
+        e[5] = (one - two * (xx + zz)) * sy;
+        e[6] = two * (yz + wx) * sy;
+        e[7] = zero;
+        e[8] = two * (xz + wy) * sz;
+        e[9] = two * (yz - wx) * sz;
+        e[10] = (one - two * (xx + yy)) * sz;
+        e[11] = zero;
+        e[12] = L::load(&t.px[i]);
+        e[13] = L::load(&t.py[i]);
+        e[14] = L::load(&t.pz[i]);
+        e[15] = one;
+    }
+
+#if defined(TRANSFORMBATCH_SSE)
+    // entry-major lanes to four column-major matrices: one 4x4 transpose per column
+    static void storeMatrices(const Sse e[16], glm::mat4* out)
+    {
+        for (int column = 0; column < 4; column++)
+        {
+            __m128 r0 = e[column * 4].v, r1 = e[column * 4 + 1].v, r2 = e[column * 4 + 2].v, r3 = e[column * 4 + 3].v;
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(&out[0][column][0], r0);
+            _mm_storeu_ps(&out[1][column][0], r1);
+            _mm_storeu_ps(&out[2][column][0], r2);
+            _mm_storeu_ps(&out[3][column][0], r3);
+        }
+    }
+#endif
+
+#if defined(TRANSFORMBATCH_AVX2)
+    // entry-major lanes to eight column-major matrices: two 8x8 transposes
+    // (entries 0-7, then 8-15)
+    static CPU_TARGET_AVX2 void storeMatrices(const Avx e[16], glm::mat4* out)
+    {
+        for (int half = 0; half < 2; half++)
+        {
+            const Avx* r = e + half * 8;
+            __m256 t0 = _mm256_unpacklo_ps(r[0].v, r[1].v), t1 = _mm256_unpackhi_ps(r[0].v, r[1].v);
+            __m256 t2 = _mm256_unpacklo_ps(r[2].v, r[3].v), t3 = _mm256_unpackhi_ps(r[2].v, r[3].v);
+            __m256 t4 = _mm256_unpacklo_ps(r[4].v, r[5].v), t5 = _mm256_unpackhi_ps(r[4].v, r[5].v);
+            __m256 t6 = _mm256_unpacklo_ps(r[6].v, r[7].v), t7 = _mm256_unpackhi_ps(r[6].v, r[7].v);
+            __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44), s1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+            __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44), s3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+            __m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44), s5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+            __m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44), s7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+            float* base = &out[0][0][0] + half * 8;
+            _mm256_storeu_ps(base + 0 * 16, _mm256_permute2f128_ps(s0, s4, 0x20));
+            _mm256_storeu_ps(base + 1 * 16, _mm256_permute2f128_ps(s1, s5, 0x20));
+            _mm256_storeu_ps(base + 2 * 16, _mm256_permute2f128_ps(s2, s6, 0x20));
+            _mm256_storeu_ps(base + 3 * 16, _mm256_permute2f128_ps(s3, s7, 0x20));
+            _mm256_storeu_ps(base + 4 * 16, _mm256_permute2f128_ps(s0, s4, 0x31));
+            _mm256_storeu_ps(base + 5 * 16, _mm256_permute2f128_ps(s1, s5, 0x31));
+            _mm256_storeu_ps(base + 6 * 16, _mm256_permute2f128_ps(s2, s6, 0x31));
+            _mm256_storeu_ps(base + 7 * 16, _mm256_permute2f128_ps(s3, s7, 0x31));
+        }
+    }
+#endif
+
+#if defined(TRANSFORMBATCH_AVX2)
+    // lanes i.. eight at a time; returns the first lane left over
+    static CPU_TARGET_AVX2 int composeAvx2(const TransformArrays& t, glm::mat4* out, int i, int count)
+    {
+        for (; i + 8 <= count; i += 8)
+        {
+            Avx e[16];
+            composeLanes(t, i, e);
+            storeMatrices(e, out + i);
+        }
+        return i;
+    }
+#endif
+
+    // ---- rotations ----
+
+    template <typename L>
+    static CPU_FORCE_INLINE void integrateLanes(TransformArrays& t, const float* wx, const float* wy, const float* wz, float dt, int i)
+    {
+        L x = L::load(&t.qx[i]), y = L::load(&t.qy[i]), z = L::load(&t.qz[i]), w = L::load(&t.qw[i]);
+        L halfStep(0.5f * dt);
+        L ax = L::load(wx + i) * halfStep, ay = L::load(wy + i) * halfStep, az = L::load(wz + i) * halfStep;
+        L stretch = L(1.0f) + (ax * ax + ay * ay + az * az) * L(1.0f / 3.0f);   // tan(x) / x = 1 + x^2 / 3 + ...
+        ax = ax * stretch;
+        ay = ay * stretch;
+        az = az * stretch;
+        // (a, 0) * q = (q.w * a + a x q.xyz, -a . q.xyz)
+        L nx = x + (w * ax + (ay * z - az * y));
+        L ny = y + (w * ay + (az * x - ax * z));
+        L nz = z + (w * az + (ax * y - ay * x));
+        L nw = w - (ax * x + ay * y + az * z);
+        L inverseLength = L(1.0f) / sqrt(nx * nx + ny * ny + nz * nz + nw * nw);
+        (nx * inverseLength).store(&t.qx[i]);
+        (ny * inverseLength).store(&t.qy[i]);
+        (nz * inverseLength).store(&t.qz[i]);
+        (nw * inverseLength).store(&t.qw[i]);
+    }
+
+#if defined(TRANSFORMBATCH_AVX512)
+    static CPU_TARGET_AVX512 int integrateAvx512(TransformArrays& t, const float* wx, const float* wy, const float* wz, float dt,
+        int i, int count)
+    {
+        for (; i + 16 <= count; i += 16)
+            integrateLanes<Avx512>(t, wx, wy, wz, dt, i);
+        return i;
+    }
+#endif
+
+#if defined(TRANSFORMBATCH_AVX2)
+    static CPU_TARGET_AVX2 int integrateAvx2(TransformArrays& t, const float* wx, const float* wy, const float* wz, float dt,
+        int i, int count)
+    {
+        for (; i + 8 <= count; i += 8)
+            integrateLanes<Avx>(t, wx, wy, wz, dt, i);
+        return i;
+    }
+#endif
+
+    // ---- points ----
+
+    template <typename L>
+    static CPU_FORCE_INLINE void pointLanes(const glm::mat4& m, const float* x, const float* y, const float* z,
+        float* outX, float* outY, float* outZ, int i)
+    {
+        L px = L::load(x + i), py = L::load(y + i), pz = L::load(z + i);
+        // paired like glm's mat4 * vec4
+        ((L(m[0][0]) * px + L(m[1][0]) * py) + (L(m[2][0]) * pz + L(m[3][0]))).store(outX + i);
+        ((L(m[0][1]) * px + L(m[1][1]) * py) + (L(m[2][1]) * pz + L(m[3][1]))).store(outY + i);
+        ((L(m[0][2]) * px + L(m[1][2]) * py) + (L(m[2][2]) * pz + L(m[3][2]))).store(outZ + i);
+    }
+
+#if defined(TRANSFORMBATCH_AVX512)
+    static CPU_TARGET_AVX512 int pointsAvx512(const glm::mat4& m, const float* x, const float* y, const float* z,
+        float* outX, float* outY, float* outZ, int i, int count)
+    {
+        for (; i + 16 <= count; i += 16)
+            pointLanes<Avx512>(m, x, y, z, outX, outY, outZ, i);
+        return i;
+    }
+#endif
+
+#if defined(TRANSFORMBATCH_AVX2)
+    static CPU_TARGET_AVX2 int pointsAvx2(const glm::mat4& m, const float* x, const float* y, const float* z,
+        float* outX, float* outY, float* outZ, int i, int count)
+    {
+        for (; i + 8 <= count; i += 8)
+            pointLanes<Avx>(m, x, y, z, outX, outY, outZ, i);
+        return i;
+    }
+#endif
+};
+
+// TRANSFORMBATCH_H
+#endif
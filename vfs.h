@@ -0,0 +1,82 @@
+#ifndef VFS_H
+#define VFS_H
+
+#include "assetpack.h"
+#include "filesystem.h"
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Asset access for the whole sandbox. When a pack is mounted, reads are
+// zero-copy spans into the mapped file; otherwise (development) the loose
+// file is read once through FileSystem::getPath and kept until released.
+class VFS
+{
+public:
+    // maps the pack; returns false (and keeps using loose files) if it's missing
+    static bool mount(const std::string& packPath)
+    {
+        return pack().open(packPath, stats());
+    }
+
+    static bool isPacked() { return pack().isOpen(); }
+
+    // the span stays valid until release() or program exit
+    static AssetSpan read(const std::string& name)
+    {
+        AssetSpan span = pack().find(name);
+        if (span.valid())
+            return span;
+
+        std::unordered_map<std::string, std::vector<char>>& cache = looseFiles();
+        auto found = cache.find(name);
+        if (found == cache.end())
+        {
+            std::vector<char> contents;
+            if (!AssetPack::readWholeFile(FileSystem::getPath(name), contents, &stats()))
+                return span;
+            found = cache.emplace(name, std::move(contents)).first;
+        }
+        span.data = found->second.data();
+        span.size = found->second.size();
+        return span;
+    }
+
+    // drops the loose copy of an asset once it has been uploaded; packed assets are unaffected
+    static void release(const std::string& name)
+    {
+        looseFiles().erase(name);
+    }
+
+    static AssetIOStats& stats()
+    {
+        static AssetIOStats ioStats;
+        return ioStats;
+    }
+
+    static void printStats()
+    {
+        const AssetIOStats& s = stats();
+        std::cout << "VFS (" << (isPacked() ? "pack" : "loose files") << "): "
+            << s.opens << " opens, " << s.reads << " reads, " << s.maps << " maps, "
+            << s.bytesCopied << " bytes copied, " << s.bytesMapped << " bytes mapped" << std::endl;
+    }
+
+private:
+    static AssetPack& pack()
+    {
+        static AssetPack mounted;
+        return mounted;
+    }
+
+    static std::unordered_map<std::string, std::vector<char>>& looseFiles()
+    {
+        static std::unordered_map<std::string, std::vector<char>> files;
+        return files;
+    }
+};
+
+// VFS_H
+#endif